@@ -50,6 +50,15 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  agents are registered (and looked up by the 
+//                           destructor) under their interned name symbol
+//   [2026-10-18] (agent):  the destructor only unregisters agents that are
+//                           registered (clones of the dialog tree image 
+//                           can be discarded before being registered)
+//   [2026-10-18] (agent):  the name, type and configuration of an agent live 
+//                           in a shared, immutable descriptor
+//   [2026-10-18] (agent):  dropped the extern for the global registry object,
+//                           which now lives in the dialog session
 //   [2004-12-23] (antoine): added configuration methods, modified constructor 
 //							 and factory method to handle configurations
 //   [2004-04-24] (dbohus): added create method
@@ -61,8 +70,47 @@
 #include "Agent.h"
 #include "DMCore/Log.h"
 
-// D: reference to the external AgentsRegistry object
-extern CRegistry AgentsRegistry;
+#include <mutex>
+
+//-----------------------------------------------------------------------------
+// D: The process-wide table of agent descriptors, shared by all the dialog 
+//    sessions. It only holds weak references: a descriptor is dropped from 
+//    the table when the last agent using it goes away
+//-----------------------------------------------------------------------------
+
+typedef map<string, std::weak_ptr<const TAgentDescriptor> > 
+	TAgentDescriptorTable;
+
+// D: the table and the mutex guarding it (function statics, since agents 
+//    are also created during static initialization)
+static TAgentDescriptorTable& descriptorTable() {
+	static TAgentDescriptorTable *padtTable = new TAgentDescriptorTable();
+	return *padtTable;
+}
+
+static std::mutex& descriptorTableMutex() {
+	static std::mutex *pmMutex = new std::mutex();
+	return *pmMutex;
+}
+
+// D: the key of a descriptor in the table
+static string descriptorKey(const TAgentDescriptor& rdDescriptor) {
+	return rdDescriptor.sName + "\n" + rdDescriptor.sType + "\n" + 
+		S2SHashToString(rdDescriptor.s2sConfiguration);
+}
+
+// D: removes a descriptor from the table as it gets deallocated (unless it
+//    was replaced meanwhile)
+static void releaseDescriptor(const TAgentDescriptor* pdDescriptor) {
+	{
+		std::lock_guard<std::mutex> lock(descriptorTableMutex());
+		TAgentDescriptorTable::iterator iPtr = 
+			descriptorTable().find(descriptorKey(*pdDescriptor));
+		if((iPtr != descriptorTable().end()) && iPtr->second.expired())
+			descriptorTable().erase(iPtr);
+	}
+	delete pdDescriptor;
+}
 
 //-----------------------------------------------------------------------------
 // Constructors and Destructor
@@ -70,15 +118,20 @@ extern CRegistry AgentsRegistry;
 
 // D: constructor for the CAgent class
 CAgent::CAgent(string sAName, string sAConfiguration, string sAType) {
-	sName = sAName;
-	sType = sAType;
-	SetConfiguration(sAConfiguration);
+	TAgentDescriptor dDescriptor;
+	dDescriptor.sName = sAName;
+	dDescriptor.symName = NO_SYMBOL;
+	dDescriptor.sType = sAType;
+	dDescriptor.s2sConfiguration = StringToS2SHash(sAConfiguration);
+	pdDescriptor = internDescriptor(dDescriptor);
 }
 
 // D: destructor
 CAgent::~CAgent() {
-	// unregister the agent, but only if it's not the NULL agent
-	if(sName != "NULL")
+	// unregister the agent, but only if it's not the NULL agent, and if it
+	// was registered in the first place
+	if((pdDescriptor->sName != "NULL") && pAgentsRegistry &&
+		(AgentsRegistry[pdDescriptor->symName] == this))
 		UnRegister();
 }
 
@@ -112,31 +165,42 @@ void CAgent::Reset() {
 void CAgent::SetConfiguration(string sConfiguration) {
 	// append to the current list of parameters
 	STRING2STRING lval = StringToS2SHash(sConfiguration);
-	AppendToS2S(s2sConfiguration, lval);
+	SetConfiguration(lval);
 }
 
 // D: appends to the configuration from a hash
 void CAgent::SetConfiguration(STRING2STRING s2sAConfiguration) {
-    // append to the current configuration
-    AppendToS2S(s2sConfiguration, s2sAConfiguration);
+	if(s2sAConfiguration.empty())
+		return;
+    // append to a copy of the current configuration
+	TAgentDescriptor dDescriptor = *pdDescriptor;
+    AppendToS2S(dDescriptor.s2sConfiguration, s2sAConfiguration);
+	pdDescriptor = internDescriptor(dDescriptor);
 }
 
 // A: sets an individual parameter
 void CAgent::SetParameter(string sParam, string sValue) {
-	s2sConfiguration.insert(STRING2STRING::value_type(sParam, sValue));
+	if(HasParameter(sParam))
+		return;
+	TAgentDescriptor dDescriptor = *pdDescriptor;
+	dDescriptor.s2sConfiguration.insert(
+		STRING2STRING::value_type(sParam, sValue));
+	pdDescriptor = internDescriptor(dDescriptor);
 }
 
 // A: tests if a given parameter exists in the configuration
 bool CAgent::HasParameter(string sParam) {
-	return s2sConfiguration.find(sParam) != s2sConfiguration.end();
+	return pdDescriptor->s2sConfiguration.find(sParam) != 
+		pdDescriptor->s2sConfiguration.end();
 }
 
 // A: gets the value for a given parameter
 string CAgent::GetParameterValue(string sSlot) {
 
-	STRING2STRING::iterator i = s2sConfiguration.find(sSlot);
+	STRING2STRING::const_iterator i = 
+		pdDescriptor->s2sConfiguration.find(sSlot);
 
-	if (i == s2sConfiguration.end()) {
+	if (i == pdDescriptor->s2sConfiguration.end()) {
 		return "";
 	}
 	else {
@@ -152,20 +216,57 @@ string CAgent::GetParameterValue(string sSlot) {
 
 // D: return the agent name
 string CAgent::GetName() {
-	return sName;
+	return pdDescriptor->sName;
 }
 
 // D: return the agent type
 string CAgent::GetType() {
-	return sType;
+	return pdDescriptor->sType;
+}
+
+// D: return the symbol of the agent name
+TSymbol CAgent::GetNameSymbol() {
+	return pdDescriptor->symName;
+}
+
+// D: renames the agent
+void CAgent::SetName(string sAName) {
+	if(pdDescriptor->sName == sAName)
+		return;
+	TAgentDescriptor dDescriptor = *pdDescriptor;
+	dDescriptor.sName = sAName;
+	pdDescriptor = internDescriptor(dDescriptor);
+}
+
+// D: returns the number of descriptors in the process-wide table
+int CAgent::GetDescriptorCount() {
+	std::lock_guard<std::mutex> lock(descriptorTableMutex());
+	return (int)descriptorTable().size();
+}
+
+// D: returns the shared descriptor equal to the given one, adding it to 
+//    the table if there is none
+TAgentDescriptorPointer CAgent::internDescriptor(
+	const TAgentDescriptor& rdDescriptor) {
+	string sKey = descriptorKey(rdDescriptor);
+	std::lock_guard<std::mutex> lock(descriptorTableMutex());
+	std::weak_ptr<const TAgentDescriptor>& rwpEntry = descriptorTable()[sKey];
+	TAgentDescriptorPointer pdShared = rwpEntry.lock();
+	if(!pdShared) {
+		TAgentDescriptor* pdNew = new TAgentDescriptor(rdDescriptor);
+		pdNew->symName = CSymbolTable::Intern(pdNew->sName);
+		pdShared = TAgentDescriptorPointer(pdNew, releaseDescriptor);
+		rwpEntry = pdShared;
+	}
+	return pdShared;
 }
 
 // D: registers the agent
 void CAgent::Register() {
-	AgentsRegistry.RegisterAgent(sName, this);
+	AgentsRegistry.RegisterAgent(pdDescriptor->symName, this);
 }
 
 // D: unregisters the agent
 void CAgent::UnRegister() {
-	AgentsRegistry.UnRegisterAgent(sName);
+	AgentsRegistry.UnRegisterAgent(pdDescriptor->symName);
 }
@@ -50,6 +50,10 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the descriptor carries the interned symbol of 
+//                           the agent name
+//   [2026-10-18] (agent):  the name, type and configuration of an agent live 
+//                           in a shared, immutable descriptor
 //   [2004-12-23] (antoine): added configuration methods, modified constructor 
 //							 and factory method to handle configurations
 //   [2004-04-24] (dbohus): added create method
@@ -62,9 +66,29 @@
 #ifndef __AGENT_H__
 #define __AGENT_H__
 
+#include <memory>
+
 #include "Utils/Utils.h"
+#include "SymbolTable.h"
 #include "Registry.h"
 
+//-----------------------------------------------------------------------------
+// D: the immutable description of an agent: name, type and configuration. 
+//    Descriptors are interned process-wide, so the agents that all the 
+//    dialog sessions create from the same dialog task specification share 
+//    one copy of them. Descriptors are never changed in place: an agent that
+//    gets renamed (e.g. when it is mounted in the tree) or reconfigured 
+//    switches to another descriptor (copy-on-write)
+//-----------------------------------------------------------------------------
+typedef struct {
+	string sName;						// name of agent
+	TSymbol symName;					// interned symbol of the name
+	string sType;						// type of agent
+	STRING2STRING s2sConfiguration;		// hash of parameters
+} TAgentDescriptor;
+
+typedef std::shared_ptr<const TAgentDescriptor> TAgentDescriptorPointer;
+
 //-----------------------------------------------------------------------------
 // CAgent Class - 
 //   This is the base of the agent classes. It implements the basic 
@@ -78,9 +102,8 @@ protected:
 	// Name and Type class members
 	//---------------------------------------------------------------------
 	//
-	string sName;		// name of agent
-	string sType;		// type of agent
-	STRING2STRING s2sConfiguration;		// hash of parameters
+	// the (shared) name, type and configuration of the agent
+	TAgentDescriptorPointer pdDescriptor;
 
 public:
 	//---------------------------------------------------------------------
@@ -102,6 +125,10 @@ public:
 	string GetName();
 	string GetType();
 
+	// Returns the interned symbol of the agent name
+	//
+	TSymbol GetNameSymbol();
+
 	// Sets the configuration from a configuration string or from a hash
 	// 
 	void SetConfiguration(string sConfiguration);
@@ -116,6 +143,13 @@ public:
 	// Gets the value for a given parameter
 	string GetParameterValue(string sParam);
 
+	// Gives the agent a new name
+	void SetName(string sAName);
+
+	// Returns the number of distinct agent descriptors currently in use 
+	// in the process
+	static int GetDescriptorCount();
+
 	//---------------------------------------------------------------------
 	// CAgent specific methods
 	//---------------------------------------------------------------------
@@ -140,6 +174,12 @@ public:
 	//
 	virtual void Reset();
 
+private:
+	// Looks up (or adds) a descriptor in the process-wide descriptor table
+	//
+	static TAgentDescriptorPointer internDescriptor(
+		const TAgentDescriptor& rdDescriptor);
+
 };
 
 #endif // __AGENT_H__
\ No newline at end of file
@@ -52,6 +52,54 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  NotifyExpectationsChanged can be limited to 
+//                           one agent
+//   [2026-10-18] (agent):  SaveToRecord fails when the execution stack 
+//                           holds agents outside the dialog task tree
+//   [2026-10-18] (agent):  popTopicFromExecutionStack takes the position 
+//                           of the topic from the stack iterator
+//   [2026-10-18] (agent):  added NotifyExpectationsChanged, for agents 
+//                           whose expectations depend on the dialog state
+//   [2026-10-18] (agent):  compileExpectationAgenda assembles a new agenda
+//                           instead of clearing the one in use (which the 
+//                           dialog states may share), and 
+//                           rollBackDialogState restores the execution 
+//                           stack and the agenda by pointer
+//   [2026-10-18] (agent):  SignalUnplannedImplicitConfirmOnConcept changes
+//                           past system actions through 
+//                           CStateManagerAgent::GetSystemAction
+//   [2026-10-18] (agent):  assembleFocusClaims visits only the agents that
+//                           may claim the focus (indexed once per version
+//                           of the tree), and the claims are resolved 
+//                           through the agent pointers they carry
+//   [2026-10-18] (agent):  the dialog state version is advanced at every
+//                           step of the execution loop, so that the 
+//                           completion criteria cached by the agents 
+//                           within a step are evaluated again in the next
+//   [2026-10-18] (agent):  popCompletedFromExecutionStack, 
+//                           popTopicFromExecutionStack and 
+//                           popGroundingAgentsFromExecutionStack mark the 
+//                           agents to eliminate in one pass, and compact the
+//                           stack once
+//   [2026-10-18] (agent):  bindConcepts matches a slot and gets its value in
+//                           a single pass over the event
+//   [2026-10-18] (agent):  compileExpectationAgenda keeps the expectations
+//                           declared by each agent on the stack, declares 
+//                           them again only for agents newly pushed or when
+//                           the tree changes, and otherwise just updates 
+//                           their state; the nonunderstanding thresholds
+//                           default to 0 (they were left uninitialized)
+//   [2026-10-18] (agent):  added SaveToRecord and LoadFromRecord, for session
+//                           hibernation
+//   [2026-10-18] (agent):  SetTimeoutPeriod (re)arms the session's turn 
+//                           timeout, and the input ending the turn cancels it
+//   [2026-10-18] (agent):  timeout periods default to 0 (no timeout), and
+//                           turn timeout events are processed
+//   [2026-10-18] (agent):  the execution loop moved into Step, which returns
+//                           whenever the core needs a new interaction event;
+//                           Execute now just drives Step
+//   [2026-10-18] (agent):  GetIntSessionID returns the id of the current 
+//                           dialog session; floor labels are built statically
 //   [2007-03-05] (antoine): changed Execute so that grounding and dialog agents
 //							 are only executed once the floor is free and all 
 //							 pending prompt notifications have been received 
@@ -63,11 +111,15 @@
 //#include "DMInterfaces/DMInterface.h"
 #include "DMCore/Agents/Registry.h"
 #include "DMCore/Core.h"
+#include "DMCore/SessionRecord.h"
 #ifdef GALAXY
 #include "DMCore/Events/GalaxyInteractionEvent.h"
 #endif
 #include "DMCoreAgent.h"
 
+#include <atomic>
+#include <queue>
+#include <unordered_set>
 
 // *** *** BIG QUESTION: What core stuff do we log, and where ?
 // 1. We need to log the compiled agenda at each input pass
@@ -78,8 +130,21 @@
 // *** Concept Binding and generally the Input PASS need to be revisited 
 //     since they were not implemented completely
 
-// A: A vector of strings containing labels for TFloorStatus variables
-vector<string> vsFloorStatusLabels;
+// A: A vector of strings containing labels for TFloorStatus variables (shared
+//    by all the dialog sessions, so it is filled in once, statically)
+vector<string> vsFloorStatusLabels = {"unknown", "user", "system", "free"};
+
+// D: indicates if the expectations declared by the agents on the stack are 
+//    kept between agenda assemblies (for all the dialog sessions)
+static atomic<bool> bUseIncrementalAgenda(true);
+
+// D: indicates if the agents cache their completion criteria between 
+//    changes of the dialog state (for all the dialog sessions)
+static atomic<bool> bUseCompletionCache(true);
+
+// D: indicates if the focus claims are gathered from the index of the agents
+//    that may claim the focus (for all the dialog sessions)
+static atomic<bool> bUseFocusClaimsIndex(true);
 
 
 //-----------------------------------------------------------------------------
@@ -93,11 +158,18 @@ CDMCoreAgent::CDMCoreAgent(string sAName, string sAConfiguration,
     bFocusClaimsPhaseFlag = false;
 	fsFloorStatus = fsSystem;
 	iTurnNumber = 0;
+	clsLoopState = clsNotStarted;
+	// no timeouts unless the task (or the configuration) sets them
+	iTimeoutPeriod = 0;
+	iDefaultTimeoutPeriod = 0;
+	// and no nonunderstanding threshold either
+	fNonunderstandingThreshold = 0;
+	fDefaultNonunderstandingThreshold = 0;
     csoStartOverFunct = NULL;
-	vsFloorStatusLabels.push_back("unknown");
-	vsFloorStatusLabels.push_back("user");
-	vsFloorStatusLabels.push_back("system");
-	vsFloorStatusLabels.push_back("free");
+	uiAgendaAssemblies = 0;
+	peaAgenda = make_shared <TExpectationAgenda> ();
+	iDialogStateVersion = 0;
+	iFocusClaimsIndexVersion = -1;
 }
 
 // D: virtual destructor - does nothing so far
@@ -121,8 +193,10 @@ void CDMCoreAgent::Reset() {
 	esExecutionStack.clear();
 	ehExecutionHistory.clear();
     bhBindingHistory.clear();
-	eaAgenda.celSystemExpectations.clear();
-	eaAgenda.vCompiledExpectations.clear();
+	peaAgenda = make_shared <TExpectationAgenda> ();
+	dehDeclaredExpectations.clear();
+	iFocusClaimsIndexVersion = -1;
+	clsLoopState = clsNotStarted;
 }
 
 //-----------------------------------------------------------------------------
@@ -144,7 +218,343 @@ void CDMCoreAgent::Reset() {
 //    agents that are on the stack, and issuing input passes when appropriate
 //-----------------------------------------------------------------------------
 
+// D: Execute: runs the dialog task to completion. The loop itself lives in 
+//    Step(); here we just block for the next interaction event every time
+//    the core needs one
 void CDMCoreAgent::Execute() {
+	while(Step() == csrcWaitForEvent)
+		pInteractionEventManager->WaitForEvent();
+}
+
+// D: Returns the position of the execution loop
+TCoreLoopState CDMCoreAgent::GetLoopState() {
+	return clsLoopState;
+}
+
+// D: enables or disables keeping the declared expectations between agenda
+//    assemblies
+void CDMCoreAgent::SetUseIncrementalAgenda(bool bAUseIncrementalAgenda) {
+	bUseIncrementalAgenda = bAUseIncrementalAgenda;
+}
+
+// D: indicates if the declared expectations are kept between agenda 
+//    assemblies
+bool CDMCoreAgent::GetUseIncrementalAgenda() {
+	return bUseIncrementalAgenda;
+}
+
+// D: signals that the declared expectations kept between agenda assemblies
+//    are stale
+void CDMCoreAgent::NotifyExpectationsChanged() {
+	dehDeclaredExpectations.clear();
+}
+
+// D: signals that the expectations declared by an agent have changed
+void CDMCoreAgent::NotifyExpectationsChanged(CDialogAgent* pdaAgent) {
+	dehDeclaredExpectations.erase(pdaAgent);
+}
+
+// D: signals a change of the dialog state: the completion criteria cached
+//    by the agents are no longer valid
+void CDMCoreAgent::NotifyDialogStateChanged() {
+	iDialogStateVersion++;
+}
+
+// D: returns the dialog state version
+int CDMCoreAgent::GetDialogStateVersion() {
+	return iDialogStateVersion;
+}
+
+// D: enables or disables caching the completion criteria of the agents
+void CDMCoreAgent::SetUseCompletionCache(bool bAUseCompletionCache) {
+	bUseCompletionCache = bAUseCompletionCache;
+}
+
+// D: indicates if the agents cache their completion criteria
+bool CDMCoreAgent::GetUseCompletionCache() {
+	return bUseCompletionCache;
+}
+
+// D: enables or disables the index of the agents that may claim the focus
+void CDMCoreAgent::SetUseFocusClaimsIndex(bool bAUseFocusClaimsIndex) {
+	bUseFocusClaimsIndex = bAUseFocusClaimsIndex;
+}
+
+// D: indicates if the index of the agents that may claim the focus is used
+bool CDMCoreAgent::GetUseFocusClaimsIndex() {
+	return bUseFocusClaimsIndex;
+}
+
+// D: indicates if the focus claims index is in use, and up to date
+bool CDMCoreAgent::HasFocusClaimsIndex() {
+	return bUseFocusClaimsIndex && 
+		(iFocusClaimsIndexVersion == pDTTManager->GetTreeVersion());
+}
+
+//-----------------------------------------------------------------------------
+// D: Saving and restoring the state of the core
+//-----------------------------------------------------------------------------
+
+// D: auxiliary functions for writing and reading timestamps
+static void saveTime(CSessionRecord& rRecord, timeb& rtTime) {
+	rRecord.WriteInt((int)rtTime.time);
+	rRecord.WriteInt(rtTime.millitm);
+}
+
+static timeb loadTime(CSessionRecord& rRecord) {
+	timeb tTime;
+	memset(&tTime, 0, sizeof(tTime));
+	tTime.time = (time_t)rRecord.ReadInt();
+	tTime.millitm = (unsigned short)rRecord.ReadInt();
+	return tTime;
+}
+
+// D: auxiliary functions for writing and reading sets of concepts (by their
+//    agent qualified names)
+static void saveConceptSet(CSessionRecord& rRecord, set<CConcept *>& rscp) {
+	rRecord.WriteInt((int)rscp.size());
+	set<CConcept *>::iterator iPtr;
+	for(iPtr = rscp.begin(); iPtr != rscp.end(); iPtr++)
+		rRecord.WriteString((*iPtr)->GetAgentQualifiedName());
+}
+
+static bool loadConceptSet(CSessionRecord& rRecord, set<CConcept *>& rscp) {
+	rscp.clear();
+	int iSize = rRecord.ReadInt();
+	for(int i = 0; rRecord.IsValid() && (i < iSize); i++) {
+		string sAgentName, sConceptName;
+		SplitOnLast(rRecord.ReadString(), "/", sAgentName, sConceptName);
+		CDialogAgent *pdaOwner = (CDialogAgent *)AgentsRegistry[sAgentName];
+		if(!pdaOwner) {
+			rRecord.Invalidate();
+			return false;
+		}
+		rscp.insert(&(pdaOwner->LocalC(sConceptName)));
+	}
+	return rRecord.IsValid();
+}
+
+// D: writes an execution stack (agent names and history indices). Only 
+//    the agents of the dialog task tree can be found again when the 
+//    stack is read, so it returns false (and writes nothing) if the stack 
+//    holds any other agent (a grounding agency, or a dynamic agent)
+bool CDMCoreAgent::saveExecutionStack(CSessionRecord& rRecord, 
+	TExecutionStack& res) {
+	TExecutionStack::iterator iPtr;
+	for(iPtr = res.begin(); iPtr != res.end(); iPtr++) {
+		if(iPtr->pdaAgent->IsDynamicAgent() || 
+			!iPtr->pdaAgent->IsInDialogTaskTree()) {
+			Log(DMCORE_STREAM, "Agent %s on the execution stack is not part "
+				"of the dialog task tree, and cannot be saved.", 
+				iPtr->pdaAgent->GetName().c_str());
+			return false;
+		}
+	}
+
+	rRecord.WriteInt((int)res.size());
+	for(iPtr = res.begin(); iPtr != res.end(); iPtr++) {
+		rRecord.WriteString(iPtr->pdaAgent->GetName());
+		rRecord.WriteInt(iPtr->iEHIndex);
+	}
+	return true;
+}
+
+// D: reads an execution stack, looking the agents up in the registry
+bool CDMCoreAgent::loadExecutionStack(CSessionRecord& rRecord, 
+	TExecutionStack& res) {
+	res.clear();
+	int iSize = rRecord.ReadInt();
+	for(int i = 0; rRecord.IsValid() && (i < iSize); i++) {
+		TExecutionStackItem esiItem;
+		esiItem.pdaAgent = (CDialogAgent *)AgentsRegistry[rRecord.ReadString()];
+		esiItem.iEHIndex = rRecord.ReadInt();
+		if(!esiItem.pdaAgent) {
+			rRecord.Invalidate();
+			return false;
+		}
+		res.push_back(esiItem);
+	}
+	return rRecord.IsValid();
+}
+
+// D: writes a system action
+void CDMCoreAgent::saveSystemAction(CSessionRecord& rRecord, 
+	TSystemAction& rsa) {
+	saveConceptSet(rRecord, rsa.setcpRequests);
+	saveConceptSet(rRecord, rsa.setcpExplicitConfirms);
+	saveConceptSet(rRecord, rsa.setcpImplicitConfirms);
+	saveConceptSet(rRecord, rsa.setcpUnplannedImplicitConfirms);
+}
+
+// D: reads a system action
+bool CDMCoreAgent::loadSystemAction(CSessionRecord& rRecord, 
+	TSystemAction& rsa) {
+	return loadConceptSet(rRecord, rsa.setcpRequests) &&
+		loadConceptSet(rRecord, rsa.setcpExplicitConfirms) &&
+		loadConceptSet(rRecord, rsa.setcpImplicitConfirms) &&
+		loadConceptSet(rRecord, rsa.setcpUnplannedImplicitConfirms);
+}
+
+// D: writes the state of the core to a session record
+bool CDMCoreAgent::SaveToRecord(CSessionRecord& rRecord) {
+	if(clsLoopState != clsWaitingForEvent)
+		return false;
+
+	rRecord.WriteString("DMCore");
+	rRecord.WriteInt(iTurnNumber);
+	rRecord.WriteInt(fsFloorStatus);
+	rRecord.WriteInt(iTimeoutPeriod);
+	rRecord.WriteInt(iDefaultTimeoutPeriod);
+	rRecord.WriteFloat(fNonunderstandingThreshold);
+	rRecord.WriteFloat(fDefaultNonunderstandingThreshold);
+	rRecord.WriteBool(bFocusClaimsPhaseFlag);
+
+	// the execution history
+	rRecord.WriteInt((int)ehExecutionHistory.size());
+	for(unsigned int i = 0; i < ehExecutionHistory.size(); i++) {
+		TExecutionHistoryItem& rehiItem = ehExecutionHistory[i];
+		rRecord.WriteString(rehiItem.sCurrentAgent);
+		rRecord.WriteString(rehiItem.sCurrentAgentType);
+		rRecord.WriteString(rehiItem.sScheduledBy);
+		rRecord.WriteBool(rehiItem.bScheduled);
+		rRecord.WriteBool(rehiItem.bExecuted);
+		rRecord.WriteBool(rehiItem.bCommitted);
+		rRecord.WriteBool(rehiItem.bCanceled);
+		saveTime(rRecord, rehiItem.timeScheduled);
+		rRecord.WriteInt((int)rehiItem.vtExecutionTimes.size());
+		for(unsigned int t = 0; t < rehiItem.vtExecutionTimes.size(); t++)
+			saveTime(rRecord, rehiItem.vtExecutionTimes[t]);
+		saveTime(rRecord, rehiItem.timeTerminated);
+		rRecord.WriteInt(rehiItem.iStateHistoryIndex);
+	}
+
+	// the execution stack
+	if(!saveExecutionStack(rRecord, esExecutionStack))
+		return false;
+
+	// the binding history
+	rRecord.WriteInt((int)bhBindingHistory.size());
+	for(unsigned int i = 0; i < bhBindingHistory.size(); i++) {
+		TBindingsDescr& rbdBindings = bhBindingHistory[i];
+		rRecord.WriteString(rbdBindings.sEventType);
+		rRecord.WriteBool(rbdBindings.bNonUnderstanding);
+		rRecord.WriteInt(rbdBindings.iConceptsBound);
+		rRecord.WriteInt(rbdBindings.iConceptsBlocked);
+		rRecord.WriteInt(rbdBindings.iSlotsMatched);
+		rRecord.WriteInt(rbdBindings.iSlotsBlocked);
+		rRecord.WriteInt((int)rbdBindings.vbBindings.size());
+		for(unsigned int b = 0; b < rbdBindings.vbBindings.size(); b++) {
+			TBinding& rbBinding = rbdBindings.vbBindings[b];
+			rRecord.WriteBool(rbBinding.bBlocked);
+			rRecord.WriteString(rbBinding.sGrammarExpectation);
+			rRecord.WriteString(rbBinding.sValue);
+			rRecord.WriteFloat(rbBinding.fConfidence);
+			rRecord.WriteInt(rbBinding.iLevel);
+			rRecord.WriteString(rbBinding.sAgentName);
+			rRecord.WriteString(rbBinding.sConceptName);
+			rRecord.WriteString(rbBinding.sReasonDisabled);
+		}
+		rRecord.WriteInt((int)rbdBindings.vfcuForcedUpdates.size());
+		for(unsigned int f = 0; f < rbdBindings.vfcuForcedUpdates.size(); f++) {
+			TForcedConceptUpdate& rfcuUpdate = 
+				rbdBindings.vfcuForcedUpdates[f];
+			rRecord.WriteString(rfcuUpdate.sConceptName);
+			rRecord.WriteInt(rfcuUpdate.iType);
+			rRecord.WriteBool(rfcuUpdate.bUnderstanding);
+		}
+	}
+
+	// and the current system action
+	saveSystemAction(rRecord, saSystemAction);
+	return true;
+}
+
+// D: restores the state of the core from a session record
+bool CDMCoreAgent::LoadFromRecord(CSessionRecord& rRecord) {
+	if(!rRecord.Expect("DMCore"))
+		return false;
+	iTurnNumber = rRecord.ReadInt();
+	fsFloorStatus = (TFloorStatus)rRecord.ReadInt();
+	iTimeoutPeriod = rRecord.ReadInt();
+	iDefaultTimeoutPeriod = rRecord.ReadInt();
+	fNonunderstandingThreshold = rRecord.ReadFloat();
+	fDefaultNonunderstandingThreshold = rRecord.ReadFloat();
+	bFocusClaimsPhaseFlag = rRecord.ReadBool();
+
+	// the execution history
+	ehExecutionHistory.clear();
+	int iSize = rRecord.ReadInt();
+	for(int i = 0; rRecord.IsValid() && (i < iSize); i++) {
+		TExecutionHistoryItem ehiItem;
+		ehiItem.sCurrentAgent = rRecord.ReadString();
+		ehiItem.sCurrentAgentType = rRecord.ReadString();
+		ehiItem.sScheduledBy = rRecord.ReadString();
+		ehiItem.bScheduled = rRecord.ReadBool();
+		ehiItem.bExecuted = rRecord.ReadBool();
+		ehiItem.bCommitted = rRecord.ReadBool();
+		ehiItem.bCanceled = rRecord.ReadBool();
+		ehiItem.timeScheduled = loadTime(rRecord);
+		int iTimes = rRecord.ReadInt();
+		for(int t = 0; rRecord.IsValid() && (t < iTimes); t++)
+			ehiItem.vtExecutionTimes.push_back(loadTime(rRecord));
+		ehiItem.timeTerminated = loadTime(rRecord);
+		ehiItem.iStateHistoryIndex = rRecord.ReadInt();
+		ehExecutionHistory.push_back(ehiItem);
+	}
+
+	// the execution stack
+	if(!loadExecutionStack(rRecord, esExecutionStack))
+		return false;
+
+	// the binding history
+	bhBindingHistory.clear();
+	iSize = rRecord.ReadInt();
+	for(int i = 0; rRecord.IsValid() && (i < iSize); i++) {
+		TBindingsDescr bdBindings;
+		bdBindings.sEventType = rRecord.ReadString();
+		bdBindings.bNonUnderstanding = rRecord.ReadBool();
+		bdBindings.iConceptsBound = rRecord.ReadInt();
+		bdBindings.iConceptsBlocked = rRecord.ReadInt();
+		bdBindings.iSlotsMatched = rRecord.ReadInt();
+		bdBindings.iSlotsBlocked = rRecord.ReadInt();
+		int iBindings = rRecord.ReadInt();
+		for(int b = 0; rRecord.IsValid() && (b < iBindings); b++) {
+			TBinding bBinding;
+			bBinding.bBlocked = rRecord.ReadBool();
+			bBinding.sGrammarExpectation = rRecord.ReadString();
+			bBinding.sValue = rRecord.ReadString();
+			bBinding.fConfidence = rRecord.ReadFloat();
+			bBinding.iLevel = rRecord.ReadInt();
+			bBinding.sAgentName = rRecord.ReadString();
+			bBinding.sConceptName = rRecord.ReadString();
+			bBinding.sReasonDisabled = rRecord.ReadString();
+			bdBindings.vbBindings.push_back(bBinding);
+		}
+		int iUpdates = rRecord.ReadInt();
+		for(int f = 0; rRecord.IsValid() && (f < iUpdates); f++) {
+			TForcedConceptUpdate fcuUpdate;
+			fcuUpdate.sConceptName = rRecord.ReadString();
+			fcuUpdate.iType = rRecord.ReadInt();
+			fcuUpdate.bUnderstanding = rRecord.ReadBool();
+			bdBindings.vfcuForcedUpdates.push_back(fcuUpdate);
+		}
+		bhBindingHistory.push_back(bdBindings);
+	}
+
+	// the current system action
+	if(!loadSystemAction(rRecord, saSystemAction))
+		return false;
+
+	// the agenda is not saved; assemble it again from the restored tree
+	assembleExpectationAgenda();
+	bAgendaModifiedFlag = false;
+
+	clsLoopState = clsWaitingForEvent;
+	return rRecord.IsValid();
+}
+
+// D: Creates the dialog task tree and starts executing it
+void CDMCoreAgent::startExecution() {
 
 	// create & initialize the dialog task
 	pDTTManager->CreateDialogTree();
@@ -159,6 +569,54 @@ void CDMCoreAgent::Execute() {
 	// creates the initial dialog state
 	pStateManager->UpdateState();
 
+	clsLoopState = clsRunning;
+}
+
+// D: Processes the next queued interaction event (looking into the session
+//    mailbox too); if there is none, suspends the execution loop until one
+//    arrives
+bool CDMCoreAgent::acquireQueuedEvent() {
+	if(!pInteractionEventManager->PollForEvent()) {
+		clsLoopState = clsWaitingForEvent;
+		return false;
+	}
+	ProcessNextEvent();
+	NotifyDialogStateChanged();
+	clsLoopState = clsRunning;
+	return true;
+}
+
+// D: Step: runs the execution loop until the dialog core needs a new 
+//    interaction event, or until the dialog task completes
+TCoreStepReturnCode CDMCoreAgent::Step(CInteractionEvent *pieEvent) {
+
+	// queue the incoming event, if any
+	if(pieEvent)
+		pInteractionEventManager->QueueEvent(pieEvent);
+
+	// whatever happened since the last step (the task may have changed 
+	// concepts from outside the loop) invalidates the cached criteria
+	NotifyDialogStateChanged();
+
+	// resume the execution loop from where it was left
+	switch(clsLoopState) {
+	case clsFinished:
+		return csrcDialogFinished;
+
+	case clsNotStarted:
+		startExecution();
+		break;
+
+	case clsWaitingForEvent:
+		// if the event we are waiting for has not arrived, stay suspended
+		if(!acquireQueuedEvent())
+			return csrcWaitForEvent;
+		break;
+
+	case clsRunning:
+		break;
+	}
+
 	// do the while loop for execution
 	while(!esExecutionStack.empty()) {
     //暂时
@@ -191,8 +649,10 @@ void CDMCoreAgent::Execute() {
 			//(pOutputManager->GetPromptsWaitingForNotification() == "")) {
 
 			if (pGroundingManager->HasPendingRequests() || 
-			 pGroundingManager->HasScheduledConceptGroundingRequests())
+			 pGroundingManager->HasScheduledConceptGroundingRequests()) {
 				pGroundingManager->Run();
+				NotifyDialogStateChanged();
+			}
 			// now pop completed
 			int iPopped = popCompletedFromExecutionStack();
 
@@ -204,6 +664,7 @@ void CDMCoreAgent::Execute() {
 				pGroundingManager->HasUnprocessedConceptGroundingRequests()) {
 				// run it
 				pGroundingManager->Run();
+				NotifyDialogStateChanged();
 				// eliminate all the agents that have completed (potentially as a 
 				// result of the grounding phase) from the execution stack
 				iPopped = popCompletedFromExecutionStack();
@@ -216,8 +677,10 @@ void CDMCoreAgent::Execute() {
         // do so, and if there are no scheduled grounding activities
         if(bFocusClaimsPhaseFlag) {
   	        // Analyze the need for a focus shift, and resolve it if necessary
-            if(assembleFocusClaims())
+            if(assembleFocusClaims()) {
 	            resolveFocusShift();
+	            NotifyDialogStateChanged();
+            }
             // reset the flag
             bFocusClaimsPhaseFlag = false;
         }
@@ -258,6 +721,7 @@ void CDMCoreAgent::Execute() {
         // execute it
 		TDialogExecuteReturnCode dercResult = pdaAgentInFocus->Execute();
 		ehExecutionHistory[esExecutionStack.front().iEHIndex].bExecuted = true;
+		NotifyDialogStateChanged();
 
         // and now analyze the return
 		switch(dercResult) {
@@ -268,7 +732,8 @@ void CDMCoreAgent::Execute() {
         case dercFinishDialog:
             // finish the dialog
 			Log(DMCORE_STREAM, "Dialog Task Execution completed. Dialog finished");
-			return;
+			clsLoopState = clsFinished;
+			return csrcDialogFinished;
         
         case dercFinishDialogAndCloseSession:
 			// tell the hub to close the session
@@ -276,7 +741,8 @@ void CDMCoreAgent::Execute() {
 			//DMI_SendEndSession();
             //// finish the dialog
 			/*Log(DMCORE_STREAM, "Dialog Task Execution completed. Dialog finished");*/
-			return;
+			clsLoopState = clsFinished;
+			return csrcDialogFinished;
         
         case dercRestartDialog:
             // call the start over routine
@@ -289,7 +755,9 @@ void CDMCoreAgent::Execute() {
 			SetFloorStatus(fsUser);
 
 			// wait for the next event
-			AcquireNextEvent();
+			// (return to the caller if it has not arrived yet)
+			if(!acquireQueuedEvent())
+				return csrcWaitForEvent;
             break;
 
 		case dercTakeFloor:
@@ -298,13 +766,17 @@ void CDMCoreAgent::Execute() {
 			SetFloorStatus(fsSystem);
 
 			// wait for the next event
-			AcquireNextEvent();
+			// (return to the caller if it has not arrived yet)
+			if(!acquireQueuedEvent())
+				return csrcWaitForEvent;
             break;
 
 		case dercWaitForEvent:
 
 			// wait for the next event
-			AcquireNextEvent();
+			// (return to the caller if it has not arrived yet)
+			if(!acquireQueuedEvent())
+				return csrcWaitForEvent;
             break;
 		}
 	}
@@ -313,6 +785,8 @@ void CDMCoreAgent::Execute() {
 	Log(DMCORE_STREAM, "Sending close_session to the hub");
 	//DMI_SendEndSession();
 	Log(DMCORE_STREAM, "Dialog Task Execution completed. Dialog finished.");
+	clsLoopState = clsFinished;
+	return csrcDialogFinished;
 }
 
 //-----------------------------------------------------------------------------
@@ -323,6 +797,16 @@ void CDMCoreAgent::AcquireNextEvent() {
 
 	pInteractionEventManager->WaitForEvent();
 
+	ProcessNextEvent();
+	NotifyDialogStateChanged();
+}
+
+// D: Processes the next event from the interaction event queue
+void CDMCoreAgent::ProcessNextEvent() {
+
+	// the input pass changes the dialog state
+	NotifyDialogStateChanged();
+
 	// Unqueue event
 	CInteractionEvent *pieEvent = pInteractionEventManager->GetNextEvent();
   //cout << "event"<<pieEvent->GetType()<<"完成情况" << pieEvent->IsComplete() <<endl;
@@ -387,6 +871,10 @@ void CDMCoreAgent::AcquireNextEvent() {
                pieEvent->GetType() == IET_GUI) {
 
 		if (pieEvent->IsComplete()) {
+			// the user answered, stop timing the turn
+			if (CDialogSession::GetCurrent())
+				CDialogSession::GetCurrent()->CancelTurnTimeout();
+
 			// Set the last input on the focused agent
 			GetAgentInFocus()->SetLastInputIndex(iTurnNumber);
 			GetAgentInFocus()->IncrementTurnsInFocusCounter();
@@ -424,6 +912,12 @@ void CDMCoreAgent::AcquireNextEvent() {
 	 /* pOutputManager->Notify(pieEvent->GetIntProperty("[utt_count]"), 0, "", "");*/
 
 		Log(DMCORE_STREAM, "Output cancel notification processed.");		
+	} else if (pieEvent->GetType() == IET_TURN_TIMEOUT) {
+		// nothing else to do: the agents triggered by TIMEOUT_ELAPSED have
+		// been bound above, otherwise the agent in focus executes again
+		if (CDialogSession::GetCurrent())
+			CDialogSession::GetCurrent()->CancelTurnTimeout();
+		Log(DMCORE_STREAM, "Processed turn timeout.");
 	} else if (pieEvent->GetType() == IET_DIALOG_STATE_CHANGE) {
 
 		pStateManager->UpdateState();
@@ -502,7 +996,8 @@ void CDMCoreAgent::RegisterBindingFilter(string sBindingFilterName,
 
 int CDMCoreAgent::GetIntSessionID() {
 	//return DMI_GetIntSessionID();
-  return 1;
+	CDialogSession *pSession = CDialogSession::GetCurrent();
+	return pSession?pSession->GetSessionID():1;
 }
 
 //-----------------------------------------------------------------------------
@@ -586,7 +1081,7 @@ void CDMCoreAgent::computeCurrentSystemAction() {
 	// confirms, explicit confirms and requests
 	bool bFoundFocus = false;
 	for(unsigned int l = 0; 
-		!bFoundFocus && (l < eaAgenda.vCompiledExpectations.size()); 
+		!bFoundFocus && (l < peaAgenda->vCompiledExpectations.size()); 
 		l++) {
 
 		// set that we have found the focus
@@ -594,8 +1089,8 @@ void CDMCoreAgent::computeCurrentSystemAction() {
 
 		TMapCE::iterator iPtr;
 		// iterate through the compiled expectations from that level
-		for(iPtr = eaAgenda.vCompiledExpectations[l].mapCE.begin(); 
-			iPtr != eaAgenda.vCompiledExpectations[l].mapCE.end(); 
+		for(iPtr = peaAgenda->vCompiledExpectations[l].mapCE.begin(); 
+			iPtr != peaAgenda->vCompiledExpectations[l].mapCE.end(); 
 			iPtr++) {
 
 			string sSlotExpected = iPtr->first;
@@ -606,7 +1101,7 @@ void CDMCoreAgent::computeCurrentSystemAction() {
 
 				// grab the expectation
 				TConceptExpectation& rceExpectation = 
-					eaAgenda.celSystemExpectations[rvIndices[i]];
+					peaAgenda->celSystemExpectations[rvIndices[i]];
 
 				// find the concept name
 				CConcept* pConcept = &(rceExpectation.pDialogAgent->
@@ -726,23 +1221,29 @@ void CDMCoreAgent::assembleExpectationAgenda() {
 		+ expectationAgendaToString());
 
 	Log(DMCORE_STREAM, "Expectation Agenda Assembly Phase completed "\
-		"(%d levels).", eaAgenda.vCompiledExpectations.size());
+		"(%d levels).", peaAgenda->vCompiledExpectations.size());
 }
 
 // D: gathers the expectations and compiles them in an fast accessible
 //    form
 // D: definition of an internal type: a set of pointers to an agent
-typedef set<CDialogAgent*, less <CDialogAgent*>, allocator <CDialogAgent*> > 
-	TDialogAgentSet;
+typedef unordered_set<CDialogAgent*> TDialogAgentSet;
 
 void CDMCoreAgent::compileExpectationAgenda() {
 
 	// log the activity
 	Log(DMCORE_STREAM, "Compiling Expectation Agenda ...");
 
-	// first clear up the last agenda
-	eaAgenda.celSystemExpectations.clear();
-	eaAgenda.vCompiledExpectations.clear();
+	// start a new agenda (the last one may be kept by the dialog states)
+	peaAgenda = make_shared <TExpectationAgenda> ();
+
+	// the declarations kept from the previous assemblies are still good 
+	// as long as the dialog task tree did not change
+	if(!bUseIncrementalAgenda)
+		dehDeclaredExpectations.clear();
+	int iTreeVersion = pDTTManager->GetTreeVersion();
+	uiAgendaAssemblies++;
+	int iLevelsDeclared = 0;
 
 	// get the list of system expectations. To do this, we traverse 
 	// the execution stack, and add expectations from all the agents, each 
@@ -760,66 +1261,109 @@ void CDMCoreAgent::compileExpectationAgenda() {
         iPtr != esExecutionStack.end(); 
         iPtr++) {
 		
-		// remember how big the system expectation agenda was so far
-		int iStartIndex = eaAgenda.celSystemExpectations.size();
-		
-		// gather expectations of the agent on the stack indicated by iPtr
-		iPtr->pdaAgent->DeclareExpectations(eaAgenda.celSystemExpectations);
+		// gather expectations of the agent on the stack indicated by iPtr:
+		// if it was just pushed (or the tree changed since it declared them)
+		// the agent declares them now, otherwise the ones it declared 
+		// earlier are reused, and only their state is updated below
+		TDeclaredExpectationsHash::iterator iDeclared = 
+			dehDeclaredExpectations.find(iPtr->pdaAgent);
+		bool bDeclared = (iDeclared == dehDeclaredExpectations.end()) ||
+			(iDeclared->second.iTreeVersion != iTreeVersion);
+		if(iDeclared == dehDeclaredExpectations.end())
+			iDeclared = dehDeclaredExpectations.insert(
+				TDeclaredExpectationsHash::value_type(iPtr->pdaAgent, 
+					TDeclaredExpectations())).first;
+		TDeclaredExpectations& rdeDeclared = iDeclared->second;
+		if(bDeclared) {
+			rdeDeclared.celExpectations.clear();
+			iPtr->pdaAgent->DeclareExpectations(rdeDeclared.celExpectations);
+			rdeDeclared.iTreeVersion = iTreeVersion;
+			iLevelsDeclared++;
+		}
+		rdeDeclared.uiAssembly = uiAgendaAssemblies;
 
-		// now go thourgh those new expectations and compile them (create 
+		// now go thourgh those expectations and compile them (create 
 		// the corresponding entry into the vCompiledExpectations array)
 		TCompiledExpectationLevel celLevel;
 		// set the agent that generated this level
 		celLevel.pdaGenerator = iPtr->pdaAgent;
-		for(unsigned int i = iStartIndex; 
-			i < eaAgenda.celSystemExpectations.size();
-			i++) {
+		CDialogAgent* pdaLastAgent = NULL;
+		bool bExpectCondition = true;
+		for(unsigned int i = 0; i < rdeDeclared.celExpectations.size(); i++) {
+
+			TConceptExpectation& rceDeclared = rdeDeclared.celExpectations[i];
 
 			// check that the agent was not already seen on the previous
 			// level (in this case, avoid duplicating its expectation)
-			if(setPreviouslySeenAgents.find(
-				eaAgenda.celSystemExpectations[i].pDialogAgent) != 
+			if(setPreviouslySeenAgents.find(rceDeclared.pDialogAgent) != 
 				setPreviouslySeenAgents.end()) {
 				continue;
 			}
 
 			// insert this agent in the list of currently seen agents
-			setCurrentlySeenAgents.insert(
-				eaAgenda.celSystemExpectations[i].pDialogAgent);
+			setCurrentlySeenAgents.insert(rceDeclared.pDialogAgent);
+
+			// add the expectation to the system expectations, and bring 
+			// its state up to date if it was declared earlier (the 
+			// expectations of an agent are declared one after the other, 
+			// so its expect condition is evaluated once)
+			int iIndex = peaAgenda->celSystemExpectations.size();
+			peaAgenda->celSystemExpectations.push_back(rceDeclared);
+			if(!bDeclared) {
+				if(rceDeclared.pDialogAgent != pdaLastAgent) {
+					pdaLastAgent = rceDeclared.pDialogAgent;
+					bExpectCondition = pdaLastAgent->ExpectCondition();
+				}
+				pdaLastAgent->UpdateExpectation(
+					peaAgenda->celSystemExpectations[iIndex], bExpectCondition);
+			}
 
-			string sSlotExpected = 
-				eaAgenda.celSystemExpectations[i].sGrammarExpectation;
+			string& rsSlotExpected = rceDeclared.sGrammarExpectation;
 			TMapCE::iterator iPtr2;
-			if((iPtr2 = celLevel.mapCE.find(sSlotExpected)) != 
+			if((iPtr2 = celLevel.mapCE.find(rsSlotExpected)) != 
                 celLevel.mapCE.end()) {
 				// if this grammar slot is already expected at this level
     		    // just add to the vector of pointers
 				TIntVector& rvIndices = (*iPtr2).second;
-    		    rvIndices.push_back(i);
+    		    rvIndices.push_back(iIndex);
 			} else {
 				// if the concept is NOT already expected at this level
 				// then add it to the hash of compiled expectations
 				TIntVector ivTemp;
-				ivTemp.push_back(i);
+				ivTemp.push_back(iIndex);
 				celLevel.mapCE.insert(
-					TMapCE::value_type(sSlotExpected, ivTemp));
+					TMapCE::value_type(rsSlotExpected, ivTemp));
 			}			
 		}
 
 		// finally, we have assembled and compiled this level of expectations,
 		// push it on the array, 
-		eaAgenda.vCompiledExpectations.push_back(celLevel);
+		peaAgenda->vCompiledExpectations.push_back(celLevel);
 
 		// update the set of already seen agents
 		setPreviouslySeenAgents.insert(setCurrentlySeenAgents.begin(), 
 									   setCurrentlySeenAgents.end());
+		setCurrentlySeenAgents.clear();
 
 		// and move to the next level
 		iLevel++;	
 	}
 
+	// forget the declarations of the agents that left the stack
+	if(dehDeclaredExpectations.size() > peaAgenda->vCompiledExpectations.size()) {
+		TDeclaredExpectationsHash::iterator iDeclared = 
+			dehDeclaredExpectations.begin();
+		while(iDeclared != dehDeclaredExpectations.end()) {
+			if(iDeclared->second.uiAssembly != uiAgendaAssemblies)
+				iDeclared = dehDeclaredExpectations.erase(iDeclared);
+			else
+				iDeclared++;
+		}
+	}
+
 	// log the activity
-	Log(DMCORE_STREAM, "Compiling Expectation Agenda completed.");
+	Log(DMCORE_STREAM, "Compiling Expectation Agenda completed (%d of %d "\
+		"levels declared).", iLevelsDeclared, iLevel);
 }
 
 // D: goes through the compiled agenda, and modifies it according to the 
@@ -831,31 +1375,31 @@ void CDMCoreAgent::enforceBindingPolicies() {
 
 	// at this point, this only consists of blocking the upper levels if a 
 	// WITHIN_TOPIC_ONLY policy is detected
-	for(unsigned int i = 0; i < eaAgenda.vCompiledExpectations.size(); i++) {
+	for(unsigned int i = 0; i < peaAgenda->vCompiledExpectations.size(); i++) {
 		// get the binding policy for this level
 		string sBindingPolicy = 
-			eaAgenda.vCompiledExpectations[i].pdaGenerator->DeclareBindingPolicy();
+			peaAgenda->vCompiledExpectations[i].pdaGenerator->DeclareBindingPolicy();
 		if(sBindingPolicy == WITHIN_TOPIC_ONLY) {
 			// if WITHIN_TOPIC_ONLY, then all the expectations from the upper
 			// levels of the agenda are disabled
 			for(unsigned int l = i+1; 
-				l < eaAgenda.vCompiledExpectations.size(); 
+				l < peaAgenda->vCompiledExpectations.size(); 
 				l++) {
 				// go through the whole level and disable all expectations
 				TMapCE::iterator iPtr;
-				for(iPtr = eaAgenda.vCompiledExpectations[l].mapCE.begin(); 
-					iPtr != eaAgenda.vCompiledExpectations[l].mapCE.end(); 
+				for(iPtr = peaAgenda->vCompiledExpectations[l].mapCE.begin(); 
+					iPtr != peaAgenda->vCompiledExpectations[l].mapCE.end(); 
 					iPtr++) {
 					// access the indices 
 					TIntVector& rivTemp = iPtr->second;
 					for(unsigned int ii = 0; ii < rivTemp.size(); ii++) {
 						int iIndex = rivTemp[ii];
                         // don't disable it if it's a *-type expectation
-                        if(eaAgenda.celSystemExpectations[iIndex].\
+                        if(peaAgenda->celSystemExpectations[iIndex].\
                             sExpectationType != "*") {
-						    eaAgenda.celSystemExpectations[iIndex].bDisabled = 
+						    peaAgenda->celSystemExpectations[iIndex].bDisabled = 
                                 true;
-						    eaAgenda.celSystemExpectations[iIndex].sReasonDisabled = 
+						    peaAgenda->celSystemExpectations[iIndex].sReasonDisabled = 
 							    "within-topic binding policy"; // *** add on what
                         }
 					}
@@ -876,20 +1420,20 @@ void CDMCoreAgent::enforceBindingPolicies() {
 string CDMCoreAgent::expectationAgendaToString() {
 	string sResult;
 	// go through all the levels of the agenda
-	for(unsigned int l = 0; l < eaAgenda.vCompiledExpectations.size(); l++) {
+	for(unsigned int l = 0; l < peaAgenda->vCompiledExpectations.size(); l++) {
 		sResult += FormatString("\n Level %d: generated by %s", l, 
-			eaAgenda.vCompiledExpectations[l].pdaGenerator->GetName().c_str());
+			peaAgenda->vCompiledExpectations[l].pdaGenerator->GetName().c_str());
 		TMapCE::iterator iPtr;
 		// iterate through the compiled expectations from that level
-		for(iPtr = eaAgenda.vCompiledExpectations[l].mapCE.begin(); 
-			iPtr != eaAgenda.vCompiledExpectations[l].mapCE.end(); 
+		for(iPtr = peaAgenda->vCompiledExpectations[l].mapCE.begin(); 
+			iPtr != peaAgenda->vCompiledExpectations[l].mapCE.end(); 
 			iPtr++) {
 			string sSlotExpected = iPtr->first;
 			TIntVector& rvIndices = iPtr->second;
 			// convert expectations to string description
 			for(unsigned int i = 0; i < rvIndices.size(); i++) {
 				TConceptExpectation& rceExpectation = 
-					eaAgenda.celSystemExpectations[rvIndices[i]];
+					peaAgenda->celSystemExpectations[rvIndices[i]];
 				sResult += (rceExpectation.bDisabled)?"\n  X ":"\n  O ";
 				sResult += rceExpectation.sGrammarExpectation + " -> (" + 
 						   rceExpectation.pDialogAgent->GetName() + ")" +
@@ -906,12 +1450,13 @@ string CDMCoreAgent::expectationAgendaToString() {
 
 // A: generates a string representation of the current agenda
 string CDMCoreAgent::expectationAgendaToBroadcastString() {
-	return expectationAgendaToBroadcastString(eaAgenda);
+	return expectationAgendaToBroadcastString(*peaAgenda);
 }
 
 // D: generates a string representation of the expectation agenda
 //    that is used to broadcast it to the outside world
-string CDMCoreAgent::expectationAgendaToBroadcastString(TExpectationAgenda eaBAgenda) {
+string CDMCoreAgent::expectationAgendaToBroadcastString(
+	TExpectationAgenda& eaBAgenda) {
 	string sResult;
     STRING2STRING s2sAllOpenGrammarExpectations;
 	// go through all the levels of the agenda
@@ -1050,24 +1595,30 @@ Log(DMCORE_STREAM, "Concepts Binding Phase initiated.");
 	// hash which stores the slots that were blocked and how many times they were
 	// blocked
 	map<string, int> msiSlotsBlocked;
+
+	// the event the concepts are bound from
+	CInteractionEvent* pieLastEvent = pInteractionEventManager->GetLastEvent();
     
 	// go through each concept expectation level and try to bind things
 	for(unsigned int iLevel = 0; 
-		iLevel < eaAgenda.vCompiledExpectations.size(); 
+		iLevel < peaAgenda->vCompiledExpectations.size(); 
 		iLevel++) {
 
 		// go through the hash of expected slots at that level
 		TMapCE::iterator iPtr;
-		for(iPtr = eaAgenda.vCompiledExpectations[iLevel].mapCE.begin();
-			iPtr != eaAgenda.vCompiledExpectations[iLevel].mapCE.end();
+		for(iPtr = peaAgenda->vCompiledExpectations[iLevel].mapCE.begin();
+			iPtr != peaAgenda->vCompiledExpectations[iLevel].mapCE.end();
 			iPtr++) {
 		
-			string sSlotExpected = iPtr->first;	// the grammar slot expected
+			const string& sSlotExpected = iPtr->first;	// the slot expected
 			TIntVector& rvIndices = iPtr->second;	// indices in the system 
 													//   expectation list
 
 			// if the slot actually exists in the parse, then try to bind it
-			if(pInteractionEventManager->LastEventMatches(sSlotExpected)) {
+			// (and get its value at the same time)
+			const string* psSlotValue = 
+				pieLastEvent->FindValueForExpectation(sSlotExpected);
+			if(psSlotValue != NULL) {
 
 				Log(DMCORE_STREAM, "Event matches %s.", sSlotExpected.c_str());
 
@@ -1087,11 +1638,11 @@ Log(DMCORE_STREAM, "Concepts Binding Phase initiated.");
                 for(unsigned int i = 0; i < rvIndices.size(); i++) {
 					// determine the concept under consideration
                     CConcept* pConcept = 
-                        &(eaAgenda.celSystemExpectations[rvIndices[i]].pDialogAgent->C(
-                            eaAgenda.celSystemExpectations[rvIndices[i]].sConceptName));
+                        &(peaAgenda->celSystemExpectations[rvIndices[i]].pDialogAgent->C(
+                            peaAgenda->celSystemExpectations[rvIndices[i]].sConceptName));
                     
                     // test that the expectation is not disabled
-                    if(!eaAgenda.celSystemExpectations[rvIndices[i]].bDisabled) {
+                    if(!peaAgenda->celSystemExpectations[rvIndices[i]].bDisabled) {
                         if(scpOpenConcepts.find(pConcept) == scpOpenConcepts.end()) {
 	                        // add it to the open indices list
 						    vOpenIndices.push_back(rvIndices[i]);
@@ -1135,10 +1686,10 @@ Log(DMCORE_STREAM, "Concepts Binding Phase initiated.");
 						    string sAgents;
 						    for(unsigned int i=0; i < vOpenIndices.size(); i++) {
 							    sAgents += 
-								    eaAgenda.celSystemExpectations[vOpenIndices[i]].\
+								    peaAgenda->celSystemExpectations[vOpenIndices[i]].\
                                     pDialogAgent->GetName() + 
 								    " tries to bind to " + 
-								    eaAgenda.celSystemExpectations[vOpenIndices[i]].\
+								    peaAgenda->celSystemExpectations[vOpenIndices[i]].\
                                     sConceptName + 
 								    "\n";
 						    }
@@ -1150,8 +1701,11 @@ Log(DMCORE_STREAM, "Concepts Binding Phase initiated.");
 
 					    // now bind the grammar concept to the first agent expecting 
 					    // this slot; obtain the value for that grammar slot
-					    sSlotValue = 
-						    pInteractionEventManager->GetValueForExpectation(sSlotExpected);
+					    sSlotValue = *psSlotValue;
+						if(sSlotValue == "") {
+							Warning(FormatString("Event property %s has empty "\
+								"value.", sSlotExpected.c_str()));
+						}
 
 					    // do the actual concept binding
 					    performConceptBinding(sSlotExpected, sSlotValue, 
@@ -1161,9 +1715,9 @@ Log(DMCORE_STREAM, "Concepts Binding Phase initiated.");
 					    // now that we've bound at this level, invalidate this 
 					    // expected slot on all the other levels
 					    for(unsigned int iOtherLevel = iLevel + 1; 
-						    iOtherLevel < eaAgenda.vCompiledExpectations.size(); 
+						    iOtherLevel < peaAgenda->vCompiledExpectations.size(); 
 						    iOtherLevel++) {					
-						    eaAgenda.vCompiledExpectations[iOtherLevel].\
+						    peaAgenda->vCompiledExpectations[iOtherLevel].\
                                 mapCE.erase(sSlotExpected);
 					    }
                     } else {
@@ -1185,13 +1739,13 @@ Log(DMCORE_STREAM, "Concepts Binding Phase initiated.");
                             bBinding.iLevel = iLevel;
                             bBinding.fConfidence = fConfidence;
                             bBinding.sAgentName = 
-                                eaAgenda.celSystemExpectations[vOpenIndices[i]].\
+                                peaAgenda->celSystemExpectations[vOpenIndices[i]].\
                                 pDialogAgent->GetName();
                             bBinding.sConceptName = 
-                                eaAgenda.celSystemExpectations[vOpenIndices[i]].\
+                                peaAgenda->celSystemExpectations[vOpenIndices[i]].\
                                 sConceptName;
                             bBinding.sGrammarExpectation = 
-                                eaAgenda.celSystemExpectations[vOpenIndices[i]].\
+                                peaAgenda->celSystemExpectations[vOpenIndices[i]].\
                                 sGrammarExpectation;
                             bBinding.sValue = sSlotValue;
                             rbdBindings.vbBindings.push_back(bBinding);
@@ -1212,13 +1766,13 @@ Log(DMCORE_STREAM, "Concepts Binding Phase initiated.");
                             bBlockedBinding.iLevel = iLevel;
                             bBlockedBinding.fConfidence = fConfidence;
                             bBlockedBinding.sAgentName = 
-                                eaAgenda.celSystemExpectations[vOpenIndices[i]].\
+                                peaAgenda->celSystemExpectations[vOpenIndices[i]].\
                                 pDialogAgent->GetName();
                             bBlockedBinding.sConceptName = 
-                                eaAgenda.celSystemExpectations[vOpenIndices[i]].\
+                                peaAgenda->celSystemExpectations[vOpenIndices[i]].\
                                 sConceptName;
                             bBlockedBinding.sGrammarExpectation = 
-                                eaAgenda.celSystemExpectations[vOpenIndices[i]].\
+                                peaAgenda->celSystemExpectations[vOpenIndices[i]].\
                                 sGrammarExpectation;
                             bBlockedBinding.sReasonDisabled = 
                                 "confidence below nonunderstanding threshold";
@@ -1245,16 +1799,16 @@ Log(DMCORE_STREAM, "Concepts Binding Phase initiated.");
                     bBlockedBinding.iLevel = iLevel;
                     bBlockedBinding.fConfidence = fConfidence;
                     bBlockedBinding.sAgentName = 
-                        eaAgenda.celSystemExpectations[vClosedIndices[i]].\
+                        peaAgenda->celSystemExpectations[vClosedIndices[i]].\
                         pDialogAgent->GetName();
                     bBlockedBinding.sConceptName = 
-                        eaAgenda.celSystemExpectations[vClosedIndices[i]].\
+                        peaAgenda->celSystemExpectations[vClosedIndices[i]].\
                         sConceptName;
                     bBlockedBinding.sGrammarExpectation = 
-                        eaAgenda.celSystemExpectations[vClosedIndices[i]].\
+                        peaAgenda->celSystemExpectations[vClosedIndices[i]].\
                         sGrammarExpectation;
                     bBlockedBinding.sReasonDisabled = 
-                        eaAgenda.celSystemExpectations[vClosedIndices[i]].\
+                        peaAgenda->celSystemExpectations[vClosedIndices[i]].\
                         sReasonDisabled;
                     bBlockedBinding.sValue = sSlotValue;
                     rbdBindings.vbBindings.push_back(bBlockedBinding);
@@ -1326,7 +1880,7 @@ void CDMCoreAgent::performConceptBinding(string sSlotName, string sSlotValue,
 	
     // obtain a reference to the expectation structure
 	TConceptExpectation& ceExpectation = 
-		eaAgenda.celSystemExpectations[iExpectationIndex];
+		peaAgenda->celSystemExpectations[iExpectationIndex];
 
     // compute the value we need to bind to that concept
     string sValueToBind = ""; 
@@ -1555,12 +2109,20 @@ void CDMCoreAgent::performForcedConceptUpdates(TBindingsDescr& rbdBindings) {
 int CDMCoreAgent::assembleFocusClaims() {
 	Log(DMCORE_STREAM, "Focus Claims Assembly Phase initiated.");
 	
-	// gather the focus claims, starting with the root of the dialog task tree
-	int iClaims = 0;
+	// gather the focus claims, starting with the root of the dialog task 
+	// tree
     TFocusClaimsList fclTempFocusClaims;
-	iClaims = 
+	int iClaims = 
 		pDTTManager->GetDialogTaskTreeRoot()->DeclareFocusClaims(
-            fclTempFocusClaims);
+			fclTempFocusClaims);
+
+	// the first walk over a version of the tree visits all of it; then the
+	// subtrees in which an agent may claim the focus are indexed, so that 
+	// until the tree changes only those are visited
+	if(bUseFocusClaimsIndex && !HasFocusClaimsIndex()) {
+		pDTTManager->GetDialogTaskTreeRoot()->IndexFocusClaims();
+		iFocusClaimsIndexVersion = pDTTManager->GetTreeVersion();
+	}
 
     // log the list of claiming agents
     string sLogString;
@@ -1585,10 +2147,9 @@ int CDMCoreAgent::assembleFocusClaims() {
     fclFocusClaims.clear();
     sLogString = "";
     for(unsigned int i = 0; i < fclTempFocusClaims.size(); i++) {
-        CDialogAgent* pdaFocusClaimingAgent =
-            (CDialogAgent *)AgentsRegistry[fclTempFocusClaims[i].sAgentName];
-        if(pdaFocusClaimingAgent->SuccessCriteriaSatisfied() || 
-           pdaFocusClaimingAgent->FailureCriteriaSatisfied() ||
+        CDialogAgent* pdaFocusClaimingAgent = fclTempFocusClaims[i].pdaAgent;
+        if(pdaFocusClaimingAgent->EvaluateSuccessCriteria() || 
+           pdaFocusClaimingAgent->EvaluateFailureCriteria() ||
            AgentIsActive(pdaFocusClaimingAgent) ||
            (!fclTempFocusClaims[i].bClaimDuringGrounding && bDuringGrounding)) {
             // eliminate the agent from the list of agents claiming focus
@@ -1636,7 +2197,7 @@ void CDMCoreAgent::resolveFocusShift() {
 	    Log(DMCORE_STREAM, 
             "Adding focus-claiming agent %s on the execution stack.", 
 		    sClaimingAgent.c_str());
-	    ContinueWith(this, (CDialogAgent *)AgentsRegistry[sClaimingAgent]);
+	    ContinueWith(this, fclFocusClaims[i].pdaAgent);
     }
 }
 
@@ -1648,6 +2209,9 @@ void CDMCoreAgent::resolveFocusShift() {
 // D: sets the timeout period
 void CDMCoreAgent::SetTimeoutPeriod(int iATimeoutPeriod) {
 	iTimeoutPeriod = iATimeoutPeriod;
+	// a new request (re)starts the turn timeout of the session
+	if(CDialogSession::GetCurrent())
+		CDialogSession::GetCurrent()->ArmTurnTimeout(iTimeoutPeriod);
 	//DMI_SetTimeoutPeriod(iTimeoutPeriod);
 }
 
@@ -1834,6 +2398,7 @@ void CDMCoreAgent::ContinueWith(CAgent* paPusher, CDialogAgent* pdaDialogAgent)
 
 	// signals that the agenda needs to be recomputed
 	bAgendaModifiedFlag = true;
+	NotifyDialogStateChanged();
 
     //Log(DMCORE_STREAM, "Agent %s added on the execution stack by %s.", 
         //ehi.sCurrentAgent.c_str(), ehi.sScheduledBy.c_str());
@@ -1894,31 +2459,50 @@ void CDMCoreAgent::StartOver() {
 	} else {
         (*csoStartOverFunct)();
     }
+	NotifyDialogStateChanged();
 }
 
 // D: Pops all the completed agents (and all the agents they have ever planned
 //	  for off the execution stack
+// D: the stack is scanned once from the top down; every completed agent 
+//    found is marked for elimination together with the agents it has 
+//    planned, and the marked agents are then removed in a single pass. The 
+//    scan is repeated (only) if agents were eliminated, in case their 
+//    OnCompletion methods completed others
 int CDMCoreAgent::popCompletedFromExecutionStack() {
-	TExecutionStack::iterator iPtr;
 	bool bFoundCompleted;	// indicates if completed agents were still found
 	
     TStringVector vsAgentsEliminated;
-    // when no more completed agents can be found, return
 	do {
 		bFoundCompleted = false;
-		// go through the execution stack
-		for(iPtr = esExecutionStack.begin(); 
-			iPtr != esExecutionStack.end(); 
-			iPtr++) {
+		// the marks and the index are only built once a completed agent
+		// is found
+		vector <bool> vbMarked;
+		TScheduledAgentsIndex saiIndex;
+		// go through the execution stack, from the top down
+		for(int i = (int)esExecutionStack.size() - 1; i >= 0; i--) {
+			if(bFoundCompleted && vbMarked[i]) continue;
 
 			// if you find an agent that has completed
-			if(iPtr->pdaAgent->HasCompleted()) {
-				// pop it off the execution stack
-				popTopicFromExecutionStack(iPtr->pdaAgent, vsAgentsEliminated);
-				bFoundCompleted = true;
-				break;
+			CDialogAgent* pdaAgent = esExecutionStack.GetItemAt(i).pdaAgent;
+			if(pdaAgent->HasCompleted()) {
+				if(!bFoundCompleted) {
+					vbMarked.assign(esExecutionStack.size(), false);
+					indexScheduledAgents(saiIndex);
+					bFoundCompleted = true;
+				}
+				// mark it, together with the agents it has planned
+				markForElimination(i, vbMarked, vsAgentsEliminated);
+				markScheduledForElimination(pdaAgent, saiIndex, vbMarked,
+					vsAgentsEliminated);
 			}
 		}
+
+		// now eliminate them
+		if(bFoundCompleted) {
+			esExecutionStack.RemoveMarked(vbMarked);
+			bAgendaModifiedFlag = true;
+		}
 	} while(bFoundCompleted);
 
     // when no more completed agents can be found, log and return
@@ -1966,6 +2550,7 @@ void CDMCoreAgent::popAgentFromExecutionStack(CDialogAgent* pdaADialogAgent,
 
 	// call the agent's OnCompletion method
 	iPtr->pdaAgent->OnCompletion();
+	NotifyDialogStateChanged();
 
     // and add it to the list of eliminated agents
     rvsAgentsEliminated.push_back(iPtr->pdaAgent->GetName());
@@ -2001,59 +2586,16 @@ void CDMCoreAgent::popTopicFromExecutionStack(CDialogAgent* pdaADialogAgent,
 				   " agent off the execution stack. Agent not found.");
 	}
 
-	// the set of eliminated agents
-	set<CDialogAgent*, less<CDialogAgent*> > sEliminatedAgents;
-	
-	// initialize it with the starting agent
-	sEliminatedAgents.insert(iPtr->pdaAgent);
-
-	// mark the time this agent's execution was terminated
-	//ehExecutionHistory[iPtr->iEHIndex].timeTerminated = GetTime();
-
-	// call the agent's OnCompletion method
-	iPtr->pdaAgent->OnCompletion();
-
-    // and add it to the list of eliminated agents
-    rvsAgentsEliminated.push_back(iPtr->pdaAgent->GetName());
-
-    // eliminate the agent from the stack
-	esExecutionStack.erase(iPtr);
-
-    // now enter in a loop going through the stack repeatedly until 
-    // we didn't find anything else to remove
-    bool bFoundAgentToRemove = true;
-
-    while(bFoundAgentToRemove) {
-
-        bFoundAgentToRemove = false;
-
-        // now traverse the stack
-        for(iPtr = esExecutionStack.begin(); 
-            iPtr != esExecutionStack.end(); 
-            iPtr++) {
-
-		    // check to see who planned the current agent
-		    CDialogAgent* pdaScheduler = (CDialogAgent *)
-			    AgentsRegistry[ehExecutionHistory[iPtr->iEHIndex].sScheduledBy];
-		    if(sEliminatedAgents.find(pdaScheduler) != sEliminatedAgents.end()) {
-			    // then we need to eliminate this one; so first add it to the 
-			    // list of eliminated agents
-			    sEliminatedAgents.insert(iPtr->pdaAgent);
-			    // mark the time this agent execution was terminated
-					//ehExecutionHistory[iPtr->iEHIndex].timeTerminated = GetTime();
-			    // call the agent's OnCompletion method
-			    iPtr->pdaAgent->OnCompletion();
-                // and add it to the list of eliminated agents
-                rvsAgentsEliminated.push_back(iPtr->pdaAgent->GetName());
-			    // eliminate the agent from the stack
-			    esExecutionStack.erase(iPtr);
-                // set found one to true
-                bFoundAgentToRemove = true; 
-                // and break the for loop
-                break;
-		    } 
-        }
-	}
+	// mark it, together with all the agents it has planned (recursively),
+	// and eliminate them from the stack
+	int iPosition = iPtr.GetPosition();
+	vector <bool> vbMarked(esExecutionStack.size(), false);
+	TScheduledAgentsIndex saiIndex;
+	indexScheduledAgents(saiIndex);
+	markForElimination(iPosition, vbMarked, rvsAgentsEliminated);
+	markScheduledForElimination(pdaADialogAgent, saiIndex, vbMarked, 
+		rvsAgentsEliminated);
+	esExecutionStack.RemoveMarked(vbMarked);
 
 	bAgendaModifiedFlag = true;
 }
@@ -2066,52 +2608,77 @@ void CDMCoreAgent::popGroundingAgentsFromExecutionStack(TStringVector& rvsAgents
 		return;
 	}
 
-	// the set of eliminated agents
-	set<CAgent*, less<CAgent*> > sEliminatedAgents;
-	
-	// initialize it with the grounding manager agent since it
-	// schedules all root grounding agents
-	sEliminatedAgents.insert(pGroundingManager);
-
-    // now enter in a loop going through the stack repeatedly until 
-    // we didn't find anything else to remove
-    bool bFoundAgentToRemove = true;
-
-    while(bFoundAgentToRemove) {
-
-        bFoundAgentToRemove = false;
-
-        // now traverse the stack
-        for(TExecutionStack::iterator iPtr = esExecutionStack.begin(); 
-            iPtr != esExecutionStack.end(); 
-            iPtr++) {
-
-		    // check to see who planned the current agent
-		    CDialogAgent* pdaScheduler = (CDialogAgent *)
-			    AgentsRegistry[ehExecutionHistory[iPtr->iEHIndex].sScheduledBy];
-		    if(sEliminatedAgents.find(pdaScheduler) != sEliminatedAgents.end()) {
-			    // then we need to eliminate this one; so first add it to the 
-			    // list of eliminated agents
-			    sEliminatedAgents.insert(iPtr->pdaAgent);
-			    // mark the time this agent execution was terminated
-					//ehExecutionHistory[iPtr->iEHIndex].timeTerminated = GetTime();
-			    // call the agent's OnCompletion method
-			    iPtr->pdaAgent->OnCompletion();
-                // and add it to the list of eliminated agents
-                rvsAgentsEliminated.push_back(iPtr->pdaAgent->GetName());
-			    // eliminate the agent from the stack
-			    esExecutionStack.erase(iPtr);
-                // set found one to true
-                bFoundAgentToRemove = true; 
-                // and break the for loop
-                break;
-		    } 
-        }
-	}
+	// eliminate all the agents planned by the grounding manager agent 
+	// (recursively), since it schedules all root grounding agents
+	vector <bool> vbMarked(esExecutionStack.size(), false);
+	TScheduledAgentsIndex saiIndex;
+	indexScheduledAgents(saiIndex);
+	markScheduledForElimination(pGroundingManager, saiIndex, vbMarked, 
+		rvsAgentsEliminated);
+	esExecutionStack.RemoveMarked(vbMarked);
 
 	bAgendaModifiedFlag = true;
 }
 
+// D: Indexes the agents on the execution stack by the agents that planned
+//    them
+void CDMCoreAgent::indexScheduledAgents(TScheduledAgentsIndex& rsaiIndex) {
+	rsaiIndex.clear();
+	for(int i = 0; i < (int)esExecutionStack.size(); i++) {
+		CAgent* paScheduler = AgentsRegistry[ehExecutionHistory[
+			esExecutionStack.GetItemAt(i).iEHIndex].sScheduledBy];
+		rsaiIndex[paScheduler].push_back(i);
+	}
+}
+
+// D: Marks an agent on the execution stack for elimination
+void CDMCoreAgent::markForElimination(int iPosition, vector <bool>& rvbMarked,
+	TStringVector& rvsAgentsEliminated) {
+	CDialogAgent* pdaAgent = esExecutionStack.GetItemAt(iPosition).pdaAgent;
+	rvbMarked[iPosition] = true;
+	// mark the time this agent's execution was terminated
+	//ehExecutionHistory[iPtr->iEHIndex].timeTerminated = GetTime();
+	// call the agent's OnCompletion method
+	pdaAgent->OnCompletion();
+	NotifyDialogStateChanged();
+    // and add it to the list of eliminated agents
+    rvsAgentsEliminated.push_back(pdaAgent->GetName());
+}
+
+// D: Marks for elimination all the agents on the execution stack that an 
+//    agent has planned, recursively
+// D: the agents are marked in the same order as when the stack was scanned
+//    again from the top after each elimination: at every step, the topmost
+//    agent that was planned by one of the eliminated ones
+void CDMCoreAgent::markScheduledForElimination(CAgent* paScheduler,
+	TScheduledAgentsIndex& rsaiIndex, vector <bool>& rvbMarked,
+	TStringVector& rvsAgentsEliminated) {
+	// the positions of the agents left to mark, the topmost one first
+	priority_queue <int> qiPending;
+	TScheduledAgentsIndex::iterator iPtr = rsaiIndex.find(paScheduler);
+	if(iPtr == rsaiIndex.end()) return;
+	for(unsigned int i = 0; i < iPtr->second.size(); i++)
+		qiPending.push(iPtr->second[i]);
+	// the agents are not planned twice
+	rsaiIndex.erase(iPtr);
+
+	while(!qiPending.empty()) {
+		int iPosition = qiPending.top();
+		qiPending.pop();
+		if(rvbMarked[iPosition]) continue;
+		CDialogAgent* pdaAgent = 
+			esExecutionStack.GetItemAt(iPosition).pdaAgent;
+		markForElimination(iPosition, rvbMarked, rvsAgentsEliminated);
+		// and add the agents it has planned
+		iPtr = rsaiIndex.find(pdaAgent);
+		if(iPtr != rsaiIndex.end()) {
+			for(unsigned int i = 0; i < iPtr->second.size(); i++)
+				qiPending.push(iPtr->second[i]);
+			rsaiIndex.erase(iPtr);
+		}
+	}
+}
+
 // A: Rolls back to a previous dialog state (e.g. after a user barge-in)
 void CDMCoreAgent::rollBackDialogState(int iState) {
 
@@ -2135,14 +2702,18 @@ void CDMCoreAgent::rollBackDialogState(int iState) {
 		}
 	}
 
-	// Now updates the execution stack and the agenda
-	TDialogState dsCurrentState = (*pStateManager)[iState];
-	fsFloorStatus = dsCurrentState.fsFloorStatus;
-	esExecutionStack = dsCurrentState.esExecutionStack;
-	eaAgenda = dsCurrentState.eaAgenda;
-	saSystemAction = dsCurrentState.saSystemAction;
-	// There is no need to recompile the agenda
-	bAgendaModifiedFlag = false;
+	// Now updates the execution stack and the agenda (the state shares 
+	// them, so they are restored by pointer)
+	TDialogState& rdsState = (*pStateManager)[iState];
+	fsFloorStatus = rdsState.fsFloorStatus;
+	esExecutionStack = rdsState.esExecutionStack;
+	peaAgenda = rdsState.peaAgenda;
+	saSystemAction = rdsState.saSystemAction;
+	// There is no need to recompile the agenda (unless the state does not
+	// keep one: only the last state in the history does, and a state 
+	// restored from a session record does not)
+	bAgendaModifiedFlag = peaAgenda->vCompiledExpectations.empty();
+	NotifyDialogStateChanged();
 
 	// And updates the current state
 	pStateManager->UpdateState();
@@ -2242,16 +2813,17 @@ void CDMCoreAgent::SignalUnplannedImplicitConfirmOnConcept(int iState,
 														   CConcept* pConcept) {
 
 	if (iState >= 0) {
-		if (((*pStateManager)[iState].saSystemAction.setcpImplicitConfirms.find(pConcept) == 
-			 (*pStateManager)[iState].saSystemAction.setcpImplicitConfirms.end()) &&
-			((*pStateManager)[iState].saSystemAction.setcpExplicitConfirms.find(pConcept) == 
-			 (*pStateManager)[iState].saSystemAction.setcpExplicitConfirms.end())) {
+		TSystemAction& rsaStateAction = pStateManager->GetSystemAction(iState);
+		if ((rsaStateAction.setcpImplicitConfirms.find(pConcept) == 
+			 rsaStateAction.setcpImplicitConfirms.end()) &&
+			(rsaStateAction.setcpExplicitConfirms.find(pConcept) == 
+			 rsaStateAction.setcpExplicitConfirms.end())) {
 			// if it's not already marked as being explicitly or implicitly confirmed
 			// now log the current system action 
 			Log(DMCORE_STREAM, FormatString("System action dumped below.\n%s", 
-				systemActionToString((*pStateManager)[iState].saSystemAction).c_str()));
+				systemActionToString(rsaStateAction).c_str()));
 
-			(*pStateManager)[iState].saSystemAction.setcpUnplannedImplicitConfirms.insert(pConcept);
+			rsaStateAction.setcpUnplannedImplicitConfirms.insert(pConcept);
 		}
 	} else {
 		if ((saSystemAction.setcpImplicitConfirms.find(pConcept) == 
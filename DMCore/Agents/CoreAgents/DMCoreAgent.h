@@ -54,6 +54,38 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  NotifyExpectationsChanged can be limited to 
+//                           one agent
+//   [2026-10-18] (agent):  SaveToRecord fails when the execution stack 
+//                           holds agents outside the dialog task tree
+//   [2026-10-18] (agent):  the execution stack keeps its items in shared 
+//                           blocks, so that a change after a copy copies
+//                           only the blocks it touches, not the stack
+//   [2026-10-18] (agent):  added NotifyExpectationsChanged, for agents 
+//                           whose expectations depend on the dialog state
+//   [2026-10-18] (agent):  the execution stack shares its items between 
+//                           its copies (copying it on the first change), 
+//                           and the core holds the expectation agenda 
+//                           through a shared pointer (TExpectationAgendaPtr),
+//                           so that the dialog states share them
+//   [2026-10-18] (agent):  the focus claims are gathered only from the 
+//                           subtrees in which an agent may claim the focus,
+//                           indexed once per version of the tree (added 
+//                           SetUseFocusClaimsIndex and HasFocusClaimsIndex)
+//   [2026-10-18] (agent):  added the dialog state version (see 
+//                           NotifyDialogStateChanged), which tells the 
+//                           agents when their cached completion criteria 
+//                           are stale
+//   [2026-10-18] (agent):  the execution stack is kept in a vector, and 
+//                           completed agents are removed from it in a single
+//                           pass (see CExecutionStack)
+//   [2026-10-18] (agent):  the expectations declared by the agents on the 
+//                           execution stack are kept between agenda 
+//                           assemblies (added SetUseIncrementalAgenda)
+//   [2026-10-18] (agent):  added SaveToRecord and LoadFromRecord, for session
+//                           hibernation
+//   [2026-10-18] (agent):  added Step, which runs the execution loop up to
+//                           the next interaction event and returns
 //   [2007-03-05] (antoine): changed Execute so that grounding and dialog agents
 //							 are only executed once the floor is free and all 
 //							 pending prompt notifications have been received 
@@ -127,6 +159,12 @@
 #include "Utils/Utils.h"
 #include "DMCore/Agents/Agent.h"
 #include "DMCore/Agents/DialogAgents/DialogAgent.h"
+#include "DMCore/Events/InteractionEvent.h"
+
+#include <memory>
+#include <iterator>
+
+class CSessionRecord;
 
 // D: when ALWAYS_CONFIDENT is defined, the binding on concepts will ignore the
 //    confidence scores on the input and will be considered "always confident"
@@ -157,7 +195,9 @@ typedef struct {
 //    contains the expectation list gathered from the dialog task tree, 
 //    and a "compiled" representation for each of the levels
 typedef struct {
-	// the full system expectations, as gathered from the dialog task tree
+	// the system expectations, as gathered from the dialog task tree (the
+	// expectations of an agent appear only once, on the topmost level that
+	// declares them)
 	TConceptExpectationList celSystemExpectations;		
 
 	// an array holding the expectations of different levels (on index 0, 
@@ -167,6 +207,29 @@ typedef struct {
 		vCompiledExpectations;
 } TExpectationAgenda; 
 
+// D: the expectation agenda, as shared by the core and the dialog states 
+//    that were saved while it was in use: once assembled, an agenda does 
+//    not change (the core assembles a new one instead), so saving it in a
+//    dialog state, or restoring it from one, is a pointer copy
+typedef shared_ptr <TExpectationAgenda> TExpectationAgendaPtr;
+
+// D: the expectations declared by an agent on the execution stack, as kept
+//    by the core between agenda assemblies. They are declared again only 
+//    when the dialog task tree changes, or when an agent signals that its
+//    expectations changed (see CDMCoreAgent::NotifyExpectationsChanged); 
+//    in between, only their state (open or disabled) is updated
+typedef struct {
+	TConceptExpectationList celExpectations;// the declared expectations
+	int iTreeVersion;						// the version of the dialog task
+											//  tree they were declared on
+	unsigned int uiAssembly;				// the last agenda assembly that
+											//  used them
+} TDeclaredExpectations;
+
+// D: the declared expectations, by the agent that declared them
+typedef unordered_map <CDialogAgent*, TDeclaredExpectations> 
+	TDeclaredExpectationsHash;
+
 
 //-----------------------------------------------------------------------------
 // D: Auxiliary type definitions for the execution stack and history
@@ -179,9 +242,188 @@ typedef struct {
 									//   entry
 } TExecutionStackItem;
 
-// D: definition of the execution stack type - essentially a list 
-typedef list <TExecutionStackItem, allocator<TExecutionStackItem> > 
-	TExecutionStack;
+// D: the execution stack: the items are kept in blocks of 
+//    EXECUTION_STACK_BLOCK items, from the bottom of the stack to the top,
+//    but iterated from the top down (begin() is the top of the stack, as 
+//    when the stack was a list). The blocks are shared by the copies of a
+//    stack (copying a stack, for a dialog state, copies the pointers to 
+//    its blocks), and a change copies only the blocks it touches: pushing
+//    on top copies at most the top block, and removing items copies the 
+//    blocks from the lowest removed item up, so that the bottom of the 
+//    stack stays shared with the copies. The items are only changed 
+//    through the stack's methods, so they are accessed as constants
+#define EXECUTION_STACK_BLOCK 16
+
+class CExecutionStack {
+
+private:
+	typedef vector <TExecutionStackItem> TBlock;
+
+	// the blocks of items, from the bottom of the stack to the top (all
+	// full, but the top one)
+	vector <shared_ptr <TBlock> > vpBlocks;
+	// the number of items
+	unsigned int uiSize;
+
+	// returns a block, for changing it: if it is shared with another copy
+	// of the stack, this one gets its own copy first
+	TBlock& ownBlock(unsigned int uiBlock) {
+		if(vpBlocks[uiBlock].use_count() > 1) {
+			shared_ptr <TBlock> pBlock = make_shared <TBlock> ();
+			pBlock->reserve(EXECUTION_STACK_BLOCK);
+			pBlock->assign(vpBlocks[uiBlock]->begin(), 
+				vpBlocks[uiBlock]->end());
+			vpBlocks[uiBlock] = pBlock;
+		}
+		return *vpBlocks[uiBlock];
+	}
+
+	// removes the items from a position up (the blocks above it are 
+	// dropped, and only the block holding it is changed)
+	void truncate(unsigned int uiPosition) {
+		if(uiPosition >= uiSize) return;
+		unsigned int uiBlocks = 
+			(uiPosition + EXECUTION_STACK_BLOCK - 1) / EXECUTION_STACK_BLOCK;
+		vpBlocks.resize(uiBlocks);
+		if(uiPosition % EXECUTION_STACK_BLOCK != 0)
+			ownBlock(uiBlocks - 1).resize(uiPosition % EXECUTION_STACK_BLOCK);
+		uiSize = uiPosition;
+	}
+
+public:
+	// iterates over the items from the top of the stack down (by their 
+	// position, so it stays valid when items are pushed on top)
+	class const_iterator {
+	private:
+		const CExecutionStack* pesStack;
+		int iPosition;
+	public:
+		typedef forward_iterator_tag iterator_category;
+		typedef TExecutionStackItem value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const TExecutionStackItem* pointer;
+		typedef const TExecutionStackItem& reference;
+
+		const_iterator(): pesStack(NULL), iPosition(-1) {}
+		const_iterator(const CExecutionStack* pesAStack, int iAPosition): 
+			pesStack(pesAStack), iPosition(iAPosition) {}
+
+		// the position of the item, from the bottom of the stack
+		int GetPosition() const { return iPosition; }
+
+		reference operator*() const { 
+			return pesStack->GetItemAt(iPosition); 
+		}
+		pointer operator->() const { return &pesStack->GetItemAt(iPosition); }
+		const_iterator& operator++() { iPosition--; return *this; }
+		const_iterator operator++(int) { 
+			const_iterator iPrevious = *this;
+			iPosition--;
+			return iPrevious;
+		}
+		bool operator==(const const_iterator& rOther) const {
+			return (pesStack == rOther.pesStack) && 
+				(iPosition == rOther.iPosition);
+		}
+		bool operator!=(const const_iterator& rOther) const {
+			return !(*this == rOther);
+		}
+	};
+	typedef const_iterator iterator;
+
+	CExecutionStack(): uiSize(0) {}
+
+	const_iterator begin() const { return const_iterator(this, (int)uiSize - 1); }
+	const_iterator end() const { return const_iterator(this, -1); }
+
+	bool empty() const { return uiSize == 0; }
+	size_t size() const { return uiSize; }
+	void clear() { 
+		vpBlocks.clear();
+		uiSize = 0;
+	}
+
+	// the item on top of the stack
+	const TExecutionStackItem& front() const { 
+		return GetItemAt(uiSize - 1); 
+	}
+
+	// pushes an item on top of the stack
+	void push_front(const TExecutionStackItem& resiItem) {
+		if(uiSize % EXECUTION_STACK_BLOCK == 0) {
+			vpBlocks.push_back(make_shared <TBlock> ());
+			vpBlocks.back()->reserve(EXECUTION_STACK_BLOCK);
+		}
+		ownBlock((unsigned int)vpBlocks.size() - 1).push_back(resiItem);
+		uiSize++;
+	}
+
+	// adds an item at the bottom of the stack (for building a stack from
+	// the top down; the whole stack is copied)
+	void push_back(const TExecutionStackItem& resiItem) {
+		vector <TExecutionStackItem> vesiItems;
+		vesiItems.reserve(uiSize + 1);
+		vesiItems.push_back(resiItem);
+		for(unsigned int i = 0; i < uiSize; i++) 
+			vesiItems.push_back(GetItemAt(i));
+		clear();
+		for(unsigned int i = 0; i < vesiItems.size(); i++)
+			push_front(vesiItems[i]);
+	}
+
+	// removes an item, and returns the one below it
+	iterator erase(iterator iPtr) {
+		unsigned int uiPosition = (unsigned int)iPtr.GetPosition();
+		vector <TExecutionStackItem> vesiAbove;
+		for(unsigned int i = uiPosition + 1; i < uiSize; i++)
+			vesiAbove.push_back(GetItemAt(i));
+		truncate(uiPosition);
+		for(unsigned int i = 0; i < vesiAbove.size(); i++)
+			push_front(vesiAbove[i]);
+		return const_iterator(this, (int)uiPosition - 1);
+	}
+
+	// access to the items by their position from the bottom of the stack 
+	// (positions do not change when items are pushed on top)
+	const TExecutionStackItem& GetItemAt(int iPosition) const {
+		return (*vpBlocks[iPosition / EXECUTION_STACK_BLOCK])
+			[iPosition % EXECUTION_STACK_BLOCK];
+	}
+
+	// returns the number of items at the bottom of the stack that are 
+	// shared with another one (held in the same blocks, so unchanged)
+	unsigned int GetSharedItems(const CExecutionStack& resStack) const {
+		unsigned int uiShared = 0;
+		for(unsigned int i = 0; (i < vpBlocks.size()) && 
+			(i < resStack.vpBlocks.size()) && 
+			(vpBlocks[i] == resStack.vpBlocks[i]); i++)
+			uiShared += (unsigned int)vpBlocks[i]->size();
+		return uiShared;
+	}
+
+	// removes the items whose positions are marked (the items below the 
+	// lowest marked one are not touched, and the ones above it are moved
+	// down), in a single pass
+	void RemoveMarked(const vector <bool>& vbMarked) {
+		unsigned int uiLowest = 0;
+		while((uiLowest < uiSize) && 
+			((uiLowest >= vbMarked.size()) || !vbMarked[uiLowest]))
+			uiLowest++;
+		if(uiLowest == uiSize) return;
+		vector <TExecutionStackItem> vesiKept;
+		for(unsigned int i = uiLowest + 1; i < uiSize; i++)
+			if((i >= vbMarked.size()) || !vbMarked[i]) 
+				vesiKept.push_back(GetItemAt(i));
+		truncate(uiLowest);
+		for(unsigned int i = 0; i < vesiKept.size(); i++)
+			push_front(vesiKept[i]);
+	}
+};
+typedef CExecutionStack TExecutionStack;
+
+// D: the positions on the execution stack of the agents planned by each 
+//    agent (by their scheduler)
+typedef unordered_map <CAgent*, vector <int> > TScheduledAgentsIndex;
 
 // D: structure holding a execution history item
 typedef struct {
@@ -318,6 +560,19 @@ typedef enum { fsUnknown,		// floor owner is unknown
 
 extern vector<string> vsFloorStatusLabels;
 
+// D: Return codes for a step of the dialog core execution loop
+typedef enum { csrcWaitForEvent,	// the core needs a new interaction event
+			   csrcDialogFinished,	// the dialog task has completed
+} TCoreStepReturnCode;
+
+// D: The position of the dialog core execution loop, kept between steps
+typedef enum { clsNotStarted,		// the dialog task was not started yet
+			   clsRunning,			// the loop is executing agents
+			   clsWaitingForEvent,	// the loop is suspended until the next
+									//  interaction event arrives
+			   clsFinished,			// the dialog task has completed
+} TCoreLoopState;
+
 class CDMCoreAgent: public CAgent {
 
 private:
@@ -329,8 +584,18 @@ private:
 	TExecutionStack esExecutionStack;		// the execution stack
 	CExecutionHistory ehExecutionHistory;	// the execution history
     TBindingHistory bhBindingHistory;       // the binding history
-	TExpectationAgenda eaAgenda;			// the expectation agenda
+	TExpectationAgendaPtr peaAgenda;		// the expectation agenda
+	TDeclaredExpectationsHash dehDeclaredExpectations;
+											// the expectations declared by
+											//  the agents on the stack
+	unsigned int uiAgendaAssemblies;		// the number of agenda assemblies
+	int iDialogStateVersion;				// incremented each time the 
+											//  dialog state changes
 	TFocusClaimsList fclFocusClaims;		// the list of focus claims
+	int iFocusClaimsIndexVersion;			// the version of the tree the
+											//  focus claims were indexed 
+											//  for (see CDialogAgent::
+											//  IndexFocusClaims)
 	TSystemAction saSystemAction;			// the current system action
 	
     int iTimeoutPeriod;						// the current timeout period
@@ -351,6 +616,7 @@ private:
 
 	TFloorStatus fsFloorStatus;             // indicates who has the floor
 	int iTurnNumber;						// stores the current turn number
+	TCoreLoopState clsLoopState;			// where the execution loop is
     TCustomStartOverFunct csoStartOverFunct;// a custom start over function
 
     //---------------------------------------------------------------------
@@ -396,10 +662,93 @@ public:
 	// Execution
 	//---------------------------------------------------------------------
 
-	// Executes the dialog task
+	// Executes the dialog task, blocking for interaction events in between
+	// steps
 	//
 	void Execute();
 
+	// Runs the execution loop until the dialog core needs a new interaction
+	// event (or the dialog finishes) and then returns. If an event is 
+	// given, it is queued and processed first
+	//
+	TCoreStepReturnCode Step(CInteractionEvent *pieEvent = NULL);
+
+	// Returns the position of the execution loop
+	//
+	TCoreLoopState GetLoopState();
+
+	// Enables or disables (for all the sessions) keeping the expectations 
+	// declared by the agents on the execution stack between agenda 
+	// assemblies; when disabled, every assembly declares them again. What
+	// is kept is the declaration itself (the walk of the subtree of the 
+	// agent, and the grammar mappings, requested concept names and trigger
+	// commands it asks for): every assembly still copies the expectations
+	// of every level into the new agenda, and re-evaluates their state 
+	// (see CDialogAgent::UpdateExpectation). A grammar mapping that depends
+	// on the dialog state is not asked for again while its agent stays 
+	// on the stack, unless NotifyExpectationsChanged is called
+	//
+	static void SetUseIncrementalAgenda(bool bAUseIncrementalAgenda);
+	static bool GetUseIncrementalAgenda();
+
+	// Signals that the expectations some agent declares have changed (e.g.
+	// its grammar mapping depends on the value of a concept, and the value
+	// changed): the next agenda assembly declares the expectations of all
+	// the agents on the execution stack again; or, when the agent is given,
+	// only the expectations of that agent
+	//
+	void NotifyExpectationsChanged();
+	void NotifyExpectationsChanged(CDialogAgent* pdaAgent);
+
+	// The dialog state version: it changes every time a concept or an 
+	// agent's completion, blocking or counters change, and at every step of
+	// the execution loop (executing an agent, grounding, a focus shift, an
+	// input pass). The agents keep their completion criteria for as long as
+	// the version stays the same (see CDialogAgent::EvaluateSuccessCriteria)
+	//
+	void NotifyDialogStateChanged();
+	int GetDialogStateVersion();
+
+	// Enables or disables (for all the sessions) caching the completion 
+	// criteria of the agents between changes of the dialog state version
+	//
+	static void SetUseCompletionCache(bool bAUseCompletionCache);
+	static bool GetUseCompletionCache();
+
+	// Enables or disables (for all the sessions) gathering the focus claims
+	// only from the subtrees in which an agent may claim the focus (see 
+	// CDialogAgent::MayClaimFocus), indexed once per version of the dialog
+	// task tree; when disabled, the whole tree is visited
+	//
+	static void SetUseFocusClaimsIndex(bool bAUseFocusClaimsIndex);
+	static bool GetUseFocusClaimsIndex();
+
+	// Indicates if the focus claims index is in use, and is the one of the
+	// current version of the dialog task tree (CDialogAgent::
+	// DeclareFocusClaims skips the subtrees it has no claimants in)
+	//
+	bool HasFocusClaimsIndex();
+
+	//---------------------------------------------------------------------
+	// Saving and restoring the state of the core (session hibernation)
+	//---------------------------------------------------------------------
+
+	// Writes the execution stack, the execution and binding histories, the
+	// current system action and the various turn and floor information to
+	// a session record. This is only possible while the execution loop 
+	// waits for an event, and while all the agents on the execution stack
+	// belong to the dialog task tree (returns false otherwise: the
+	// grounding agencies are created on the fly, and would not exist when
+	// the session gets restored)
+	//
+	bool SaveToRecord(CSessionRecord& rRecord);
+
+	// Restores the state of the core from a session record, on top of a 
+	// freshly created dialog task tree whose state was already restored. 
+	// The execution loop is left waiting for the next event
+	//
+	bool LoadFromRecord(CSessionRecord& rRecord);
+
 	//---------------------------------------------------------------------
 	// Method for performing an input pass (and related)
 	//---------------------------------------------------------------------
@@ -407,6 +756,9 @@ public:
 	// Waits for and processes the next real world event
 	void AcquireNextEvent();
 
+	// Processes the next event already in the interaction event queue
+	void ProcessNextEvent();
+
 	// Registers a customized binding filter
     //
     void RegisterBindingFilter(string sBindingFilterName, 
@@ -561,6 +913,27 @@ public:
 
 private:
 
+	//---------------------------------------------------------------------
+	// DMCoreManagerAgent private methods related to the execution loop
+	//---------------------------------------------------------------------
+
+	// Creates the dialog task tree and puts its root on the stack
+	void startExecution();
+
+	// Processes the next queued event, if there is one; otherwise marks
+	// the loop as waiting for an event and returns false
+	bool acquireQueuedEvent();
+
+	//---------------------------------------------------------------------
+	// DMCoreManagerAgent private methods for writing and reading the parts
+	// of the core state that the state manager keeps a history of
+	//---------------------------------------------------------------------
+
+	bool saveExecutionStack(CSessionRecord& rRecord, TExecutionStack& res);
+	bool loadExecutionStack(CSessionRecord& rRecord, TExecutionStack& res);
+	void saveSystemAction(CSessionRecord& rRecord, TSystemAction& rsa);
+	bool loadSystemAction(CSessionRecord& rRecord, TSystemAction& rsa);
+
 	//---------------------------------------------------------------------
 	// DMCoreManagerAgent private methods related to the execution stack
 	//---------------------------------------------------------------------
@@ -581,6 +954,23 @@ private:
     // Eliminates all grounding agents from the execution stack
 	void popGroundingAgentsFromExecutionStack(TStringVector& rvsAgentsEliminated);
 
+	// Indexes the agents on the execution stack by the agents that planned
+	// them
+	void indexScheduledAgents(TScheduledAgentsIndex& rsaiIndex);
+
+	// Marks an agent on the execution stack for elimination (by its 
+	// position), and calls its OnCompletion method
+	void markForElimination(int iPosition, vector <bool>& rvbMarked,
+                            TStringVector& rvsAgentsEliminated);
+
+	// Marks for elimination all the agents on the execution stack that a 
+	// given agent has planned for execution, recursively (the topmost one 
+	// first, at every step)
+	void markScheduledForElimination(CAgent* paScheduler,
+                                     TScheduledAgentsIndex& rsaiIndex,
+                                     vector <bool>& rvbMarked,
+                                     TStringVector& rvsAgentsEliminated);
+
 	//---------------------------------------------------------------------
 	// DMCoreManagerAgent private methods related to the input pass
 	//---------------------------------------------------------------------
@@ -610,7 +1000,7 @@ private:
     void broadcastExpectationAgenda();
 	string expectationAgendaToString();
     string expectationAgendaToBroadcastString();
-	string expectationAgendaToBroadcastString(TExpectationAgenda eaBAgenda);
+	string expectationAgendaToBroadcastString(TExpectationAgenda& eaBAgenda);
 
 	// Method for logging the bindings description
 	//
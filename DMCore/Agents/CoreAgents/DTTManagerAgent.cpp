@@ -52,6 +52,13 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  added the tree version (GetTreeVersion)
+//   [2026-10-18] (agent):  the trees of the sessions are cloned from the 
+//                           dialog tree image, into the session's dialog tree
+//                           arena; the root pointer is initialized, and 
+//                           cleared when the tree is destroyed
+//   [2026-10-18] (agent):  CreateDialogTree publishes the agent types, so 
+//                           that the sessions created later share them
 //   [2004-12-23] (antoine): modified constructor, agent factory, etc to handle
 //							  configurations
 //   [2002-10-22] (dbohus): added support for destroying and for recreating
@@ -68,6 +75,17 @@
 #include "DMCore/Agents/DialogAgents/AllDialogAgents.h"
 #include "DMCore/Core.h"
 
+#include <mutex>
+
+// the dialog tree image, shared by all the sessions in the process (and kept
+// for its lifetime), and whether it is used at all; bDialogTreeImageFailed 
+// is set if the tree turned out not to be clonable, so that the sessions do
+// not try again
+static CDialogAgent* pdaDialogTreeImage = NULL;
+static bool bUseDialogTreeImage = true;
+static bool bDialogTreeImageFailed = false;
+static mutex mDialogTreeImageMutex;
+
 //-----------------------------------------------------------------------------
 // Constructors and Destructors
 //-----------------------------------------------------------------------------
@@ -75,7 +93,8 @@
 // D: constructor
 CDTTManagerAgent::CDTTManagerAgent(string sAName, string sAConfiguration, string sAType) : 
 	CAgent(sAName, sAConfiguration, sAType) {
-	// nothing here
+	pdaDialogTaskRoot = NULL;
+	iTreeVersion = 0;
 }
 
 // D: destructor - destroys all the agents that were left in the dialog task
@@ -135,18 +154,18 @@ void CDTTManagerAgent::CreateDialogTree() {
 
 	// register all the agents for the dialog task
 	CreateDialogTaskAgentome();
-	// create the actual task tree
-	CreateDialogTaskTree();
 	
 	// register all the generic, task-independent discourse agents
 	for(unsigned int i=0; i<vdaiDAInfo.size(); i++)
 		(vdaiDAInfo[i].fRegisterAgent)();
 
-	// mount all the discourse agents that were specified to be used
-	for(unsigned int i=0; i<vdaiDAInfo.size(); i++)
-		MountAgent(pdaDialogTaskRoot, vdaiDAInfo[i].sDAType, 
-				   vdaiDAInfo[i].sDAName, vdaiDAInfo[i].sDAConfiguration, 
-				   mmAsLastChild);
+	// create the actual task tree, with the discourse agents mounted
+	createDialogTaskTree();
+
+	// all the agent types of the dialog task are known now; let the 
+	// sessions created from now on share them instead of registering
+	// copies of their own
+	AgentsRegistry.PublishAgentTypes();
 
 	Log(DTTMANAGER_STREAM, "Dialog Tree Creation Phase completed successfully.");
 }
@@ -160,6 +179,13 @@ void CDTTManagerAgent::DestroyDialogTree() {
         pdaDialogTaskRoot->OnDestruction();
         // then delete
         delete pdaDialogTaskRoot;
+        pdaDialogTaskRoot = NULL;
+        NotifyTreeChanged();
+    }
+    // if the tree was cloned into the arena (and nothing from it is left), 
+    // give the arena's memory back
+    if(dtaTreeArena.GetLiveObjects() == 0) {
+        dtaTreeArena.Reset();
     }
 	Log(DTTMANAGER_STREAM, "Dialog Tree Destruction Phase completed successfully.");
 }
@@ -168,16 +194,54 @@ void CDTTManagerAgent::DestroyDialogTree() {
 void CDTTManagerAgent::ReCreateDialogTree() {
     Log(DTTMANAGER_STREAM, "Starting Dialog Tree ReCreation Phase ...");
 
+	// create the actual task tree, with the discourse agents mounted
+	createDialogTaskTree();
+
+	Log(DTTMANAGER_STREAM, "Dialog Tree ReCreation Phase completed successfully.");
+}
+
+// D: creates the task tree and mounts the discourse agents. If there is a 
+//    dialog tree image, the tree is cloned from it instead, into the arena;
+//    otherwise, the tree built here becomes the image
+void CDTTManagerAgent::createDialogTaskTree() {
+	CDialogAgent* pdaImage = NULL;
+	{
+		lock_guard<mutex> lock(mDialogTreeImageMutex);
+		if(bUseDialogTreeImage)
+			pdaImage = pdaDialogTreeImage;
+	}
+
+	if(pdaImage) {
+		Log(DTTMANAGER_STREAM, "Cloning Dialog Task Tree from the image ...");
+		{
+			CDialogTreeArenaScope dtasScope(&dtaTreeArena);
+			pdaDialogTaskRoot = pdaImage->CloneTree();
+		}
+		pdaDialogTaskRoot->Register();
+		return;
+	}
+
 	// create the actual task tree
 	CreateDialogTaskTree();
-	
+
 	// mount all the discourse agents that were specified to be used
 	for(unsigned int i=0; i<vdaiDAInfo.size(); i++)
 		MountAgent(pdaDialogTaskRoot, vdaiDAInfo[i].sDAType, 
 				   vdaiDAInfo[i].sDAName, vdaiDAInfo[i].sDAConfiguration,
 				   mmAsLastChild);
 
-	Log(DTTMANAGER_STREAM, "Dialog Tree ReCreation Phase completed successfully.");
+	// keep a copy of the tree, as the image for the sessions that follow
+	lock_guard<mutex> lock(mDialogTreeImageMutex);
+	if(bUseDialogTreeImage && !pdaDialogTreeImage && !bDialogTreeImageFailed) {
+		pdaDialogTreeImage = pdaDialogTaskRoot->CloneTree();
+		if(pdaDialogTreeImage)
+			Log(DTTMANAGER_STREAM, "Dialog tree image created.");
+		else {
+			bDialogTreeImageFailed = true;
+			Log(DTTMANAGER_STREAM, "The dialog task tree cannot be cloned, "
+				"dialog tree image disabled.");
+		}
+	}
 }
 
 // D: returns the root of the dialog task tree
@@ -185,6 +249,28 @@ CDialogAgent* CDTTManagerAgent::GetDialogTaskTreeRoot() {
 	return pdaDialogTaskRoot;
 }
 
+// D: returns the version of the dialog task tree
+int CDTTManagerAgent::GetTreeVersion() {
+	return iTreeVersion;
+}
+
+// D: moves the dialog task tree to a new version
+void CDTTManagerAgent::NotifyTreeChanged() {
+	iTreeVersion++;
+}
+
+// D: enables or disables the dialog tree image
+void CDTTManagerAgent::SetUseDialogTreeImage(bool bAUseDialogTreeImage) {
+	lock_guard<mutex> lock(mDialogTreeImageMutex);
+	bUseDialogTreeImage = bAUseDialogTreeImage;
+}
+
+// D: indicates if the dialog tree image is used
+bool CDTTManagerAgent::GetUseDialogTreeImage() {
+	lock_guard<mutex> lock(mDialogTreeImageMutex);
+	return bUseDialogTreeImage;
+}
+
 // D: Mount a subtree somewhere in the dialog task tree
 void CDTTManagerAgent::MountAgent(CDialogAgent* pdaWhere, CDialogAgent* pdaWho, 
                                   TMountingMethod mmHow, string sDynamicAgentID) {
@@ -52,6 +52,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  added the tree version (GetTreeVersion)
+//   [2026-10-18] (agent):  added the dialog tree image and the dialog tree
+//                           arena
 //   [2004-12-23] (antoine): modified constructor, agent factory, etc to handle
 //							  configurations
 //   [2002-10-22] (dbohus): added support for destroying and for recreating
@@ -70,6 +73,7 @@
 #include "Utils/Utils.h"
 #include "DMCore/Agents/Agent.h"
 #include "DMCore/Agents/DialogAgents/DialogAgent.h"
+#include "DMCore/DialogTreeArena.h"
 
 //-----------------------------------------------------------------------------
 // CDTTManagerAgent Class - 
@@ -109,6 +113,13 @@ private:
 	//
 	CDialogAgent* pdaDialogTaskRoot;		// the dialog task root
 
+	// the arena the agents and concepts of the tree are placed in, when 
+	// the tree is cloned from the dialog tree image
+	CDialogTreeArena dtaTreeArena;
+
+	// the version of the dialog task tree (see GetTreeVersion)
+	int iTreeVersion;
+
 	// a vector containing the information about the discourse agents to be
 	// used
 	vector<TDiscourseAgentInfo, allocator<TDiscourseAgentInfo> > vdaiDAInfo;
@@ -160,10 +171,36 @@ public:
 	void CreateDialogTaskAgentome();	// registers all the dialog task 
 										//   (developer specified) agents
 
+private:
+	// creates the task part and mounts the discourse agents, or clones 
+	// both from the dialog tree image
+	void createDialogTaskTree();
+
+public:
+
 	// Returns the root of the dialog task tree
 	//
 	CDialogAgent* GetDialogTaskTreeRoot();
 
+	// Returns the version of the dialog task tree, which changes every time
+	// agents are added to the tree or deleted from it (including mounting
+	// and unmounting them), or an agent gets a new context agent. The
+	// dialog agents keep the concepts and agents they resolved from 
+	// constant paths until the version changes
+	//
+	int GetTreeVersion();
+	void NotifyTreeChanged();
+
+	// Enables or disables the dialog tree image (enabled by default). The 
+	// first session builds its tree from the dialog task specification, 
+	// and the process keeps a copy of that tree, as it is before the 
+	// dialog starts; the trees of the sessions that follow are cloned from
+	// that image (into the session's arena) instead of being built again.
+	// Trees with grounding models are always built from the specification
+	//
+	static void SetUseDialogTreeImage(bool bAUseDialogTreeImage);
+	static bool GetUseDialogTreeImage();
+
 	// Mount a subtree somewhere in the dialog task tree
 	void MountAgent(CDialogAgent* pdaWhere, CDialogAgent* pdaWho, 
 					TMountingMethod mmHow, string sDynamicAgentID = "");
@@ -53,6 +53,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the constructor initializes the configuration 
+//                           (it was left undefined until SetConfiguration)
 //   [2006-01-31] (dbohus): added support for dynamically registering grounding
 //                          model types
 //   [2004-12-23] (antoine): modified constructor, agent factory to handle
@@ -83,6 +85,11 @@ CGroundingManagerAgent::CGroundingManagerAgent(string sAName,
 
     // set the lock to false
     bLockedGroundingRequests = false; 
+
+    // no grounding until a configuration is set
+    gmcConfig.bGroundConcepts = false;
+    gmcConfig.bGroundTurns = false;
+    gmcConfig.sBeliefUpdatingModelName = "npu";
 }
 
 // D: Virtual destructor 
@@ -1,19 +1,46 @@
 #include "InteractionEventManagerAgent.h"
 #include "DMCore/Core.h"
+#include "DMCore/SessionRecord.h"
+#include <atomic>
 #include <iostream>
 #include "Utils/Utils.h"
 //#include "DMCore/Events/GalaxyInteractionEvent.h"
 using namespace std;
 
+// the capacity of the event history of new sessions
+static atomic<int> iEventHistorySize(16);
+
+// the directory the processed events are spilled to ("" = none)
+static string sEventSpillDirectory;
+
 
 
 CInteractionEventManagerAgent::CInteractionEventManagerAgent(string sAName,
                                   string sAConfiguration,
                                   string sAType):CAgent(sAName,sAConfiguration,sAType) {
- 
+  vpieEventHistory.resize(iEventHistorySize, (CInteractionEvent *)NULL);
+  iHistoryStart = 0;
+  iHistoryCount = 0;
+  pieLastEvent = NULL;
+  pieLastInput = NULL;
+  pieDetachedInput = NULL;
+  fSpillFile = NULL;
+  iEventsProcessed = 0;
 }
 
-CInteractionEventManagerAgent::~CInteractionEventManagerAgent() {}
+CInteractionEventManagerAgent::~CInteractionEventManagerAgent() {
+  // the history and the queue own their events
+  for (int i = 0; i < iHistoryCount; i++)
+    CInteractionEvent::Release(
+        vpieEventHistory[(iHistoryStart + i) % vpieEventHistory.size()]);
+  CInteractionEvent::Release(pieDetachedInput);
+  while (!qpieEventQueue.empty()) {
+    CInteractionEvent::Release(qpieEventQueue.front());
+    qpieEventQueue.pop();
+  }
+  if (fSpillFile)
+    fclose(fSpillFile);
+}
 
 CAgent* CInteractionEventManagerAgent::AgentFactory(string sAName,
                           string sAConfiguration) {
@@ -39,14 +66,22 @@ CInteractionEvent *CInteractionEventManagerAgent::GetNextEvent() {
     pieLastEvent = pieNext;
 
     if(pieNext->GetType() == IET_USER_UTT_END) {
+      // the previous input is not needed any more
+      CInteractionEvent::Release(pieDetachedInput);
+      pieDetachedInput = NULL;
       pieLastInput = pieNext;
     }
-    vpieEventHistory.push_back(pieNext);
+    addToHistory(pieNext);
+    spillEvent(pieNext);
     return pieNext;
   } else {
     return NULL;
   }
 }
+void CInteractionEventManagerAgent::QueueEvent(CInteractionEvent *pieEvent) {
+  qpieEventQueue.push(pieEvent);
+}
+
 CInteractionEvent *CInteractionEventManagerAgent::GetLastEvent() {
   return pieLastEvent;
 }
@@ -55,11 +90,11 @@ CInteractionEvent *CInteractionEventManagerAgent::GetLastInput() {
   return pieLastInput;
 }
 
-bool CInteractionEventManagerAgent::LastEventMatches(string sGrammarExpectation) {
+bool CInteractionEventManagerAgent::LastEventMatches(const string& sGrammarExpectation) {
   return pieLastEvent->Matches(sGrammarExpectation);
 }
 
-bool CInteractionEventManagerAgent::LastInputMatches(string sGrammarExpectation) {
+bool CInteractionEventManagerAgent::LastInputMatches(const string& sGrammarExpectation) {
   return pieLastInput->Matches(sGrammarExpectation);
 }
 bool CInteractionEventManagerAgent::LastEventIsComplete() {
@@ -69,7 +104,7 @@ bool CInteractionEventManagerAgent::LastEventIsComplete() {
 float CInteractionEventManagerAgent::GetLastEventConfidence() {
   return pieLastEvent->GetConfidence();
 }
-string CInteractionEventManagerAgent::GetValueForExpectation(string sGrammarExpectation) {
+string CInteractionEventManagerAgent::GetValueForExpectation(const string& sGrammarExpectation) {
   return pieLastEvent->GetValueForExpectation(sGrammarExpectation); 
 }
 
@@ -87,24 +122,60 @@ STRING2STRING &CInteractionEventManagerAgent::analysisInput(string inputString)
    //tmp.insert(map<string,string>::value_type(slot,value));
    return tmp;
 }
+CInteractionEvent *CInteractionEventManagerAgent::CreateUserInputEvent(
+  string sInput) {
+  CInteractionEvent *newinput = CInteractionEvent::Create(IET_USER_UTT_END);
+  string slot,value;
+  while (!sInput.empty()){
+   SplitOnFirst(sInput,";",slot,sInput);
+   SplitOnFirst(slot," ",slot,value);
+   cout << "slot="<<slot<<",value="<<value<<endl;
+   newinput->SetProperty(slot,value);
+  }
+  newinput->SetComplete();
+  return newinput;
+}
+
+bool CInteractionEventManagerAgent::PollForEvent() {
+  if (qpieEventQueue.empty()) {
+    shared_ptr<string> command = 
+      CDialogSession::GetCurrent()->GetMailbox()->inbound.try_pop();
+    if (command)
+      qpieEventQueue.push(CreateUserInputEvent(*command));
+  }
+  return !qpieEventQueue.empty();
+}
+
+CInteractionEvent *CInteractionEventManagerAgent::CreateTimeoutEvent() {
+  CInteractionEvent *timeout = CInteractionEvent::Create(IET_TURN_TIMEOUT);
+  timeout->SetProperty("[timeout]", "true");
+  timeout->SetComplete();
+  return timeout;
+}
+
 void CInteractionEventManagerAgent::WaitForEvent() {
   if (qpieEventQueue.empty()) {
-    CInteractionEvent *newinput = new CInteractionEvent(IET_USER_UTT_END);
-    //cout << newinput->GetType() <<endl;
     //cout<<"请输入您想说的话:"<<endl;
-    string slot,value;
     //string command;
     //getline(cin,command);
-    string command = *waitMessage(input_queue);
+    threadsafe_queue<string> &inbound = 
+      CDialogSession::GetCurrent()->GetMailbox()->inbound;
+    // the timeout period is in seconds; 0 means wait for ever
+    int timeout = pDMCore->GetTimeoutPeriod();
+    shared_ptr<string> command;
+    if (timeout > 0)
+      command = waitMessageFor(inbound, std::chrono::seconds(timeout));
+    else
+      command = waitMessage(inbound);
     //Log(INPUTMANAGER_STREAM,"wait message form input_queue success");
     //Log(INPUTMANAGER_STREAM,command);
-    while (!command.empty()){
-     SplitOnFirst(command,";",slot,command);
-     SplitOnFirst(slot," ",slot,value);
-     cout << "slot="<<slot<<",value="<<value<<endl;
-     newinput->SetProperty(slot,value);
+    if (!command) {
+      Log(INPUTMANAGER_STREAM, "No input within %d seconds, timeout.",
+        timeout);
+      qpieEventQueue.push(CreateTimeoutEvent());
+      return;
     }
-    newinput->SetComplete();
+    CInteractionEvent *newinput = CreateUserInputEvent(*command);
     /*string slot,value;*/
     //SplitOnFirst(command, " ",slot,value);
     //newinput->SetProperty(slot,value);
@@ -115,3 +186,110 @@ void CInteractionEventManagerAgent::WaitForEvent() {
     qpieEventQueue.push(newinput);
   }
 }
+
+// writes an event (or its absence) to a session record
+static void saveEvent(CSessionRecord &rRecord, CInteractionEvent *pieEvent) {
+  rRecord.WriteBool(pieEvent != NULL);
+  if (!pieEvent)
+    return;
+  rRecord.WriteString(pieEvent->GetType());
+  rRecord.WriteBool(pieEvent->IsComplete());
+  rRecord.WriteInt(pieEvent->GetPropertiesCount());
+  for (int i = 0; i < pieEvent->GetPropertiesCount(); i++) {
+    rRecord.WriteString(pieEvent->GetPropertySlot(i));
+    rRecord.WriteString(pieEvent->GetPropertyValue(i));
+  }
+}
+
+static CInteractionEvent *loadEvent(CSessionRecord &rRecord) {
+  if (!rRecord.ReadBool())
+    return NULL;
+  CInteractionEvent *pieEvent = CInteractionEvent::Create(rRecord.ReadString());
+  pieEvent->SetComplete(rRecord.ReadBool());
+  int iSize = rRecord.ReadInt();
+  for (int i = 0; rRecord.IsValid() && (i < iSize); i++) {
+    string sSlot = rRecord.ReadString();
+    pieEvent->SetProperty(sSlot, rRecord.ReadString());
+  }
+  return pieEvent;
+}
+
+void CInteractionEventManagerAgent::SaveToRecord(CSessionRecord &rRecord) {
+  rRecord.WriteString("InteractionEventManager");
+  saveEvent(rRecord, pieLastEvent);
+  rRecord.WriteBool(pieLastInput == pieLastEvent);
+  if (pieLastInput != pieLastEvent)
+    saveEvent(rRecord, pieLastInput);
+  rRecord.WriteInt(iEventsProcessed);
+}
+
+bool CInteractionEventManagerAgent::LoadFromRecord(CSessionRecord &rRecord) {
+  if (!rRecord.Expect("InteractionEventManager"))
+    return false;
+  pieLastEvent = loadEvent(rRecord);
+  if (rRecord.ReadBool())
+    pieLastInput = pieLastEvent;
+  else
+    pieLastInput = loadEvent(rRecord);
+  iEventsProcessed = rRecord.ReadInt();
+  // the history owns the events
+  if (pieLastInput && pieLastInput != pieLastEvent)
+    addToHistory(pieLastInput);
+  if (pieLastEvent)
+    addToHistory(pieLastEvent);
+  return rRecord.IsValid();
+}
+
+void CInteractionEventManagerAgent::addToHistory(CInteractionEvent *pieEvent) {
+  int iCapacity = (int)vpieEventHistory.size();
+  if (iHistoryCount == iCapacity) {
+    // the oldest event goes, unless it is the last input, which is kept 
+    // aside until the next input comes in
+    CInteractionEvent *pieOldest = vpieEventHistory[iHistoryStart];
+    iHistoryStart = (iHistoryStart + 1) % iCapacity;
+    iHistoryCount--;
+    if (pieOldest == pieLastInput)
+      pieDetachedInput = pieOldest;
+    else
+      CInteractionEvent::Release(pieOldest);
+  }
+  vpieEventHistory[(iHistoryStart + iHistoryCount) % iCapacity] = pieEvent;
+  iHistoryCount++;
+}
+
+void CInteractionEventManagerAgent::spillEvent(CInteractionEvent *pieEvent) {
+  iEventsProcessed++;
+  if (sEventSpillDirectory.empty())
+    return;
+  CDialogSession *pSession = CDialogSession::GetCurrent();
+  if (!fSpillFile && pSession) {
+    string sFileName = FormatString("%s/events_%d.log", 
+        sEventSpillDirectory.c_str(), pSession->GetSessionID());
+    // append-only: a restored session goes on where it left
+    fSpillFile = fopen(sFileName.c_str(), "a");
+    if (!fSpillFile) {
+      Warning(FormatString("Could not open event spill file %s.", 
+          sFileName.c_str()));
+      return;
+    }
+  }
+  if (!fSpillFile)
+    return;
+  fprintf(fSpillFile, "--- event %d\n%s", iEventsProcessed, 
+      pieEvent->ToString().c_str());
+  fflush(fSpillFile);
+}
+
+void CInteractionEventManagerAgent::SetEventHistorySize(
+    int iAEventHistorySize) {
+  iEventHistorySize = (iAEventHistorySize < 1) ? 1 : iAEventHistorySize;
+}
+
+int CInteractionEventManagerAgent::GetEventHistorySize() {
+  return iEventHistorySize;
+}
+
+void CInteractionEventManagerAgent::SetEventSpillDirectory(
+    string sADirectory) {
+  sEventSpillDirectory = sADirectory;
+}
@@ -7,6 +7,7 @@
 #include "Utils/Utils.h"
 #include "DMCore/Agents/Agent.h"
 #include "DMCore/message/message.h"
+#include <cstdio>
 #define IET_DIALOG_STATE_CHANGE	"dialog_state_change"
 #define IET_USER_UTT_START	"user_utterance_start"
 #define IET_USER_UTT_END	"user_utterance_end"
@@ -17,18 +18,37 @@
 #define IET_FLOOR_OWNER_CHANGES "floor_owner_changes"
 #define IET_SESSION "session"
 #define IET_GUI "gui"
+// the event synthesized when the user does not respond within the timeout
+// period; its [timeout] slot matches TIMEOUT_ELAPSED ("[turn_timeout:timeout]")
+#define IET_TURN_TIMEOUT "turn_timeout"
+
+class CSessionRecord;
 
 class CInteractionEventManagerAgent: public CAgent {
  private:
   queue <CInteractionEvent*, list<CInteractionEvent*> > qpieEventQueue;
 
+	// the most recently processed events, in a ring of fixed capacity 
+	// (iHistoryStart is the oldest one); the history owns its events, and 
+	// releases the oldest one when a new one comes in
 	vector <CInteractionEvent*> vpieEventHistory;
+	int iHistoryStart;
+	int iHistoryCount;
 
 	CInteractionEvent *pieLastEvent;
 
 	// pointer to most recently processed user input
 	CInteractionEvent *pieLastInput;
 
+	// the last user input, once it fell out of the history (it is kept 
+	// until the next one comes in)
+	CInteractionEvent *pieDetachedInput;
+
+	// the file all the processed events are appended to, and the number 
+	// of events processed so far (see SetEventSpillDirectory)
+	FILE *fSpillFile;
+	int iEventsProcessed;
+
  public:
 
 	//---------------------------------------------------------------------
@@ -66,15 +86,19 @@ class CInteractionEventManagerAgent: public CAgent {
 	// Dequeues one event from the unprocessed event queue
 	CInteractionEvent *GetNextEvent();
 
+	// Adds an event (received by whoever drives the session) to the 
+	// unprocessed event queue
+	void QueueEvent(CInteractionEvent *pieEvent);
+
 	// Returns a pointer to the last event/user input processed
 	CInteractionEvent *GetLastEvent();
 	CInteractionEvent *GetLastInput();
 
 	// Checks if the last event matches a given expectation
-	bool LastEventMatches(string sGrammarExpectation);
+	bool LastEventMatches(const string& sGrammarExpectation);
 
 	// Checks if the current input matches a given expectation
-	bool LastInputMatches(string sGrammarExpectation);
+	bool LastInputMatches(const string& sGrammarExpectation);
 
     // Checks if the current event is a complete or partial event
   bool LastEventIsComplete();
@@ -84,18 +108,56 @@ class CInteractionEventManagerAgent: public CAgent {
 
 	// Returns the string value corresponding to a given expectation from 
 	// the current input 
-	string GetValueForExpectation(string sGrammarExpectation);
+	string GetValueForExpectation(const string& sGrammarExpectation);
+
+	// Builds a complete user utterance event from an input line of the
+	// form "slot value;slot value;..."
+	static CInteractionEvent *CreateUserInputEvent(string sInput);
+
+	// Builds the event signaling that the timeout period has elapsed
+	static CInteractionEvent *CreateTimeoutEvent();
+
+	// Checks (without blocking) the inbound mailbox of the session for new
+	// input; returns true if there is an event in the queue afterwards
+	bool PollForEvent();
 
-	// Waits for an interaction event to arrive from the Interaction Manager
+	// Waits for an interaction event to arrive from the Interaction Manager;
+	// if none arrives within the core's timeout period (when there is one),
+	// queues a timeout event instead
   // 需要修改的方法
 	void WaitForEvent();
 
+	// Writes the last event and the last user input to a session record,
+	// and restores them (the rest of the event history is not kept, but 
+	// the spill file has it)
+	void SaveToRecord(CSessionRecord& rRecord);
+	bool LoadFromRecord(CSessionRecord& rRecord);
+
+	// Sets the capacity of the event history of the sessions created 
+	// afterwards (at least 1; 16 by default). The last event and the last
+	// user input are always kept, whatever the capacity
+	static void SetEventHistorySize(int iAEventHistorySize);
+	static int GetEventHistorySize();
+
+	// Sets a directory where each session appends all its processed events
+	// to a file (events_<session id>.log), for debugging; "" (the default)
+	// disables it. To be set before the sessions start
+	static void SetEventSpillDirectory(string sADirectory);
+
 	// Used by the Galaxy Bridge to signal that a new event has arrived
 //	void SignalInteractionEventArrived();
 //	需要添加的方法，根据从命令行输入字符串来解析指令
 //	待实现
   STRING2STRING &analysisInput(string inputString);
 
+ private:
+	// Adds a processed event to the history (releasing the oldest one if 
+	// the history is full)
+	void addToHistory(CInteractionEvent *pieEvent);
+
+	// Appends a processed event to the spill file, if there is one
+	void spillEvent(CInteractionEvent *pieEvent);
+
 };
 
 #endif // __INTERACTIONEVENTMANAGERAGENT_H__
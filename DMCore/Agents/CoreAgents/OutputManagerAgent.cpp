@@ -52,6 +52,13 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the unplanned implicit confirmations are only 
+//                           signaled on the states still kept in the state
+//                           history
+//   [2026-10-18] (agent):  added SaveToRecord and LoadFromRecord, for session
+//                           hibernation
+//   [2026-10-18] (agent):  prompts go to the outbound mailbox of the current
+//                           dialog session
 //   [2006-06-15] (antoine): merged with latest RavenClaw1 version
 //   [2005-01-26] (antoine): modified output so that it handles the 
 //                           ":non-listening" flag
@@ -93,6 +100,7 @@
 #include "OutputManagerAgent.h"
 #include "DMCore/Agents/Registry.h"
 #include "DMCore/Core.h"
+#include "DMCore/SessionRecord.h"
 
 #include "DMCore/Outputs/FrameOutput.h"
 
@@ -390,7 +398,8 @@ vector<COutput*> COutputManagerAgent::Output(CDialogAgent* pGeneratorAgent,
         Log(OUTPUTMANAGER_STREAM, "Processing output prompt %d from %s. (dump "\
 			"below)\n%s", iOutputCounter, pGeneratorAgent->GetName().c_str(),
 			sFirstPrompt.c_str());
-      pushMessage(output_queue,sFirstPrompt);
+      pushMessage(CDialogSession::GetCurrent()->GetMailbox()->outbound,
+        sFirstPrompt);
  //   cout << sFirstPrompt << endl;
 		// create the new output; if we are in a Galaxy configuration, 
 		// it's a CFrameOutput; if in an OAA configuration, it's a 
@@ -614,7 +623,13 @@ void COutputManagerAgent::PreliminaryNotify(int iOutputId, string sTaggedUtt) {
             // and notify that we are doing an ICT on it
             CConcept* pConcept = vopRecentOutputs[iIndex]->GetConceptByName(sConcept);
             if(pConcept) {
-				for (int j = vopRecentOutputs[iIndex]->GetDialogStateIndex();
+				// (from the state of the output on, the ones dropped from
+				// the state history aside)
+				int iFirstState = 
+					vopRecentOutputs[iIndex]->GetDialogStateIndex();
+				if(iFirstState < pStateManager->GetFirstStateIndex())
+					iFirstState = pStateManager->GetFirstStateIndex();
+				for (int j = iFirstState;
 					(j < pStateManager->GetStateHistoryLength()) &&
 					((*pStateManager)[j].fsFloorStatus != fsUser); j++) 
 					pDMCore->SignalUnplannedImplicitConfirmOnConcept(j, pConcept);
@@ -676,6 +691,20 @@ string COutputManagerAgent::GetPromptsWaitingForNotification() {
 	return sResult;
 }
 
+// D: Writes the output counter to a session record
+void COutputManagerAgent::SaveToRecord(CSessionRecord& rRecord) {
+	rRecord.WriteString("OutputManager");
+	rRecord.WriteInt(iOutputCounter);
+}
+
+// D: Restores the output counter from a session record
+bool COutputManagerAgent::LoadFromRecord(CSessionRecord& rRecord) {
+	if(!rRecord.Expect("OutputManager"))
+		return false;
+	iOutputCounter = rRecord.ReadInt();
+	return rRecord.IsValid();
+}
+
 //-----------------------------------------------------------------------------
 // A: COutputManager private (helper) methods
 //-----------------------------------------------------------------------------
@@ -52,6 +52,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  added SaveToRecord and LoadFromRecord, for session
+//                           hibernation
 //   [2006-06-15] (antoine): merged with latest RavenClaw1 version
 //   [2005-01-26] (antoine): modified output so that it handles the 
 //                           ":non-listening" flag
@@ -102,6 +104,8 @@
 #include "DMCore/Outputs/Output.h"
 #include "DMCore/message/message.h"
 
+class CSessionRecord;
+
 // A: Output Device parameters
 // if defined, device will send notifications back to output manager
 #define OD_NOTIFIES 0x1
@@ -269,6 +273,12 @@ public:
 	// Returns the list of prompts that are waiting for notifications
 	string GetPromptsWaitingForNotification();
 
+	// Writes the output counter to a session record, and restores it (the
+	// output history and the outputs waiting for notifications are not
+	// kept)
+	void SaveToRecord(CSessionRecord& rRecord);
+	bool LoadFromRecord(CSessionRecord& rRecord);
+
 private:
 
 	//---------------------------------------------------------------------
@@ -54,6 +54,24 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  UpdateState skips the items at the bottom of 
+//                           the stack that are held in the blocks shared
+//                           with the previous state
+//   [2026-10-18] (agent):  the strings of the encoded states are kept in a
+//                           pool trimmed with the history, instead of the 
+//                           process-wide symbol table; added 
+//                           GetFirstStateIndex
+//   [2026-10-18] (agent):  the dialog states share the execution stack and
+//                           the agenda with the core (a snapshot is a 
+//                           pointer copy); GetStateAsString takes the state
+//                           by reference
+//   [2026-10-18] (agent):  UpdateState encodes the previous state against 
+//                           the one before it (see TDialogStateDelta), and 
+//                           operator[] materializes the states on demand; 
+//                           added GetSystemAction and the keyframe and 
+//                           retention settings
+//   [2026-10-18] (agent):  added SaveToRecord and LoadFromRecord, for session
+//                           hibernation
 //	 [2007-06-02] (antoine): fixed GetLastState and operator[] so that they
 //							 return reference to TDialogState instead of 
 //							 copies of these objects
@@ -73,6 +91,15 @@
 #include "StateManagerAgent.h"
 #include "DMCore/Agents/Registry.h"
 #include "DMCore/Core.h"
+#include "DMCore/SessionRecord.h"
+
+#include <atomic>
+
+// D: every how many states the state history keeps a whole execution stack,
+//    and how many of the last states it keeps (0 for all), for all the 
+//    dialog sessions
+static atomic<int> iStateKeyframeInterval(32);
+static atomic<int> iStateHistoryRetention(0);
 
 //-----------------------------------------------------------------------------
 // Constructors and Destructors
@@ -83,7 +110,9 @@ CStateManagerAgent::CStateManagerAgent(string sAName,
 									   string sAConfiguration,
 									   string sAType):
 	CAgent(sAName, sAConfiguration, sAType) {
-	// nothing here	
+	iFirstState = 0;
+	bHasLastState = false;
+	iMaterializedState = -1;
 }
 
 // Virtual destructor - does nothing at this point
@@ -105,7 +134,14 @@ CAgent* CStateManagerAgent::AgentFactory(string sAName, string sAConfiguration)
 
 // D: the overwritten Reset method
 void CStateManagerAgent::Reset() {
-	vStateHistory.clear();
+	vdsdStateHistory.clear();
+	vesiStackPool.clear();
+	vsaSystemActionPool.clear();
+	vsStringPool.clear();
+	iFirstState = 0;
+	bHasLastState = false;
+	esEncodedStack.clear();
+	iMaterializedState = -1;
 }
 
 //-----------------------------------------------------------------------------
@@ -220,7 +256,7 @@ void CStateManagerAgent::UpdateState() {
 	dsDialogState.fsFloorStatus = pDMCore->fsFloorStatus;
     dsDialogState.sFocusedAgentName = pDMCore->GetAgentInFocus()->GetName();
     dsDialogState.esExecutionStack = pDMCore->esExecutionStack;
-    dsDialogState.eaAgenda = pDMCore->eaAgenda;
+    dsDialogState.peaAgenda = pDMCore->peaAgenda;
 	dsDialogState.saSystemAction = pDMCore->saSystemAction;
     dsDialogState.iTurnNumber = pDMCore->iTurnNumber;
 	dsDialogState.iEHIndex = pDMCore->esExecutionStack.front().iEHIndex;
@@ -252,20 +288,178 @@ void CStateManagerAgent::UpdateState() {
 	dsDialogState.sInputLineConfiguration = 
 	    S2SHashToString(s2sInputLineConfiguration);
 
-    // and push the state in history
-    vStateHistory.push_back(dsDialogState);
-
-	TDialogState ds = GetLastState();
+    // and push the state in history (the previous one is encoded)
+	if(bHasLastState)
+		encodeLastState();
+	dsLastState = std::move(dsDialogState);
+	bHasLastState = true;
 
     // log the finish
 	Log(STATEMANAGER_STREAM, "Dialog state update completed: %s at %d "
 		"(iEHIndex=%d):\n%s",
-		dsDialogState.sFocusedAgentName.c_str(), vStateHistory.size()-1,
-		dsDialogState.iEHIndex, GetStateAsString().c_str());
+		dsLastState.sFocusedAgentName.c_str(), GetStateHistoryLength()-1,
+		dsLastState.iEHIndex, GetStateAsString().c_str());
+}
+
+// D: tells if two system actions are the same
+static bool sameSystemAction(TSystemAction& rsaA, TSystemAction& rsaB) {
+	return (rsaA.setcpRequests == rsaB.setcpRequests) &&
+		(rsaA.setcpExplicitConfirms == rsaB.setcpExplicitConfirms) &&
+		(rsaA.setcpImplicitConfirms == rsaB.setcpImplicitConfirms) &&
+		(rsaA.setcpUnplannedImplicitConfirms == 
+			rsaB.setcpUnplannedImplicitConfirms);
+}
+
+// D: adds a string to the string pool, unless the previous state has the
+//    same one
+int CStateManagerAgent::poolString(const string& sString, int iPrevious) {
+	if((iPrevious >= 0) && (vsStringPool[iPrevious] == sString))
+		return iPrevious;
+	vsStringPool.push_back(sString);
+	return (int)vsStringPool.size() - 1;
+}
+
+// D: encodes the last state into the history, against the state before it
+void CStateManagerAgent::encodeLastState() {
+	TDialogStateDelta dsdDelta;
+	dsdDelta.fsFloorStatus = dsLastState.fsFloorStatus;
+	bool bHasPrevious = !vdsdStateHistory.empty();
+	dsdDelta.iFocusedAgentName = poolString(dsLastState.sFocusedAgentName,
+		bHasPrevious ? vdsdStateHistory.back().iFocusedAgentName : -1);
+	dsdDelta.iStateName = poolString(dsLastState.sStateName,
+		bHasPrevious ? vdsdStateHistory.back().iStateName : -1);
+	dsdDelta.iInputLineConfiguration = poolString(
+		dsLastState.sInputLineConfiguration,
+		bHasPrevious ? vdsdStateHistory.back().iInputLineConfiguration : -1);
+	dsdDelta.iTurnNumber = dsLastState.iTurnNumber;
+	dsdDelta.iEHIndex = dsLastState.iEHIndex;
+
+	// the execution stack: keep the items at the bottom that did not 
+	// change since the previous state, unless a keyframe is due
+	TExecutionStack& resStack = dsLastState.esExecutionStack;
+	int iState = iFirstState + (int)vdsdStateHistory.size();
+	int iKept = 0;
+	if(!vdsdStateHistory.empty() && (iState % iStateKeyframeInterval != 0)) {
+		// (the blocks at the bottom that the stack still shares with the 
+		// previous one are unchanged)
+		iKept = (int)resStack.GetSharedItems(esEncodedStack);
+		while((iKept < (int)esEncodedStack.size()) && 
+			(iKept < (int)resStack.size()) &&
+			(esEncodedStack.GetItemAt(iKept).pdaAgent == 
+				resStack.GetItemAt(iKept).pdaAgent) &&
+			(esEncodedStack.GetItemAt(iKept).iEHIndex == 
+				resStack.GetItemAt(iKept).iEHIndex))
+			iKept++;
+	}
+	dsdDelta.iStackKept = iKept;
+	dsdDelta.iStackPushed = (int)resStack.size() - iKept;
+	dsdDelta.iStackPoolStart = (int)vesiStackPool.size();
+	for(int i = iKept; i < (int)resStack.size(); i++)
+		vesiStackPool.push_back(resStack.GetItemAt(i));
+	esEncodedStack = resStack;
+
+	// the system action: share it with the previous state if it is the 
+	// same
+	if(!vdsdStateHistory.empty() && sameSystemAction(
+		vsaSystemActionPool[vdsdStateHistory.back().iSystemAction],
+		dsLastState.saSystemAction)) {
+		dsdDelta.iSystemAction = vdsdStateHistory.back().iSystemAction;
+	} else {
+		dsdDelta.iSystemAction = (int)vsaSystemActionPool.size();
+		vsaSystemActionPool.push_back(dsLastState.saSystemAction);
+	}
+
+	vdsdStateHistory.push_back(dsdDelta);
+	trimStateHistory();
+}
+
+// D: drops the states that fell out of the retention window; they are 
+//    dropped a keyframe interval at a time, up to a state whose stack can
+//    be rebuilt on its own
+void CStateManagerAgent::trimStateHistory() {
+	int iRetention = iStateHistoryRetention;
+	if(iRetention <= 0)
+		return;
+	// (the last state counts towards the retention window)
+	int iExcess = (int)vdsdStateHistory.size() + 1 - iRetention;
+	if(iExcess < iStateKeyframeInterval)
+		return;
+	int iCut = iExcess;
+	while((iCut > 0) && (vdsdStateHistory[iCut].iStackKept > 0))
+		iCut--;
+	if(iCut == 0)
+		return;
+
+	// drop the states, and the part of the pools only they used
+	int iStackCut = vdsdStateHistory[iCut].iStackPoolStart;
+	int iActionCut = vdsdStateHistory[iCut].iSystemAction;
+	for(unsigned int i = iCut; i < vdsdStateHistory.size(); i++)
+		if(vdsdStateHistory[i].iSystemAction < iActionCut)
+			iActionCut = vdsdStateHistory[i].iSystemAction;
+	vesiStackPool.erase(vesiStackPool.begin(), 
+		vesiStackPool.begin() + iStackCut);
+	vsaSystemActionPool.erase(vsaSystemActionPool.begin(), 
+		vsaSystemActionPool.begin() + iActionCut);
+	vdsdStateHistory.erase(vdsdStateHistory.begin(), 
+		vdsdStateHistory.begin() + iCut);
+	for(unsigned int i = 0; i < vdsdStateHistory.size(); i++) {
+		vdsdStateHistory[i].iStackPoolStart -= iStackCut;
+		vdsdStateHistory[i].iSystemAction -= iActionCut;
+	}
+
+	// the strings the states kept use move to a new pool (a string can be
+	// shared back to the first state, so the pool is not cut at a point);
+	// the ones a state shares with the state before it stay shared
+	vector<string> vsKeptStrings;
+	int iLast[3] = {-1, -1, -1};
+	int iLastKept[3] = {-1, -1, -1};
+	for(unsigned int i = 0; i < vdsdStateHistory.size(); i++) {
+		TDialogStateDelta& rdsdDelta = vdsdStateHistory[i];
+		int* piStrings[3] = {&rdsdDelta.iFocusedAgentName, 
+			&rdsdDelta.iStateName, &rdsdDelta.iInputLineConfiguration};
+		for(int s = 0; s < 3; s++) {
+			if(*piStrings[s] != iLast[s]) {
+				iLast[s] = *piStrings[s];
+				iLastKept[s] = (int)vsKeptStrings.size();
+				vsKeptStrings.push_back(std::move(vsStringPool[iLast[s]]));
+			}
+			*piStrings[s] = iLastKept[s];
+		}
+	}
+	vsStringPool.swap(vsKeptStrings);
+	iFirstState += iCut;
+	iMaterializedState = -1;
+}
+
+// D: rebuilds the execution stack of an encoded state (given by its 
+//    position in the history): walking back from the state, each state 
+//    gives the items it pushed below the ones already found, until the 
+//    bottom of the stack is reached (at the latest, on the closest state
+//    that keeps nothing from the one before)
+void CStateManagerAgent::materializeStack(int iIndex, 
+	TExecutionStack& resStack) {
+	TDialogStateDelta& rdsdState = vdsdStateHistory[iIndex];
+	vector<TExecutionStackItem> vesiItems(
+		rdsdState.iStackKept + rdsdState.iStackPushed);
+	int iFound = (int)vesiItems.size();
+	for(int i = iIndex; iFound > 0; i--) {
+		TDialogStateDelta& rdsdDelta = vdsdStateHistory[i];
+		int iEnd = rdsdDelta.iStackKept + rdsdDelta.iStackPushed;
+		if(iEnd > iFound) 
+			iEnd = iFound;
+		for(int p = rdsdDelta.iStackKept; p < iEnd; p++)
+			vesiItems[p] = vesiStackPool[rdsdDelta.iStackPoolStart + 
+				p - rdsdDelta.iStackKept];
+		if(rdsdDelta.iStackKept < iFound)
+			iFound = rdsdDelta.iStackKept;
+	}
+	resStack.clear();
+	for(unsigned int p = 0; p < vesiItems.size(); p++)
+		resStack.push_front(vesiItems[p]);
 }
 
 // A: Returns a string representing the state
-string CStateManagerAgent::GetStateAsString(TDialogState dsState) {
+string CStateManagerAgent::GetStateAsString(TDialogState& dsState) {
     string sDialogState = 
         FormatString("turn_number = %d\nnotify_prompts = %s\ndialog_state = "
             "%s\nnonu_threshold = %.4f\nstack = {\n%s\n}\nagenda = {\n%s\n}\n"
@@ -277,7 +471,7 @@ string CStateManagerAgent::GetStateAsString(TDialogState dsState) {
             Trim(pDMCore->executionStackToString(
 				dsState.esExecutionStack)).c_str(), 
             Trim(pDMCore->expectationAgendaToBroadcastString(
-				dsState.eaAgenda)).c_str(),
+				*dsState.peaAgenda)).c_str(),
 			dsState.sInputLineConfiguration.c_str()
 			);
 
@@ -286,20 +480,178 @@ string CStateManagerAgent::GetStateAsString(TDialogState dsState) {
 
 // 
 string CStateManagerAgent::GetStateAsString() {
-	return GetStateAsString(vStateHistory.back());
+	return GetStateAsString(GetLastState());
 }
 
-// D: Access to the length of the history
+// D: Access to the length of the history (the dropped states included)
 int CStateManagerAgent::GetStateHistoryLength() {
-	return vStateHistory.size();
+	return iFirstState + (int)vdsdStateHistory.size() + (bHasLastState?1:0);
+}
+
+// D: Access to the number of the first state kept in the history
+int CStateManagerAgent::GetFirstStateIndex() {
+	return iFirstState;
 }
 
 // D: Access the last state
 TDialogState &CStateManagerAgent::GetLastState() {
-    return vStateHistory.back();
+    return dsLastState;
 }
 
-// D: Indexing operator to access states 
+// D: Indexing operator to access states: the last state is kept as is, the
+//    others are materialized from the history
 TDialogState &CStateManagerAgent::operator[](unsigned int i) {
-	return vStateHistory[i];
+	int iState = (int)i;
+	if(bHasLastState && (iState == GetStateHistoryLength() - 1))
+		return dsLastState;
+	if((iState < iFirstState) || (iState >= GetStateHistoryLength())) {
+		FatalError(FormatString("Dialog state %d is not in the state "
+			"history (states %d to %d are kept).", iState, iFirstState, 
+			GetStateHistoryLength() - 1));
+		return dsLastState;
+	}
+
+	if(iMaterializedState != iState) {
+		TDialogStateDelta& rdsdDelta = 
+			vdsdStateHistory[iState - iFirstState];
+		dsMaterializedState.fsFloorStatus = rdsdDelta.fsFloorStatus;
+		dsMaterializedState.sFocusedAgentName = 
+			vsStringPool[rdsdDelta.iFocusedAgentName];
+		materializeStack(iState - iFirstState, 
+			dsMaterializedState.esExecutionStack);
+		if(!dsMaterializedState.peaAgenda || 
+			!dsMaterializedState.peaAgenda->vCompiledExpectations.empty())
+			dsMaterializedState.peaAgenda = 
+				make_shared <TExpectationAgenda> ();
+		dsMaterializedState.saSystemAction = 
+			vsaSystemActionPool[rdsdDelta.iSystemAction];
+		dsMaterializedState.sInputLineConfiguration = 
+			vsStringPool[rdsdDelta.iInputLineConfiguration];
+		dsMaterializedState.iTurnNumber = rdsdDelta.iTurnNumber;
+		dsMaterializedState.iEHIndex = rdsdDelta.iEHIndex;
+		dsMaterializedState.sStateName = 
+			vsStringPool[rdsdDelta.iStateName];
+		iMaterializedState = iState;
+	}
+	return dsMaterializedState;
+}
+
+// D: Access to the system action of a state, for changing it: a system 
+//    action shared with the neighbouring states is copied first
+TSystemAction &CStateManagerAgent::GetSystemAction(unsigned int i) {
+	int iState = (int)i;
+	if(bHasLastState && (iState == GetStateHistoryLength() - 1))
+		return dsLastState.saSystemAction;
+	if((iState < iFirstState) || (iState >= GetStateHistoryLength())) {
+		FatalError(FormatString("Dialog state %d is not in the state "
+			"history (states %d to %d are kept).", iState, iFirstState, 
+			GetStateHistoryLength() - 1));
+		return dsLastState.saSystemAction;
+	}
+
+	int iIndex = iState - iFirstState;
+	int iAction = vdsdStateHistory[iIndex].iSystemAction;
+	if(((iIndex > 0) && 
+			(vdsdStateHistory[iIndex - 1].iSystemAction == iAction)) ||
+		((iIndex + 1 < (int)vdsdStateHistory.size()) && 
+			(vdsdStateHistory[iIndex + 1].iSystemAction == iAction))) {
+		vsaSystemActionPool.push_back(vsaSystemActionPool[iAction]);
+		iAction = (int)vsaSystemActionPool.size() - 1;
+		vdsdStateHistory[iIndex].iSystemAction = iAction;
+	}
+	if(iMaterializedState == iState)
+		iMaterializedState = -1;
+	return vsaSystemActionPool[iAction];
+}
+
+// D: sets the keyframe interval of the state history
+void CStateManagerAgent::SetStateKeyframeInterval(
+	int iAStateKeyframeInterval) {
+	iStateKeyframeInterval = 
+		(iAStateKeyframeInterval < 1) ? 1 : iAStateKeyframeInterval;
+}
+
+// D: returns the keyframe interval of the state history
+int CStateManagerAgent::GetStateKeyframeInterval() {
+	return iStateKeyframeInterval;
+}
+
+// D: sets the number of states kept in the state history
+void CStateManagerAgent::SetStateHistoryRetention(
+	int iAStateHistoryRetention) {
+	iStateHistoryRetention = 
+		(iAStateHistoryRetention < 0) ? 0 : iAStateHistoryRetention;
+}
+
+// D: returns the number of states kept in the state history
+int CStateManagerAgent::GetStateHistoryRetention() {
+	return iStateHistoryRetention;
+}
+
+// D: returns the (approximate) memory held by the encoded states: the 
+//    states, the stack items, the system actions (counting a tree node
+//    per concept in their sets) and the strings
+size_t CStateManagerAgent::GetStateHistoryMemory() {
+	size_t stMemory = 
+		vdsdStateHistory.size() * sizeof(TDialogStateDelta) +
+		vesiStackPool.size() * sizeof(TExecutionStackItem) +
+		vsaSystemActionPool.size() * sizeof(TSystemAction) +
+		vsStringPool.size() * sizeof(string);
+	for(unsigned int i = 0; i < vsStringPool.size(); i++)
+		stMemory += vsStringPool[i].capacity();
+	for(unsigned int i = 0; i < vsaSystemActionPool.size(); i++) {
+		TSystemAction& rsaAction = vsaSystemActionPool[i];
+		stMemory += (rsaAction.setcpRequests.size() + 
+			rsaAction.setcpExplicitConfirms.size() +
+			rsaAction.setcpImplicitConfirms.size() +
+			rsaAction.setcpUnplannedImplicitConfirms.size()) *
+			(sizeof(CConcept*) + 4 * sizeof(void*));
+	}
+	return stMemory;
+}
+
+// D: Writes the state history to a session record
+void CStateManagerAgent::SaveToRecord(CSessionRecord& rRecord) {
+	rRecord.WriteString("StateManager");
+	rRecord.WriteInt(iFirstState);
+	rRecord.WriteInt(GetStateHistoryLength() - iFirstState);
+	for(int i = iFirstState; i < GetStateHistoryLength(); i++) {
+		TDialogState& rdsState = (*this)[i];
+		rRecord.WriteInt(rdsState.fsFloorStatus);
+		rRecord.WriteString(rdsState.sFocusedAgentName);
+		pDMCore->saveExecutionStack(rRecord, rdsState.esExecutionStack);
+		pDMCore->saveSystemAction(rRecord, rdsState.saSystemAction);
+		rRecord.WriteString(rdsState.sInputLineConfiguration);
+		rRecord.WriteInt(rdsState.iTurnNumber);
+		rRecord.WriteInt(rdsState.iEHIndex);
+		rRecord.WriteString(rdsState.sStateName);
+	}
+}
+
+// D: Restores the state history from a session record
+bool CStateManagerAgent::LoadFromRecord(CSessionRecord& rRecord) {
+	if(!rRecord.Expect("StateManager"))
+		return false;
+	Reset();
+	iFirstState = rRecord.ReadInt();
+	int iSize = rRecord.ReadInt();
+	for(int i = 0; rRecord.IsValid() && (i < iSize); i++) {
+		TDialogState dsState;
+		dsState.fsFloorStatus = (TFloorStatus)rRecord.ReadInt();
+		dsState.sFocusedAgentName = rRecord.ReadString();
+		if(!pDMCore->loadExecutionStack(rRecord, dsState.esExecutionStack) ||
+			!pDMCore->loadSystemAction(rRecord, dsState.saSystemAction))
+			return false;
+		dsState.sInputLineConfiguration = rRecord.ReadString();
+		dsState.iTurnNumber = rRecord.ReadInt();
+		dsState.iEHIndex = rRecord.ReadInt();
+		dsState.sStateName = rRecord.ReadString();
+		if(bHasLastState)
+			encodeLastState();
+		dsLastState = std::move(dsState);
+		bHasLastState = true;
+	}
+	if(bHasLastState)
+		dsLastState.peaAgenda = pDMCore->peaAgenda;
+	return rRecord.IsValid();
 }
@@ -54,6 +54,18 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the strings of the encoded states are kept in a
+//                           pool of the state manager, trimmed with the 
+//                           history (added GetFirstStateIndex)
+//   [2026-10-18] (agent):  the dialog states share the expectation agenda
+//                           (TExpectationAgendaPtr) and the execution stack
+//                           with the core
+//   [2026-10-18] (agent):  the state history is kept as deltas against the
+//                           previous state (with periodic keyframes), 
+//                           within a configurable retention window; the 
+//                           states are materialized on demand
+//   [2026-10-18] (agent):  added SaveToRecord and LoadFromRecord, for session
+//                           hibernation
 //	 [2007-06-02] (antoine): fixed GetLastState and operator[] so that they
 //							 return reference to TDialogState instead of 
 //							 copies of these objects
@@ -90,7 +102,7 @@ typedef struct {
 	TFloorStatus fsFloorStatus;			// who has the floor?
     string sFocusedAgentName;			// the name of the focused agent
 	TExecutionStack esExecutionStack;	// the execution stack
-    TExpectationAgenda eaAgenda;		// the expectation agenda
+    TExpectationAgendaPtr peaAgenda;	// the expectation agenda (shared)
 	TSystemAction saSystemAction;		// the current system action
 	string sInputLineConfiguration;		// string representation of the input
 										// line config at this state (lm, etc)
@@ -100,6 +112,31 @@ typedef struct {
 	string sStateName;					// the name of the current dialog state
 } TDialogState;
 
+// D: structure holding a state of the history, encoded against the state 
+//    before it: the execution stack keeps the items at the bottom of the 
+//    previous stack and adds the ones pushed since (in a shared pool); the
+//    system actions and the strings are kept in shared pools too (a state
+//    shares them with the state before it when they are the same). A state
+//    that keeps nothing from the previous stack is a base
+//    from which the stacks of the states after it can be rebuilt (a 
+//    keyframe is forced every so often). The expectation agendas are not 
+//    kept (only the last state has one)
+typedef struct {
+	TFloorStatus fsFloorStatus;			// who has the floor?
+	int iFocusedAgentName;				// the name of the focused agent, 
+										//  the name of the dialog state 
+	int iStateName;						//  and the input line 
+	int iInputLineConfiguration;		//  configuration, in the string pool
+	int iTurnNumber;					// the turn number
+	int iEHIndex;						// the execution history index
+	int iStackKept;						// the number of items kept from the 
+										//  bottom of the previous stack
+	int iStackPushed;					// the number of items pushed since
+	int iStackPoolStart;				// where the pushed items start in 
+										//  the stack pool
+	int iSystemAction;					// the system action, in the pool
+} TDialogStateDelta;
+
 // D: the CStateManager class definition
 class CStateManagerAgent : public CAgent {
 
@@ -107,9 +144,24 @@ public:
 	// dialog state name definitions
 	STRING2STRING s2sDialogStateNames;
 
-	// private vector containing a history of the states that the DM went 
-	// through
-	vector<TDialogState, allocator<TDialogState> > vStateHistory;
+	// the history of the states that the DM went through: the states 
+	// before the last one, encoded (the first one kept is state number 
+	// iFirstState), with the pools they share, and the last state
+	vector<TDialogStateDelta> vdsdStateHistory;
+	vector<TExecutionStackItem> vesiStackPool;
+	vector<TSystemAction> vsaSystemActionPool;
+	vector<string> vsStringPool;
+	int iFirstState;
+	TDialogState dsLastState;
+	bool bHasLastState;
+
+	// the execution stack of the last encoded state (the base for encoding
+	// the next one)
+	TExecutionStack esEncodedStack;
+
+	// the last state materialized from the history (see operator[])
+	TDialogState dsMaterializedState;
+	int iMaterializedState;
 
     // variable containing the state broadcast address
     string sStateBroadcastAddress;
@@ -156,18 +208,61 @@ public:
 	void UpdateState();
 
 	// Returns a string representing the state
-	string GetStateAsString(TDialogState dsState);
+	string GetStateAsString(TDialogState& dsState);
 	string GetStateAsString();
 
 	// Access to the length of the history
 	int GetStateHistoryLength();
 
+	// Access to the number of the first state still kept in the history 
+	// (the states before it were dropped, see SetStateHistoryRetention)
+	int GetFirstStateIndex();
+
     // Access the last state
   TDialogState &GetLastState();
 
-	// Indexing operator to access states 
+	// Indexing operator to access states. The states before the last one 
+	// are materialized from the history on demand (without their agendas);
+	// the reference stays valid until another state is accessed or the 
+	// state is updated. To change a past state's system action, use 
+	// GetSystemAction
 	TDialogState &operator[](unsigned int i);
 
+	// Access to the system action of a state, for changing it
+	TSystemAction &GetSystemAction(unsigned int i);
+
+	// Sets (for all the sessions) how often a state is kept whole rather 
+	// than as a delta (every so many states), and how many of the last 
+	// states are kept at least (0 means all of them; the older ones are 
+	// dropped, a keyframe interval at a time, and cannot be accessed)
+	static void SetStateKeyframeInterval(int iAStateKeyframeInterval);
+	static int GetStateKeyframeInterval();
+	static void SetStateHistoryRetention(int iAStateHistoryRetention);
+	static int GetStateHistoryRetention();
+
+	// Returns the (approximate) memory held by the states before the last
+	// one, in bytes
+	size_t GetStateHistoryMemory();
+
+	// Writes the state history to a session record, and restores it (the
+	// expectation agendas are not kept; the last state gets the agenda the
+	// core assembled when it was restored)
+	void SaveToRecord(CSessionRecord& rRecord);
+	bool LoadFromRecord(CSessionRecord& rRecord);
+
+private:
+	// Encodes the last state into the history, and drops the states that
+	// fall out of the retention window
+	void encodeLastState();
+	void trimStateHistory();
+
+	// Adds a string of the last state to the string pool (unless the state
+	// before it has the same one, at iPrevious), and returns its place
+	int poolString(const string& sString, int iPrevious);
+
+	// Rebuilds the execution stack of an encoded state
+	void materializeStack(int iIndex, TExecutionStack& resStack);
+
 };
 
 #endif // __STATEMANAGERAGENT_H__
@@ -200,7 +200,7 @@ CDialogAgent* CDialogAgency::NextAgentToExecute() {
 		// there should be at least an incompleted agent
 		if(i == SubAgents.size()) {
 			FatalError("All agents are completed in NextAgentToExecute for " + 
-					   sName + " agency (with left-to-right-enforced policy).");
+					   GetName() + " agency (with left-to-right-enforced policy).");
 		}
 				       
 		// unblock and remember this one
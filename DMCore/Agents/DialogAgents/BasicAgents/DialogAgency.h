@@ -53,6 +53,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the agent definition macro also defines 
+//                           Duplicate, so that the agents can be cloned
 //   [2004-12-23] (antoine): modified constructor, agent factory to handle
 //							  configurations
 //   [2004-04-21] (jsherwan): added logging to fatal errors in NextAgentToExecute()
@@ -173,6 +175,9 @@ public:
 		static CAgent* AgentFactory(string sAName, string sAConfiguration) {\
 			return new AgencyClass(sAName, sAConfiguration);\
 		}\
+		virtual CDialogAgent* Duplicate() {\
+			return new AgencyClass(*this);\
+		}\
 		OTHER_CONTENTS\
 	};\
 	
@@ -51,6 +51,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the agent definition macro also defines 
+//                           Duplicate, so that the agents can be cloned
 //   [2004-12-23] (antoine): modified constructor, agent factory to handle
 //							  configurations
 //   [2004-04-16] (dbohus):  added grounding models on dialog agents
@@ -148,6 +150,9 @@ public:
 		static CAgent* AgentFactory(string sAName, string sAConfiguration) {\
 			return new ExecuteAgentClass(sAName, sAConfiguration);\
 		}\
+		virtual CDialogAgent* Duplicate() {\
+			return new ExecuteAgentClass(*this);\
+		}\
 		OTHER_CONTENTS\
 	};\
 
@@ -51,6 +51,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the grammar mapping is compiled once, and 
+//                           DeclareExpectations adds the compiled 
+//                           expectations
 //   [2004-12-23] (antoine): modified constructor, agent factory to handle
 //							  configurations
 //   [2004-04-16] (dbohus):  added grounding models on dialog agents
@@ -119,27 +122,21 @@ TDialogExecuteReturnCode CMAExpect::Execute() {
 int CMAExpect::DeclareExpectations(TConceptExpectationList& 
 								   celExpectationList) {
 	int iExpectationsAdded = 0;
-	TConceptExpectationList celLocalExpectationList;
-	bool bExpectCondition = ExpectCondition();
 
-	// first get the expectations from the local "expected" concept
+	// first get the expectations from the local "expected" concept (the 
+	// grammar mapping is compiled again only when it changes)
     string sExpectedConceptName = ExpectedConceptName();
     string sGrammarMapping = GrammarMapping();
-    if(!sExpectedConceptName.empty() && !sGrammarMapping.empty())
-	    parseGrammarMapping(
-            C(sExpectedConceptName).GetAgentQualifiedName(), sGrammarMapping, 
-		    celLocalExpectationList);
-
-	// now go through it and add stuff to the 
-	for(unsigned int i = 0; i < celLocalExpectationList.size(); i++) {
-		// if the expect condition is not satisfied, disable this 
-		// expectation and set the appropriate reason
-		if(!bExpectCondition) {
-			celLocalExpectationList[i].bDisabled = true;
-			celLocalExpectationList[i].sReasonDisabled = "expect condition false";
-		}
-		celExpectationList.push_back(celLocalExpectationList[i]);
-		iExpectationsAdded++;
+    if(!sExpectedConceptName.empty() && !sGrammarMapping.empty()) {
+		if(!isGrammarMappingCompiled(cgmGrammarMapping, sExpectedConceptName,
+			sGrammarMapping))
+		    parseGrammarMapping(
+	            C(sExpectedConceptName).GetAgentQualifiedName(), 
+				sGrammarMapping, cgmGrammarMapping.celExpectations);
+
+		// now add them to the list
+		iExpectationsAdded += declareCompiledExpectations(cgmGrammarMapping,
+			celExpectationList, ExpectCondition());
 	}
 
 	// now add whatever needs to come from the CDialogAgent side
@@ -157,7 +154,7 @@ int CMAExpect::DeclareExpectations(TConceptExpectationList&
 #pragma warning (disable:4100)
 void CMAExpect::SetCompleted(TCompletionType ctACompletionType) {
 	Error(FormatString("Expect agent %s cannot be forced to incompleted.", 
-		sName.c_str()));
+		GetName().c_str()));
 }
 #pragma warning (default:4100)
 
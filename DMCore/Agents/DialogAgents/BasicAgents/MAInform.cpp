@@ -154,7 +154,7 @@ string CMAInform::Prompt() {
 #ifdef GALAXY
 	// by default, returns the name of the agent
 	return FormatString("{inform %s agent=%s}", sDialogAgentName.c_str(), 
-						sName.c_str());
+						GetName().c_str());
 #endif
 #ifdef OAA
 	// returns the name of the agent
@@ -51,6 +51,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the agent definition macro also defines 
+//                           Duplicate, so that the agents can be cloned
 //   [2005-10-24] (antoine): removed RequiresFloor method (the method inherited
 //							 from CDialogAgent is now valid here)
 //   [2005-10-19] (antoine): added RequiresFloor method
@@ -151,6 +153,9 @@ public:
 		static CAgent* AgentFactory(string sAName, string sAConfiguration) {\
 			return new InformAgentClass(sAName, sAConfiguration);\
 		}\
+		virtual CDialogAgent* Duplicate() {\
+			return new InformAgentClass(*this);\
+		}\
 		OTHER_CONTENTS\
 	};\
 	
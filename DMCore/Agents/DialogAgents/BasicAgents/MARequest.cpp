@@ -51,6 +51,11 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  FailureCriteriaSatisfied uses the cached success
+//                           criteria (EvaluateSuccessCriteria)
+//   [2026-10-18] (agent):  the grammar mapping is compiled once, and 
+//                           DeclareExpectations adds the compiled 
+//                           expectations
 //   [2005-10-24] (antoine): removed RequiresFloor method (the method inherited
 //							 from CDialogAgent is now valid here)
 //   [2005-10-19] (antoine): added RequiresFloor method
@@ -135,26 +140,20 @@ int CMARequest::DeclareExpectations(TConceptExpectationList&
 									celExpectationList) {
 	
 	int iExpectationsAdded = 0;
-	TConceptExpectationList celLocalExpectationList;
-	bool bExpectCondition = ExpectCondition();
 
-	// first get the expectations from the local "expected" concept
+	// first get the expectations from the local "expected" concept (the 
+	// grammar mapping is compiled again only when it changes)
     string sRequestedConceptName = RequestedConceptName();
     string sGrammarMapping = GrammarMapping();
-    if(!sRequestedConceptName.empty() && !sGrammarMapping.empty())
-	    parseGrammarMapping(sRequestedConceptName, sGrammarMapping, 
-		    celLocalExpectationList);
-
-	// now go through it and add stuff to the 
-	for(unsigned int i = 0; i < celLocalExpectationList.size(); i++) {
-		// if the expect condition is not satisfied, disable this 
-		// expectation and set the appropriate reason
-		if(!bExpectCondition) {
-			celLocalExpectationList[i].bDisabled = true;
-			celLocalExpectationList[i].sReasonDisabled = "expect condition false";
-		}
-		celExpectationList.push_back(celLocalExpectationList[i]);
-		iExpectationsAdded++;
+    if(!sRequestedConceptName.empty() && !sGrammarMapping.empty()) {
+		if(!isGrammarMappingCompiled(cgmGrammarMapping, sRequestedConceptName,
+			sGrammarMapping))
+			parseGrammarMapping(sRequestedConceptName, sGrammarMapping, 
+				cgmGrammarMapping.celExpectations);
+
+		// now add them to the list
+		iExpectationsAdded += declareCompiledExpectations(cgmGrammarMapping,
+			celExpectationList, ExpectCondition());
 	}
 
 	// now add whatever needs to come from the CDialogAgent side
@@ -195,7 +194,7 @@ bool CMARequest::SuccessCriteriaSatisfied() {
 //    of attempts has been made
 bool CMARequest::FailureCriteriaSatisfied() {
 	bool bFailed = (iTurnsInFocusCounter >= GetMaxExecuteCounter()) && 
-        !SuccessCriteriaSatisfied();
+        !EvaluateSuccessCriteria();
 
 	if (bFailed)
 		Log(DIALOGTASK_STREAM, "Agent reached max attempts (%d >= %d), failing",
@@ -213,9 +212,9 @@ string CMARequest::Prompt() {
         string sConceptName, sFoo;
         SplitOnFirst(RequestedConceptName(), ";", sConceptName, sFoo);
 	    return FormatString("{request %s agent=%s}", sConceptName.c_str(), 
-		    				sName.c_str());
+		    				GetName().c_str());
     } else
-	    return FormatString("{request generic agent=%s}", sName.c_str());
+	    return FormatString("{request generic agent=%s}", GetName().c_str());
 #endif
 #ifdef OAA
 	// by default return the name of the requested concept
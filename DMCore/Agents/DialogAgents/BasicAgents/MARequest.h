@@ -51,6 +51,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the agent definition macro also defines 
+//                           Duplicate, so that the agents can be cloned
 //   [2005-10-24] (antoine): removed RequiresFloor method (the method inherited
 //							 from CDialogAgent is now valid here)
 //   [2005-10-19] (antoine): added RequiresFloor method
@@ -159,7 +161,10 @@ public:
 	// Returns the concept mapping. This string describes how the grammar 
 	// concepts in the input map into values for the concept. The string is 
 	// used by DeclareExpectations to construct the actual grammar concept 
-	// expectations
+	// expectations. The expectations are kept while the agent (or one of 
+	// its ancestors) stays on the execution stack: a mapping that depends 
+	// on the dialog state should call CDMCoreAgent::NotifyExpectationsChanged
+	// when it changes
 	virtual string GrammarMapping();
 
 	// Returns the name of the requested concept
@@ -194,6 +199,9 @@ public:
 		static CAgent* AgentFactory(string sAName, string sAConfiguration) {\
 			return new RequestAgentClass(sAName, sAConfiguration);\
 		}\
+		virtual CDialogAgent* Duplicate() {\
+			return new RequestAgentClass(*this);\
+		}\
 		OTHER_CONTENTS\
 	};\
 
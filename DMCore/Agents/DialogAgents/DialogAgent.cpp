@@ -52,6 +52,36 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  SetContextAgent signals a change only when the 
+//                           context agent changes, and for an agent outside
+//                           the tree drops only the caches of its subtree 
+//                           (see NotifyResolutionChanged)
+//   [2026-10-18] (agent):  focus claims carry the claiming agent, and the
+//                           trigger concept is looked up once; added 
+//                           MayClaimFocus and IndexFocusClaims
+//   [2026-10-18] (agent):  HasSucceeded and HasFailed keep the success and
+//                           failure criteria for as long as the dialog 
+//                           state does not change; the changes of 
+//                           completion, blocking and counters are signaled
+//                           to the dialog core
+//   [2026-10-18] (agent):  the grammar mapping for the triggering commands
+//                           is compiled once, and declared from the 
+//                           compiled expectations
+//   [2026-10-18] (agent):  moved the checks deciding whether an expectation
+//                           is open out of parseGrammarMapping, into 
+//                           UpdateExpectation
+//   [2026-10-18] (agent):  LocalC keeps an index of the concepts it resolved
+//   [2026-10-18] (agent):  the constant concept and agent paths used by an 
+//                           agent are resolved once per version of the tree
+//   [2026-10-18] (agent):  agents register under their name symbol, and A()
+//                           looks relative paths up without building them
+//   [2026-10-18] (agent):  added Duplicate, CloneTree and OnCloned, for
+//                           creating the dialog task tree from the dialog 
+//                           tree image; CreateTriggerConcept does nothing 
+//                           if the agent already has its trigger concept
+//   [2026-10-18] (agent):  added SaveToRecord and LoadFromRecord, for session
+//                           hibernation
+//   [2026-10-18] (agent):  made the C() and A() printf buffers thread-local
 //   [2005-10-22] (antoine): Added methods RequiresFloor and 
 //							 IsConversationSynchronous to regulate turn-taking
 //                           and asynchronous agent planning/execution
@@ -96,8 +126,12 @@
 #include "DialogAgent.h"
 #include "DMCore/Core.h"
 #include "DMCore/Agents/Registry.h"
+#include "DMCore/SessionRecord.h"
+#include "DMCore/DialogTreeArena.h"
 #include "DialogTask/DialogTask.h"
 
+#include <typeinfo>
+
 // NULL dialog agent: this object is used designate invalid dialog agent
 // references
 CDialogAgent NULLDialogAgent("NULL");
@@ -130,6 +164,17 @@ CDialogAgent::CDialogAgent(string sAName, string sAConfiguration, string sAType)
     iLastExecutionIndex = -1;
     iLastBindingsIndex = -1;
 	bInheritedParentInputConfiguration = false;
+	iConceptIndexVersion = -1;
+	cgmTriggerMapping.iTreeVersion = -1;
+	cgmGrammarMapping.iTreeVersion = -1;
+	bSuccessCriteriaCached = false;
+	iSuccessCriteriaVersion = -1;
+	bFailureCriteriaCached = false;
+	iFailureCriteriaVersion = -1;
+	bFocusClaimsInSubtree = true;
+	iFocusClaimsWalkVersion = -1;
+	pTriggerConcept = NULL;
+	iTriggerConceptVersion = -1;
 }
 
 // D: Virtual destructor
@@ -164,6 +209,20 @@ CAgent* CDialogAgent::AgentFactory(string sAName, string sAConfiguration) {
 	return NULL;
 }
 
+//-----------------------------------------------------------------------------
+// Allocation
+//-----------------------------------------------------------------------------
+
+// D: allocates an agent, from the current dialog tree arena if there is one
+void* CDialogAgent::operator new(size_t stSize) {
+	return CDialogTreeArena::New(stSize);
+}
+
+// D: releases an agent allocated by the operator new above
+void CDialogAgent::operator delete(void* pObject) {
+	CDialogTreeArena::Delete(pObject);
+}
+
 //-----------------------------------------------------------------------------
 //
 // CAgent overwritten methods
@@ -174,7 +233,7 @@ CAgent* CDialogAgent::AgentFactory(string sAName, string sAConfiguration) {
 //    full path in the dialog tree, and we are registering the children
 void CDialogAgent::Register() {
 	// register this agent
-	AgentsRegistry.RegisterAgent(sName, this);
+	AgentsRegistry.RegisterAgent(GetNameSymbol(), this);
 	// and all its subagents
     for(unsigned int i=0; i < SubAgents.size(); i++)
         SubAgents[i]->Register();
@@ -216,6 +275,7 @@ void CDialogAgent::Reset() {
     iLastInputIndex = -1;
     iLastExecutionIndex = -1;
     iLastBindingsIndex = -1;
+    if(pDMCore) pDMCore->NotifyDialogStateChanged();
     // finally, call the OnInitialization
     OnInitialization();
 }
@@ -336,35 +396,32 @@ TDialogExecuteReturnCode CDialogAgent::Execute() {
 int CDialogAgent::DeclareExpectations(TConceptExpectationList& 
 									    rcelExpectationList) {
 	int iExpectationsAdded = 0;
-	bool bExpectCondition = ExpectCondition();
-
-	// if there's a trigger, construct the expectation list for that trigger
-	if(TriggeredByCommands() != "") {
-		TConceptExpectationList celTriggerExpectationList;
-
-		// construct the expectation list for the triggering commands
-        parseGrammarMapping(
-            C("_%s_trigger", sDialogAgentName.c_str()).GetAgentQualifiedName(), 
-            TriggeredByCommands(), 
-			celTriggerExpectationList);
-
-		// go through it and add stuff to the current agent expectation list
-		for(unsigned int i = 0; i < celTriggerExpectationList.size(); i++) {
-			// set the expectation to bind the trigger to true
-            celTriggerExpectationList[i].bmBindMethod = bmExplicitValue;
-			celTriggerExpectationList[i].sExplicitValue = "true";
-
-			// if the expect condition is not satisfied, disable this 
-			// trigger expectation and set the appropriate reason
-			if(!bExpectCondition) {
-				celTriggerExpectationList[i].bDisabled = true;
-				celTriggerExpectationList[i].sReasonDisabled = 
-					"expect condition false";
-			}
 
-			rcelExpectationList.push_back(celTriggerExpectationList[i]);
-			iExpectationsAdded++;
+	// if there's a trigger, add the expectations for that trigger
+	string sTriggeredByCommands = TriggeredByCommands();
+	if(sTriggeredByCommands != "") {
+		// compile the expectation list for the triggering commands, if 
+		// needed (the trigger concept only depends on the name of the agent,
+		// so there are no concept names to check)
+		if(!isGrammarMappingCompiled(cgmTriggerMapping, "", 
+			sTriggeredByCommands)) {
+	        parseGrammarMapping(
+				C("_%s_trigger", sDialogAgentName.c_str()).
+					GetAgentQualifiedName(), 
+				sTriggeredByCommands, cgmTriggerMapping.celExpectations);
+
+			// set the expectations to bind the trigger to true
+			for(unsigned int i = 0; 
+				i < cgmTriggerMapping.celExpectations.size(); i++) {
+	            cgmTriggerMapping.celExpectations[i].bmBindMethod = 
+					bmExplicitValue;
+				cgmTriggerMapping.celExpectations[i].sExplicitValue = "true";
+			}
 		}
+
+		// and add them to the current agent expectation list
+		iExpectationsAdded += declareCompiledExpectations(cgmTriggerMapping, 
+			rcelExpectationList, ExpectCondition());
 	}
 
 	// finally go through the subagents and gather their expectations
@@ -375,6 +432,72 @@ int CDialogAgent::DeclareExpectations(TConceptExpectationList&
 	return iExpectationsAdded;
 }
 
+// D: the UpdateExpectation: figures out if an expectation declared by this
+//    agent is open at this point, or disabled (and why)
+void CDialogAgent::UpdateExpectation(TConceptExpectation& rceExpectation, 
+									 bool bExpectCondition) {
+	rceExpectation.bDisabled = false;
+	rceExpectation.sReasonDisabled = "";
+
+	if(rceExpectation.sExpectationType == "") {
+		// if a simple concept mapping, then we declare it only if it's 
+		// under the main topic (disable it otherwise)
+		rceExpectation.bDisabled = 
+            !pDTTManager->IsAncestorOrEqualOf(
+                pDMCore->GetCurrentMainTopicAgent()->GetName(), GetName());
+		if(rceExpectation.bDisabled) {
+			rceExpectation.sReasonDisabled = "[] not under topic";
+		}
+	} else if(rceExpectation.sExpectationType == "!") {
+		// if a ![] concept mapping, declare it only if we are under focus
+		rceExpectation.bDisabled = !pDMCore->AgentIsInFocus(this);
+		if(rceExpectation.bDisabled) {
+			rceExpectation.sReasonDisabled = "![] not under focus";
+		}
+	} else if(!rceExpectation.sFocusAgents.empty()) {
+        // if a @(agent,agent)[] or *(agent,agent)[] concept mapping, 
+        // then declare it only if the focus is under one of those agents
+        // (@[] and *[] mappings are always declared)
+        TStringVector vsAgents = 
+            PartitionString(rceExpectation.sFocusAgents, ";");
+
+        // figure out the focused task agent
+        CDialogAgent* pdaDTSAgentInFocus = pDMCore->GetDTSAgentInFocus();
+        if(!pdaDTSAgentInFocus) 
+            FatalError("Could not find a DTS agent in focus.");
+        string sFocusedAgentName = pdaDTSAgentInFocus->GetName();
+
+        // go through the agents in the list and figure out if they contain the
+        // focus
+        rceExpectation.bDisabled = true;
+        for(unsigned int i = 0; i < vsAgents.size(); i++) {
+            if(pDTTManager->IsAncestorOrEqualOf(A(vsAgents[i]).GetName(), 
+                    sFocusedAgentName)) {
+                rceExpectation.bDisabled = false;
+                break;
+            }
+        }
+        if(rceExpectation.bDisabled) {
+            rceExpectation.sReasonDisabled = 
+                FormatString("%s(%s) not containing focus", 
+                    rceExpectation.sExpectationType.c_str(), 
+                    rceExpectation.sFocusAgents.c_str());
+        }        
+	}
+
+	// close the expectation if the agent path is blocked
+	if(IsAgentPathBlocked()) {
+		rceExpectation.bDisabled = true;
+		rceExpectation.sReasonDisabled = "agent path blocked";
+	}
+
+	// if the expect condition is not satisfied, disable the expectation
+	if(!bExpectCondition) {
+		rceExpectation.bDisabled = true;
+		rceExpectation.sReasonDisabled = "expect condition false";
+	}
+}
+
 // D: Declares the concepts that the agent subsumes
 void CDialogAgent::DeclareConcepts(
     TConceptPointersVector& rcpvConcepts, 
@@ -459,29 +582,37 @@ string CDialogAgent::DeclareBindingPolicy() {
 int CDialogAgent::DeclareFocusClaims(TFocusClaimsList& fclFocusClaims) {
 	int iClaimsAdded = 0;
 
+	// mark the walk, see IndexFocusClaims
+	iFocusClaimsWalkVersion = pDTTManager->GetTreeVersion();
+
 	// check its own claim focus condition and command trigger condition if 
 	// one exists
 	bool bDeclareFocusClaim = ClaimsFocus();
-	if(!TriggeredByCommands().empty()) {
+	CConcept* pTrigger = GetTriggerConcept();
+	if(pTrigger) {
 		bDeclareFocusClaim = bDeclareFocusClaim || 
-            C(FormatString("_%s_trigger", sDialogAgentName.c_str())).IsUpdatedAndGrounded();
+            pTrigger->IsUpdatedAndGrounded();
 	}
 
 	// declare the focus claim, in case we have one
     if(bDeclareFocusClaim) {
 		TFocusClaim fcClaim;
-		fcClaim.sAgentName = sName;
+		fcClaim.sAgentName = GetName();
+		fcClaim.pdaAgent = this;
 		fcClaim.bClaimDuringGrounding = ClaimsFocusDuringGrounding();
 		fclFocusClaims.push_back(fcClaim);
 		iClaimsAdded++;
 		// and also clear the triggering concept, if there is one
-		if(!TriggeredByCommands().empty())
-            C(FormatString("_%s_trigger", sDialogAgentName.c_str())).Clear();
+		if(pTrigger)
+            pTrigger->Clear();
 	}
 
 	// then call it for the subagents, so that they can also claim focus
-	// if needed 
+	// if needed (skipping the subtrees where none can, if they are indexed)
+	bool bUseIndex = pDMCore && pDMCore->HasFocusClaimsIndex();
 	for(unsigned int i=0; i < SubAgents.size(); i++) {
+		if(bUseIndex && !SubAgents[i]->bFocusClaimsInSubtree)
+			continue;
 		iClaimsAdded += SubAgents[i]->DeclareFocusClaims(fclFocusClaims);
 	}
 
@@ -489,6 +620,27 @@ int CDialogAgent::DeclareFocusClaims(TFocusClaimsList& fclFocusClaims) {
 	return iClaimsAdded;
 }
 
+// D: indicates if the agent may claim the focus at all: for this class, 
+//    only if it is triggered by commands
+bool CDialogAgent::MayClaimFocus() {
+	return GetTriggerConcept() != NULL;
+}
+
+// D: indexes the subtrees in which an agent may claim the focus, for the 
+//    current version of the tree
+bool CDialogAgent::IndexFocusClaims() {
+	// an agent whose DeclareFocusClaims did not run the one of this class
+	// on the last walk over this version of the tree claims the focus in 
+	// its own way, and is always visited
+	bFocusClaimsInSubtree = MayClaimFocus() || 
+		(iFocusClaimsWalkVersion != pDTTManager->GetTreeVersion());
+	for(unsigned int i=0; i < SubAgents.size(); i++) {
+		if(SubAgents[i]->IndexFocusClaims())
+			bFocusClaimsInSubtree = true;
+	}
+	return bFocusClaimsInSubtree;
+}
+
 // D: the Precondition: for this class, it does nothing (always returns
 //    true)
 bool CDialogAgent::PreconditionsSatisfied() {
@@ -514,11 +666,32 @@ string CDialogAgent::TriggeredByCommands() {
 	return "";
 }
 
+// D: returns the concept triggered by the user commands (it is looked up 
+//    the way C() would find it, once per version of the tree)
+CConcept* CDialogAgent::GetTriggerConcept() {
+	int iTreeVersion = pDTTManager->GetTreeVersion();
+	if(iTriggerConceptVersion != iTreeVersion) {
+		pTriggerConcept = NULL;
+		if(!TriggeredByCommands().empty())
+			pTriggerConcept = 
+				&C(FormatString("_%s_trigger", sDialogAgentName.c_str()));
+		iTriggerConceptVersion = iTreeVersion;
+	}
+	return pTriggerConcept;
+}
+
 // D: this method creates a triggering concept, in case one is needed (if the
 //    agent is to be triggered by a command
 void CDialogAgent::CreateTriggerConcept() {
 	// if the agent is to be triggered by a user command, 
 	if(!TriggeredByCommands().empty()) {
+        // (and does not have its trigger concept yet, as the agents cloned 
+        // from the dialog tree image do)
+        string sTriggerConceptName = 
+            FormatString("_%s_trigger", sDialogAgentName.c_str());
+        for(unsigned int i = 0; i < Concepts.size(); i++)
+            if(Concepts[i]->GetName() == sTriggerConceptName)
+                return;
         // add a trigger concept
         Concepts.push_back(new CBoolConcept(
             FormatString("_%s_trigger", sDialogAgentName.c_str()), 
@@ -548,7 +721,7 @@ bool CDialogAgent::SuccessCriteriaSatisfied() {
 //    met yet
 bool CDialogAgent::FailureCriteriaSatisfied() {
 	bool bFailed = (iExecuteCounter >= GetMaxExecuteCounter()) && 
-        !SuccessCriteriaSatisfied();
+        !EvaluateSuccessCriteria();
 
 	if (bFailed)
 		Log(DIALOGTASK_STREAM, "Agent reached max attempts (%d >= %d), failing",
@@ -591,6 +764,8 @@ void CDialogAgent::OnCompletion() {
 void CDialogAgent::ReOpen() {
     ReOpenConcepts();
     ReOpenTopic();
+    // resolve the concepts again from now on
+    ciConceptIndex.clear();
 }
 
 // D: the ReOpenConcepts method: by default, ReOpenConcepts calls ReOpen on
@@ -615,6 +790,7 @@ void CDialogAgent::ReOpenTopic() {
 	iExecuteCounter = 0;
     iReOpenCounter++;
     iTurnsInFocusCounter = 0;
+    if(pDMCore) pDMCore->NotifyDialogStateChanged();
 	// call ReOpenTopic on all the subagents
 	for(unsigned int i = 0; i < SubAgents.size(); i++)
 		SubAgents[i]->ReOpenTopic();
@@ -833,9 +1009,13 @@ CConcept& CDialogAgent::C(string sConceptPath) {
 	}
 }
 
-// D: A printf-like version of the C() function
+// D: A printf-like version of the C() function. Constant paths (the ones 
+//    without formatting) are resolved only once per version of the tree
 CConcept& CDialogAgent::C(const char *lpszConceptPath, ...) {
-	static char buffer[STRING_MAX];
+	if(!strchr(lpszConceptPath, '%'))
+		return resolvedC(lpszConceptPath);
+
+	static thread_local char buffer[STRING_MAX];
 
 	// get the arguments
 	va_list pArgs;
@@ -850,9 +1030,37 @@ CConcept& CDialogAgent::C(const char *lpszConceptPath, ...) {
 
 // D: the function returns a pointer to a local concept indicated by 
 //    sConceptName. If the concept is not found locally, we try to locate
-//    it in the parent
+//    it in the parent. Whole concepts are resolved once per version of the
+//    tree, through the agent's concept index (the parts of structures and
+//    arrays, which come and go, merged history concepts and names with 
+//    dynamic ids are resolved every time)
 CConcept& CDialogAgent::LocalC(string sConceptName) {
 
+	bool bIndexed = (pDTTManager != NULL) && 
+		(sConceptName.find_first_of(".@#") == string::npos);
+	if(bIndexed) {
+		// drop the index if the tree changed since it was built
+		int iTreeVersion = pDTTManager->GetTreeVersion();
+		if(iConceptIndexVersion != iTreeVersion) {
+			ciConceptIndex.clear();
+			iConceptIndexVersion = iTreeVersion;
+		}
+		TConceptIndex::iterator iPtr = ciConceptIndex.find(sConceptName);
+		if(iPtr != ciConceptIndex.end())
+			return *(iPtr->second);
+	}
+
+	CConcept& rConcept = lookupLocalC(sConceptName);
+	if(bIndexed && (&rConcept != &NULLConcept) && 
+		(iConceptIndexVersion == pDTTManager->GetTreeVersion()))
+		ciConceptIndex[sConceptName] = &rConcept;
+	return rConcept;
+}
+
+// D: resolves a concept name for LocalC: looks through the concepts of the
+//    agent, then asks the context agent or the parent
+CConcept& CDialogAgent::lookupLocalC(string sConceptName) {
+
 	// if the agent has a defined context agent,
 	// look for the concept there
 	CDialogAgent *pdaNextContext = NULL;
@@ -862,8 +1070,10 @@ CConcept& CDialogAgent::LocalC(string sConceptName) {
 		pdaNextContext = pdaParent;
 	}
 
-    // convert the eventual # signs with agent dynamic id
-    sConceptName = ReplaceSubString(sConceptName, "#", GetDynamicAgentID());
+	// convert the eventual # signs with agent dynamic id
+	if(sConceptName.find('#') != string::npos)
+		sConceptName = ReplaceSubString(sConceptName, "#", 
+			GetDynamicAgentID());
 
 	// Optimization code: if no concepts, then try the parent directly 
 	// (if a parent exists)
@@ -880,7 +1090,10 @@ CConcept& CDialogAgent::LocalC(string sConceptName) {
 	// split the concept into base and rest in case we deal with a complex
 	// concept (i.e. arrays or structures i.e. hotel.name)
 	string sBaseConceptName, sRest;
-	SplitOnFirst(sConceptName, ".", sBaseConceptName, sRest);
+	if(sConceptName.find('.') != string::npos)
+		SplitOnFirst(sConceptName, ".", sBaseConceptName, sRest);
+	else
+		sBaseConceptName = sConceptName;
 
 	// A: Checks if we want a merged history version of the concept
 	bool bMergeConcept = false;
@@ -970,7 +1183,7 @@ CDialogAgent& CDialogAgent::A(string sDialogAgentPath) {
 			// then it must be one of the descendants. Locate quickly using
 			// the registry
 			CDialogAgent* pdaAgent = (CDialogAgent*)
-									 AgentsRegistry[GetName() + "/" + sDialogAgentPath];
+				AgentsRegistry.FindAgent(pdDescriptor->sName, sDialogAgentPath);
 			if(pdaAgent) {
 				// if the agent was found
 				return *pdaAgent;
@@ -1008,8 +1221,7 @@ CDialogAgent& CDialogAgent::A(string sDialogAgentPath) {
 		// if not, try and find the agent locally (it has to 
 		// be one of the subagents). Locate quickly using the registry.
 		CDialogAgent* pdaAgent = (CDialogAgent*)
-							     AgentsRegistry[GetName() + "/" + 
-												sDialogAgentPath];
+			AgentsRegistry.FindAgent(pdDescriptor->sName, sDialogAgentPath);
 		if(pdaAgent) {
 			// if the agent was found
 			return *pdaAgent;
@@ -1023,9 +1235,13 @@ CDialogAgent& CDialogAgent::A(string sDialogAgentPath) {
 	} 
 }
 
-// D: A printf-like version of the A() function
+// D: A printf-like version of the A() function. Constant paths (the ones 
+//    without formatting) are resolved only once per version of the tree
 CDialogAgent& CDialogAgent::A(const char *lpszDialogAgentPath, ...) {
-	static char buffer[STRING_MAX];
+	if(!strchr(lpszDialogAgentPath, '%'))
+		return resolvedA(lpszDialogAgentPath);
+
+	static thread_local char buffer[STRING_MAX];
 
 	// get the arguments
 	va_list pArgs;
@@ -1038,6 +1254,92 @@ CDialogAgent& CDialogAgent::A(const char *lpszDialogAgentPath, ...) {
 	return A((string)buffer);
 }
 
+//-----------------------------------------------------------------------------
+// Resolved references to concepts and agents
+//-----------------------------------------------------------------------------
+// D: returns the concept a constant path points to, from the resolved 
+//    references if the path was already resolved against the current 
+//    version of the tree. Concepts inside structures and arrays (which can 
+//    come and go), merged history concepts and paths with dynamic ids are
+//    not kept, and neither is anything while there is no tree manager
+CConcept& CDialogAgent::resolvedC(const char* lpszConceptPath) {
+	const char* lpszConceptName = strrchr(lpszConceptPath, '/');
+	lpszConceptName = lpszConceptName?(lpszConceptName + 1):lpszConceptPath;
+	if(!pDTTManager || strpbrk(lpszConceptName, ".@#"))
+		return C((string)lpszConceptPath);
+
+	size_t stHash = CSymbolTable::Hash(lpszConceptPath, 
+		strlen(lpszConceptPath), CSymbolTable::HashSeed());
+	int iTreeVersion = pDTTManager->GetTreeVersion();
+	TResolvedReference* prrReference = 
+		findReference(vrrConceptReferences, lpszConceptPath, stHash);
+	if(prrReference && (prrReference->iTreeVersion == iTreeVersion))
+		return *(prrReference->pConcept);
+
+	// resolve the path
+	CConcept& rConcept = C((string)lpszConceptPath);
+	if(&rConcept == &NULLConcept)
+		return rConcept;
+	prrReference = findReference(vrrConceptReferences, lpszConceptPath, 
+		stHash);
+	if(!prrReference) {
+		TResolvedReference rrNew;
+		rrNew.sPath = lpszConceptPath;
+		rrNew.stHash = stHash;
+		vrrConceptReferences.push_back(rrNew);
+		prrReference = &vrrConceptReferences.back();
+	}
+	prrReference->iTreeVersion = iTreeVersion;
+	prrReference->pConcept = &rConcept;
+	prrReference->pdaAgent = NULL;
+	return rConcept;
+}
+
+// D: returns the agent a constant path points to, from the resolved 
+//    references if the path was already resolved against the current 
+//    version of the tree
+CDialogAgent& CDialogAgent::resolvedA(const char* lpszDialogAgentPath) {
+	if(!pDTTManager)
+		return A((string)lpszDialogAgentPath);
+
+	size_t stHash = CSymbolTable::Hash(lpszDialogAgentPath, 
+		strlen(lpszDialogAgentPath), CSymbolTable::HashSeed());
+	int iTreeVersion = pDTTManager->GetTreeVersion();
+	TResolvedReference* prrReference = 
+		findReference(vrrAgentReferences, lpszDialogAgentPath, stHash);
+	if(prrReference && (prrReference->iTreeVersion == iTreeVersion))
+		return *(prrReference->pdaAgent);
+
+	// resolve the path
+	CDialogAgent& rdaAgent = A((string)lpszDialogAgentPath);
+	if(&rdaAgent == &NULLDialogAgent)
+		return rdaAgent;
+	prrReference = findReference(vrrAgentReferences, lpszDialogAgentPath, 
+		stHash);
+	if(!prrReference) {
+		TResolvedReference rrNew;
+		rrNew.sPath = lpszDialogAgentPath;
+		rrNew.stHash = stHash;
+		vrrAgentReferences.push_back(rrNew);
+		prrReference = &vrrAgentReferences.back();
+	}
+	prrReference->iTreeVersion = iTreeVersion;
+	prrReference->pConcept = NULL;
+	prrReference->pdaAgent = &rdaAgent;
+	return rdaAgent;
+}
+
+// D: returns the reference for a path, NULL if the path was never resolved
+TResolvedReference* CDialogAgent::findReference(
+	TResolvedReferencesVector& rvrrReferences, const char* lpszPath, 
+	size_t stHash) {
+	for(unsigned int i = 0; i < rvrrReferences.size(); i++)
+		if((rvrrReferences[i].stHash == stHash) && 
+			(rvrrReferences[i].sPath == lpszPath))
+			return &rvrrReferences[i];
+	return NULL;
+}
+
 //-----------------------------------------------------------------------------
 // Adding and Deleting subagents
 //-----------------------------------------------------------------------------
@@ -1073,6 +1375,8 @@ void CDialogAgent::AddSubAgent(CDialogAgent* pdaWho, CDialogAgent* pdaWhere,
     pdaWho->SetDynamicAgent();
     // and register it
     pdaWho->Register();
+    // the tree changed
+    if(pDTTManager) pDTTManager->NotifyTreeChanged();
 }
 
 // D: deletes a subagent
@@ -1086,6 +1390,8 @@ void CDialogAgent::DeleteSubAgent(CDialogAgent* pdaWho) {
             pdaWho->OnDestruction();
             // finally, destroy it (this will also unregister it)            
 			delete pdaWho;
+            // the tree changed
+            if(pDTTManager) pDTTManager->NotifyTreeChanged();
 			return;
 		}	
 }
@@ -1110,6 +1416,10 @@ void CDialogAgent::DeleteDynamicSubAgents() {
             }
     } while(bFound);
 
+    // the tree changed (unless there was nothing to delete, but telling 
+    // that would cost more than resolving the references again)
+    if(pDTTManager) pDTTManager->NotifyTreeChanged();
+
     // now recursively call it on the remaining subagents
     for(iPtr = SubAgents.begin(); iPtr != SubAgents.end(); iPtr++)
         (*iPtr)->DeleteDynamicSubAgents();
@@ -1138,9 +1448,9 @@ CDialogAgent* CDialogAgent::GetParent() {
 void CDialogAgent::UpdateName() {
 	// analyze if we have or not a parent, and update the name
 	if(pdaParent) {
-		sName = pdaParent->GetName() + "/" + sDialogAgentName;
+		SetName(pdaParent->GetName() + "/" + sDialogAgentName);
 	} else {
-		sName = "/" + sDialogAgentName;
+		SetName("/" + sDialogAgentName);
 	}
 	
 	// and now update the children, too
@@ -1154,8 +1464,51 @@ void CDialogAgent::UpdateName() {
 //-----------------------------------------------------------------------------
 // D: set the context agent
 void CDialogAgent::SetContextAgent(CDialogAgent* pdaAContextAgent) {
+	if(pdaContextAgent == pdaAContextAgent) 
+		return;
 	// set the new context agent
 	pdaContextAgent = pdaAContextAgent;
+    // the concepts of this agent (and of its subagents) might now resolve 
+    // differently
+    NotifyResolutionChanged();
+}
+
+// D: signals that the lookups through this agent may resolve differently:
+//    the whole tree is concerned if the agent is part of it, otherwise 
+//    only the agent and its subagents are
+void CDialogAgent::NotifyResolutionChanged() {
+	if(!pDTTManager) 
+		return;
+	if(IsInDialogTaskTree()) {
+		pDTTManager->NotifyTreeChanged();
+		return;
+	}
+
+	// drop the concepts and agents resolved by the agent, and the grammar
+	// mappings it compiled against them
+	ciConceptIndex.clear();
+	iConceptIndexVersion = -1;
+	vrrConceptReferences.clear();
+	vrrAgentReferences.clear();
+	iTriggerConceptVersion = -1;
+	cgmTriggerMapping.iTreeVersion = -1;
+	cgmGrammarMapping.iTreeVersion = -1;
+	// and the expectations the core keeps for it
+	if(pDMCore) 
+		pDMCore->NotifyExpectationsChanged(this);
+
+	for(unsigned int i = 0; i < SubAgents.size(); i++)
+		SubAgents[i]->NotifyResolutionChanged();
+}
+
+// D: indicates if the agent belongs to the dialog task tree
+bool CDialogAgent::IsInDialogTaskTree() {
+	if(!pDTTManager)
+		return false;
+	CDialogAgent* pdaAgent = this;
+	while(pdaAgent->GetParent())
+		pdaAgent = pdaAgent->GetParent();
+	return pdaAgent == pDTTManager->GetDialogTaskTreeRoot();
 }
 
 // D: return the context agent
@@ -1177,7 +1530,7 @@ CDialogAgent* CDialogAgent::GetMainTopic() {
 	// if this is a main topic, return it
 	if(IsAMainTopic()) return this;
 	else if(!pdaParent) {
-		Log(DMCORE_STREAM, "%s has no parent -> MainTopic=NULL", sName.c_str());
+		Log(DMCORE_STREAM, "%s has no parent -> MainTopic=NULL", GetName().c_str());
 		// if it's not a main topic and it doesn't have a parent, return NULL
 		return NULL;
 	} else {
@@ -1203,12 +1556,14 @@ bool CDialogAgent::HasCompleted() {
 void CDialogAgent::SetCompleted(TCompletionType ctACompletionType) {
 	bCompleted = true;
     ctCompletionType = ctACompletionType;
+    if(pDMCore) pDMCore->NotifyDialogStateChanged();
 }
 
 // D: resets the agent completion status
 void CDialogAgent::ResetCompleted() {
     bCompleted = false;
     ctCompletionType = ctFailed;
+    if(pDMCore) pDMCore->NotifyDialogStateChanged();
 }
 
 // D: indicates if the agent has completed with a failure
@@ -1219,7 +1574,7 @@ bool CDialogAgent::HasFailed() {
         return true;
     
     // o/w check if the failure condition was recently matched
-    return FailureCriteriaSatisfied();
+    return EvaluateFailureCriteria();
 }
 
 // D: indicates if the agent has completed successfully
@@ -1230,7 +1585,40 @@ bool CDialogAgent::HasSucceeded() {
         return true;
 
     // o/w check if the success criterion was recently matched
-    return SuccessCriteriaSatisfied();
+    return EvaluateSuccessCriteria();
+}
+
+// D: evaluates the success criteria, unless they were already evaluated in
+//    the current dialog state. The verdict is kept only if the evaluation 
+//    itself did not change the dialog state
+bool CDialogAgent::EvaluateSuccessCriteria() {
+    if(!pDMCore || !CDMCoreAgent::GetUseCompletionCache())
+        return SuccessCriteriaSatisfied();
+    int iVersion = pDMCore->GetDialogStateVersion();
+    if(iSuccessCriteriaVersion == iVersion)
+        return bSuccessCriteriaCached;
+    bool bSatisfied = SuccessCriteriaSatisfied();
+    if(pDMCore->GetDialogStateVersion() == iVersion) {
+        bSuccessCriteriaCached = bSatisfied;
+        iSuccessCriteriaVersion = iVersion;
+    }
+    return bSatisfied;
+}
+
+// D: evaluates the failure criteria, unless they were already evaluated in
+//    the current dialog state
+bool CDialogAgent::EvaluateFailureCriteria() {
+    if(!pDMCore || !CDMCoreAgent::GetUseCompletionCache())
+        return FailureCriteriaSatisfied();
+    int iVersion = pDMCore->GetDialogStateVersion();
+    if(iFailureCriteriaVersion == iVersion)
+        return bFailureCriteriaCached;
+    bool bSatisfied = FailureCriteriaSatisfied();
+    if(pDMCore->GetDialogStateVersion() == iVersion) {
+        bFailureCriteriaCached = bSatisfied;
+        iFailureCriteriaVersion = iVersion;
+    }
+    return bSatisfied;
 }
 
 //-----------------------------------------------------------------------------
@@ -1255,6 +1643,7 @@ bool CDialogAgent::IsBlocked() {
 void CDialogAgent::Block() {
 	// set blocked to true
 	bBlocked = true;
+	if(pDMCore) pDMCore->NotifyDialogStateChanged();
 	// and call recursively for all the subagents
 	for(unsigned int i=0; i < SubAgents.size(); i++) 
 		SubAgents[i]->Block();
@@ -1264,6 +1653,7 @@ void CDialogAgent::Block() {
 void CDialogAgent::UnBlock() {
 	// set blocked to false
 	bBlocked = false;
+	if(pDMCore) pDMCore->NotifyDialogStateChanged();
 	// and call recursively for all the subagents
 	for(unsigned int i=0; i < SubAgents.size(); i++) 
 		SubAgents[i]->UnBlock();
@@ -1306,6 +1696,7 @@ string CDialogAgent::GetDynamicAgentID() {
 // D: increment the execute count
 void CDialogAgent::IncrementExecuteCounter() {
     iExecuteCounter++;
+    if(pDMCore) pDMCore->NotifyDialogStateChanged();
 }
 
 // D: obtain the value of the execute count
@@ -1332,6 +1723,7 @@ bool CDialogAgent::WasReOpened() {
 // D: increment the turns in focus counter
 void CDialogAgent::IncrementTurnsInFocusCounter() {
     iTurnsInFocusCounter++;
+    if(pDMCore) pDMCore->NotifyDialogStateChanged();
 }
 
 // D: obtain the value of the turns in focus counter
@@ -1378,6 +1770,156 @@ int CDialogAgent::GetLastBindingsIndex() {
     return iLastBindingsIndex;
 }
 
+// D: Write the execution state of the agent (and of its concepts and 
+//    subagents) to a session record
+bool CDialogAgent::SaveToRecord(CSessionRecord& rRecord) {
+    if(bDynamicAgent) {
+        Log(DIALOGTASK_STREAM, "Agent %s is dynamic and cannot be saved.",
+            GetName().c_str());
+        return false;
+    }
+    rRecord.WriteString(GetName());
+    rRecord.WriteBool(bCompleted);
+    rRecord.WriteInt(ctCompletionType);
+    rRecord.WriteBool(bBlocked);
+    rRecord.WriteInt(iExecuteCounter);
+    rRecord.WriteInt(iResetCounter);
+    rRecord.WriteInt(iReOpenCounter);
+    rRecord.WriteInt(iTurnsInFocusCounter);
+    rRecord.WriteInt(iLastInputIndex);
+    rRecord.WriteInt(iLastExecutionInputIndex);
+    rRecord.WriteInt(iLastExecutionIndex);
+    rRecord.WriteInt(iLastBindingsIndex);
+    rRecord.WriteInt((int)Concepts.size());
+    for(unsigned int i = 0; i < Concepts.size(); i++)
+        Concepts[i]->SaveToRecord(rRecord);
+    rRecord.WriteInt((int)SubAgents.size());
+    for(unsigned int i = 0; i < SubAgents.size(); i++)
+        if(!SubAgents[i]->SaveToRecord(rRecord))
+            return false;
+    return true;
+}
+
+// D: Restore the execution state of the agent (and of its concepts and 
+//    subagents) from a session record
+bool CDialogAgent::LoadFromRecord(CSessionRecord& rRecord) {
+    if(!rRecord.Expect(GetName()))
+        return false;
+    bCompleted = rRecord.ReadBool();
+    ctCompletionType = (TCompletionType)rRecord.ReadInt();
+    bBlocked = rRecord.ReadBool();
+    iExecuteCounter = rRecord.ReadInt();
+    iResetCounter = rRecord.ReadInt();
+    iReOpenCounter = rRecord.ReadInt();
+    iTurnsInFocusCounter = rRecord.ReadInt();
+    iLastInputIndex = rRecord.ReadInt();
+    iLastExecutionInputIndex = rRecord.ReadInt();
+    iLastExecutionIndex = rRecord.ReadInt();
+    iLastBindingsIndex = rRecord.ReadInt();
+    if(rRecord.ReadInt() != (int)Concepts.size()) {
+        rRecord.Invalidate();
+        return false;
+    }
+    for(unsigned int i = 0; i < Concepts.size(); i++)
+        if(!Concepts[i]->LoadFromRecord(rRecord))
+            return false;
+    if(rRecord.ReadInt() != (int)SubAgents.size()) {
+        rRecord.Invalidate();
+        return false;
+    }
+    for(unsigned int i = 0; i < SubAgents.size(); i++)
+        if(!SubAgents[i]->LoadFromRecord(rRecord))
+            return false;
+    return rRecord.IsValid();
+}
+
+// D: Returns a shallow copy of the agent; overwritten by the agent 
+//    definition macros, an agent class that does not do that cannot be 
+//    cloned
+CDialogAgent* CDialogAgent::Duplicate() {
+    return NULL;
+}
+
+// D: Returns a deep copy of the subtree rooted at this agent: the agents, 
+//    their concepts (with their current values) and their subagents. The
+//    copy is not registered, and its root has no parent
+CDialogAgent* CDialogAgent::CloneTree() {
+    CDialogAgent* pdaClone = Duplicate();
+    if(pdaClone == NULL)
+        return NULL;
+
+    // the copy shares everything the agent owns with it; take that out 
+    // before anything else, so that the copy can be safely deleted
+    pdaClone->Concepts.clear();
+    pdaClone->SubAgents.clear();
+    pdaClone->pGroundingModel = NULL;
+    pdaClone->pdaParent = NULL;
+    pdaClone->pdaContextAgent = NULL;
+    pdaClone->vrrConceptReferences.clear();
+    pdaClone->vrrAgentReferences.clear();
+    pdaClone->ciConceptIndex.clear();
+    pdaClone->cgmTriggerMapping.celExpectations.clear();
+    pdaClone->cgmTriggerMapping.iTreeVersion = -1;
+    pdaClone->cgmGrammarMapping.celExpectations.clear();
+    pdaClone->cgmGrammarMapping.iTreeVersion = -1;
+    pdaClone->iSuccessCriteriaVersion = -1;
+    pdaClone->iFailureCriteriaVersion = -1;
+    pdaClone->pTriggerConcept = NULL;
+    pdaClone->iTriggerConceptVersion = -1;
+    pdaClone->bFocusClaimsInSubtree = true;
+    pdaClone->iFocusClaimsWalkVersion = -1;
+
+    // a class derived from an agent class by hand would have been sliced; 
+    // grounding models and context agents point into the rest of the
+    // session, so agents that have them are not cloned either
+    if((typeid(*pdaClone) != typeid(*this)) || (pGroundingModel != NULL) ||
+        (pdaContextAgent != NULL)) {
+        delete pdaClone;
+        return NULL;
+    }
+
+    // clone the concepts (which, for the same reason, must not have 
+    // grounding models)
+    for(unsigned int i = 0; i < Concepts.size(); i++) {
+        TGroundingModelPointersVector gmpvModels;
+        TGroundingModelPointersSet gmpsExclude;
+        Concepts[i]->DeclareGroundingModels(gmpvModels, gmpsExclude);
+        if(!gmpvModels.empty()) {
+            delete pdaClone;
+            return NULL;
+        }
+        CConcept* pConcept = Concepts[i]->Clone(false);
+        pConcept->SetOwnerDialogAgent(pdaClone);
+        // clones do not notify changes, the concepts of the tree do
+        pConcept->EnableChangeNotification();
+        pdaClone->Concepts.push_back(pConcept);
+    }
+
+    // and the subagents
+    for(unsigned int i = 0; i < SubAgents.size(); i++) {
+        CDialogAgent* pdaSubAgent = SubAgents[i]->CloneTree();
+        if(pdaSubAgent == NULL) {
+            delete pdaClone;
+            return NULL;
+        }
+        // the name is already the qualified one, no need to update it
+        pdaSubAgent->pdaParent = pdaClone;
+        pdaClone->SubAgents.push_back(pdaSubAgent);
+    }
+
+    if(!pdaClone->OnCloned(this)) {
+        delete pdaClone;
+        return NULL;
+    }
+    return pdaClone;
+}
+
+// D: Called on a clone, with the agent it was copied from; by default 
+//    there is nothing else to copy
+bool CDialogAgent::OnCloned(CDialogAgent*) {
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 // 
 // Protected methods for parsing various declarative constructs
@@ -1422,74 +1964,32 @@ void CDialogAgent::parseGrammarMapping(string sConceptNames,
 
 		sLeftSide = Trim(sLeftSide);
 
-		// analyze if the expectation is open at this point or not
+		// analyze what kind of expectation this is
 		// (i.e. do we have [slot] or ![slot] or @[slot] or @(agent,agent)[slot])
 		if(sLeftSide[0] == '[') {
-			// if a simple concept mapping, then we declare it only if it's 
-			// under the main topic (disable it otherwise)
-			ceExpectation.bDisabled = 
-                !pDTTManager->IsAncestorOrEqualOf(
-                    pDMCore->GetCurrentMainTopicAgent()->GetName(), sName);
-			if(ceExpectation.bDisabled) {
-				ceExpectation.sReasonDisabled = "[] not under topic";
-			}
 			ceExpectation.sGrammarExpectation = sLeftSide;
             ceExpectation.sExpectationType = "";
 		} else if(sLeftSide[0] == '!') {
-			// if a ![] concept mapping, declare it only if we are under focus
-			ceExpectation.bDisabled = !pDMCore->AgentIsInFocus(this);
-			if(ceExpectation.bDisabled) {
-				ceExpectation.sReasonDisabled = "![] not under focus";
-			}
 			ceExpectation.sGrammarExpectation = 
                 sLeftSide.substr(1, sLeftSide.length()-1);
             ceExpectation.sExpectationType = "!";
 		} else if((sLeftSide[0] == '@') || (sLeftSide[0] == '*')) {
             if(sLeftSide[1] == '[') {
-			    // if a @[] or *[] concept mapping, then always declare it
-			    ceExpectation.bDisabled = false;
 			    ceExpectation.sGrammarExpectation = 
                     sLeftSide.substr(1, sLeftSide.length()-1);
             } else if(sLeftSide[1] == '(') {
-                // if a @(agent,agent)[] or *(agent,agent)[] concept mapping, 
-                // then declare it only if the focus is under one of those agents
-                // start by constructing the list of agents
+                // remember the list of agents that have to contain the focus
                 string sAgents;
                 SplitOnFirst( sLeftSide, ")", sAgents, ceExpectation.sGrammarExpectation);
-                sAgents = sAgents.substr(2, sAgents.length()-2);
-                TStringVector vsAgents = PartitionString(sAgents, ";");
-
-                // figure out the focused task agent
-                CDialogAgent* pdaDTSAgentInFocus = pDMCore->GetDTSAgentInFocus();
-                if(!pdaDTSAgentInFocus) 
-                    FatalError("Could not find a DTS agent in focus.");
-                string sFocusedAgentName = pdaDTSAgentInFocus->GetName();
-
-                // go through the agents in the list and figure out if they contain the
-                // focus
-                ceExpectation.bDisabled = true;
-                for(unsigned int i = 0; i < vsAgents.size(); i++) {
-                    if(pDTTManager->IsAncestorOrEqualOf(A(vsAgents[i]).GetName(), 
-                            sFocusedAgentName)) {
-                        ceExpectation.bDisabled = false;
-                        break;
-                    }
-                }
-                if(ceExpectation.bDisabled) {
-                    ceExpectation.sReasonDisabled = 
-                        FormatString("%c(%s) not containing focus", sLeftSide[0], 
-                            sAgents.c_str());
-                }        
+                ceExpectation.sFocusAgents = sAgents.substr(2, sAgents.length()-2);
             }
             // finally, set the expectation type
             ceExpectation.sExpectationType = FormatString("%c", sLeftSide[0]);
 		}
 
-		// close the expectation if the agent path is blocked
-		if(IsAgentPathBlocked()) {
-			ceExpectation.bDisabled = true;
-			ceExpectation.sReasonDisabled = "agent path blocked";
-		}
+		// now figure out if the expectation is open at this point or not
+		// (the expect condition is checked by the callers)
+		UpdateExpectation(ceExpectation, true);
 
 		// if we bind an explicitly specified concept value
 		if(ceExpectation.bmBindMethod == bmExplicitValue) {
@@ -1531,3 +2031,34 @@ void CDialogAgent::parseGrammarMapping(string sConceptNames,
 	}
 }
 
+// D: Checks if a compiled grammar mapping is up to date; if not, records what
+//    it will be compiled from
+bool CDialogAgent::isGrammarMappingCompiled(
+	TCompiledGrammarMapping& rcgmMapping, const string& sConceptNames, 
+	const string& sGrammarMapping) {
+	// the concept names are resolved against the tree when compiling, so a
+	// change in the tree also calls for a new compilation
+	int iTreeVersion = pDTTManager->GetTreeVersion();
+	if((rcgmMapping.iTreeVersion == iTreeVersion) && 
+		(rcgmMapping.sGrammarMapping == sGrammarMapping) &&
+		(rcgmMapping.sConceptNames == sConceptNames))
+		return true;
+
+	rcgmMapping.sConceptNames = sConceptNames;
+	rcgmMapping.sGrammarMapping = sGrammarMapping;
+	rcgmMapping.iTreeVersion = iTreeVersion;
+	rcgmMapping.celExpectations.clear();
+	return false;
+}
+
+// D: Adds the expectations of a compiled grammar mapping to a list
+int CDialogAgent::declareCompiledExpectations(
+	TCompiledGrammarMapping& rcgmMapping, 
+	TConceptExpectationList& rcelExpectationList, bool bExpectCondition) {
+	for(unsigned int i = 0; i < rcgmMapping.celExpectations.size(); i++) {
+		rcelExpectationList.push_back(rcgmMapping.celExpectations[i]);
+		UpdateExpectation(rcelExpectationList.back(), bExpectCondition);
+	}
+	return (int)rcgmMapping.celExpectations.size();
+}
+
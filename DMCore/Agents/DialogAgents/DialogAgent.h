@@ -52,6 +52,30 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  added NotifyResolutionChanged and 
+//                           IsInDialogTaskTree; SetContextAgent signals a
+//                           change only when the context agent changes
+//   [2026-10-18] (agent):  grammar mappings are compiled into expectations
+//                           once, and kept while they do not change (added
+//                           TCompiledGrammarMapping)
+//   [2026-10-18] (agent):  added UpdateExpectation, which re-evaluates the 
+//                           state of a declared expectation
+//   [2026-10-18] (agent):  focus claims carry the claiming agent; added 
+//                           MayClaimFocus and IndexFocusClaims, so that 
+//                           DeclareFocusClaims can skip the subtrees in 
+//                           which no agent may claim the focus
+//   [2026-10-18] (agent):  HasSucceeded and HasFailed keep the success and
+//                           failure criteria for as long as the dialog 
+//                           state does not change (see 
+//                           EvaluateSuccessCriteria)
+//   [2026-10-18] (agent):  LocalC keeps an index of the concepts it resolved
+//   [2026-10-18] (agent):  the constant concept and agent paths used by an 
+//                           agent are resolved once per version of the tree
+//   [2026-10-18] (agent):  added Duplicate, CloneTree and OnCloned, for
+//                           creating the dialog task tree from the dialog 
+//                           tree image; added operator new and delete
+//   [2026-10-18] (agent):  added SaveToRecord and LoadFromRecord, for session
+//                           hibernation
 //   [2005-10-22] (antoine): Added methods RequiresFloor and 
 //							 IsConversationSynchronous to regulate turn-taking
 //                           and asynchronous agent planning/execution
@@ -101,6 +125,8 @@
 #include "DMCore/Concepts/AllConcepts.h"
 #include "DMCore/Grounding/Grounding.h"
 
+#include <unordered_map>
+
 //-----------------------------------------------------------------------------
 // CDialogAgent Class - 
 //   This is the base of the dialog agent classes. It implements the basic 
@@ -166,15 +192,30 @@ typedef struct {
 									//  disabled
     string sExpectationType;        // indicates the type of this expectation
                                     //  (i.e. ! or @ or * ... )
+    string sFocusAgents;            // for @(agent;agent) and *(agent;agent)
+                                    //  expectations, the agents that must 
+                                    //  contain the focus
 } TConceptExpectation;
 
 // D: definition of concept expectation collection
 typedef vector<TConceptExpectation, allocator <TConceptExpectation> >
     TConceptExpectationList;
 
+// D: structure holding a grammar mapping compiled into the expectations it
+//    declares, together with what it was compiled from: the concept names,
+//    the grammar mapping and the version of the dialog task tree
+typedef struct {
+	string sConceptNames;			// the concept names, as given
+	string sGrammarMapping;			// the grammar mapping, as written
+	int iTreeVersion;				// the version of the tree
+	TConceptExpectationList celExpectations;
+									// the compiled expectations
+} TCompiledGrammarMapping;
+
 // D: structure describing a focus claim
 typedef struct {
 	string sAgentName;				// the name of the agent that claims focus
+	CDialogAgent* pdaAgent;			// the agent that claims focus
 	bool bClaimDuringGrounding;     // indicates whether or not the focus is
 	                                //  claimed during grounding
 } TFocusClaim;
@@ -194,6 +235,25 @@ typedef enum {
 class CDialogAgent;
 typedef vector <CDialogAgent*, allocator <CDialogAgent*> > TAgentsVector;
 
+// D: structure describing a concept or agent reference that an agent 
+//    resolved from a constant path (see C() and A()), and the version of the
+//    dialog task tree it was resolved against
+typedef struct {
+	string sPath;					// the path, as written
+	size_t stHash;					// the hash of the path
+	int iTreeVersion;				// the version of the tree 
+	CConcept* pConcept;				// the concept (for concept references)
+	CDialogAgent* pdaAgent;			// the agent (for agent references)
+} TResolvedReference;
+
+// D: definition of vector type for resolved references
+typedef vector <TResolvedReference, allocator <TResolvedReference> > 
+	TResolvedReferencesVector;
+
+// D: definition of the hash type for the index of the concepts an agent 
+//    resolved by name (see LocalC)
+typedef unordered_map <string, CConcept*> TConceptIndex;
+
 // D: definition for completion types
 typedef enum { ctSuccess,           // successful completion
                ctFailed,            // completion by failure
@@ -272,6 +332,12 @@ protected:
     // trigger the agent
     string sTriggerCommandsGroundingModelSpec;
 
+    // the grammar mapping for the commands that trigger the agent, and the 
+    // one for the concept the agent requests or expects (see MARequest and
+    // MAExpect), compiled into expectations
+    TCompiledGrammarMapping cgmTriggerMapping;
+    TCompiledGrammarMapping cgmGrammarMapping;
+
     // indicates how many times the agent was attempted since the last 
     // reset/reopen
 	int iExecuteCounter;
@@ -305,6 +371,35 @@ protected:
 	// J: indicates whether parent's input line configuration has been inherited
 	bool bInheritedParentInputConfiguration;
 
+	// the concept and agent references resolved from the constant paths 
+	// used by the agent (in its conditions, etc.)
+	TResolvedReferencesVector vrrConceptReferences;
+	TResolvedReferencesVector vrrAgentReferences;
+
+	// the index of the concepts LocalC resolved for this agent (its own 
+	// concepts and the ones it inherits from its context or parents), 
+	// and the version of the tree it is valid for
+	TConceptIndex ciConceptIndex;
+	int iConceptIndexVersion;
+
+	// the last verdicts of the success and failure criteria, and the 
+	// dialog state versions they are valid for
+	bool bSuccessCriteriaCached;
+	int iSuccessCriteriaVersion;
+	bool bFailureCriteriaCached;
+	int iFailureCriteriaVersion;
+
+	// whether an agent in the subtree (this one included) may claim the
+	// focus, see IndexFocusClaims; and the version of the tree in which 
+	// DeclareFocusClaims of this class last ran for the agent
+	bool bFocusClaimsInSubtree;
+	int iFocusClaimsWalkVersion;
+
+	// the concept triggered by the user commands (if the agent has any), 
+	// and the version of the tree it was looked up in
+	CConcept* pTriggerConcept;
+	int iTriggerConceptVersion;
+
 public:
 	
 	//---------------------------------------------------------------------
@@ -322,6 +417,11 @@ public:
 	// Static function for dynamic agent creation
 	static CAgent* AgentFactory(string sAName, string sAConfiguration);
 
+	// Allocation: the agents of a dialog tree cloned from the dialog tree
+	// image are placed in the session's arena (see DialogTreeArena.h)
+	static void* operator new(size_t stSize);
+	static void operator delete(void* pObject);
+
 
 public:
 
@@ -369,6 +469,17 @@ public:
 	virtual int DeclareExpectations(TConceptExpectationList& 
 								    rcelExpectationList); 
 
+	// Virtual function for re-evaluating the state (open or disabled, and 
+	// why) of an expectation this agent declared earlier, against the 
+	// current state of the dialog. The core caches the declared 
+	// expectations while the agent stays on the execution stack, so 
+	// derived classes that overwrite DeclareExpectations with 
+	// state-dependent logic should overwrite this one too, or call 
+	// CDMCoreAgent::NotifyExpectationsChanged when what they declare 
+	// changes
+	virtual void UpdateExpectation(TConceptExpectation& rceExpectation, 
+								   bool bExpectCondition);
+
     // Virtual function for declaring the list of concepts that the agent
     // subsumes
     virtual void DeclareConcepts(
@@ -398,9 +509,25 @@ public:
 
 	// Virtual functions for declaring a claim for focus made by the
 	// dialog agent. For this class, it merely collects the focus claims
-	// of the subagents. To be overwritten by derived classes
+	// of the subagents (skipping the subtrees in which no agent may claim
+	// the focus, once they are indexed, see IndexFocusClaims). To be 
+	// overwritten by derived classes
 	virtual int DeclareFocusClaims(TFocusClaimsList& fclFocusClaims);
 
+	// Virtual function indicating if the agent may claim the focus at all:
+	// for this class, only if it is triggered by commands. TRIGGERED_BY 
+	// overwrites it to return true; derived classes that claim the focus 
+	// in other ways should overwrite it as well
+	virtual bool MayClaimFocus();
+
+	// Indexes, for the current version of the tree, the subtrees in which
+	// an agent may claim the focus (see MayClaimFocus), so that 
+	// DeclareFocusClaims skips the others while the core uses the index. 
+	// An agent whose DeclareFocusClaims did not run the one of this class
+	// on the last walk over the tree is always visited. Returns true if 
+	// an agent in the subtree may claim the focus
+	bool IndexFocusClaims();
+
 	// Virtual function implementing the precondition for execution
 	// of that agent. For this class, it does nothing (always returns
 	// true); is to be overwritten by derived agents
@@ -419,6 +546,10 @@ public:
 	// grammar concept(s) corresponding to that user command
 	virtual string TriggeredByCommands();
 
+	// Returns the concept triggered by the user commands, or NULL if the
+	// agent is not triggered by commands
+	CConcept* GetTriggerConcept();
+
 	// Creates a triggering concept for this agent in case one is needed 
 	// (gets called during Initialize)
 	void CreateTriggerConcept();
@@ -433,6 +564,12 @@ public:
     // number of attempts has been exceeded
 	virtual bool FailureCriteriaSatisfied();
 
+    // Evaluate the success and failure criteria, reusing the last verdict
+    // if the dialog state has not changed since (see 
+    // CDMCoreAgent::NotifyDialogStateChanged)
+    bool EvaluateSuccessCriteria();
+    bool EvaluateFailureCriteria();
+
     // Virtual function indicating how many times the execution of the agent
     // should be attempted
     virtual int GetMaxExecuteCounter();
@@ -535,6 +672,27 @@ public:
 	CDialogAgent& A(string sDialogAgentPath);
 	CDialogAgent& A(const char* lpszDialogAgentPath, ...);
 
+	// (the printf-like versions of C() and A() are the ones the condition
+	// macros expand to: a path without any formatting in it is resolved 
+	// once, and then found among the agent's resolved references, until 
+	// the dialog task tree changes; see CDTTManagerAgent::GetTreeVersion)
+
+private:
+	// Find a constant path among the resolved references, resolving it if
+	// needed
+	//
+	CConcept& resolvedC(const char* lpszConceptPath);
+	CDialogAgent& resolvedA(const char* lpszDialogAgentPath);
+	TResolvedReference* findReference(
+		TResolvedReferencesVector& rvrrReferences, const char* lpszPath, 
+		size_t stHash);
+
+	// Resolves a concept name for LocalC, without the index
+	//
+	CConcept& lookupLocalC(string sConceptName);
+
+public:
+
 	// Methods for adding and deleting subagents
 	//
 	void AddSubAgent(CDialogAgent* pdaWho, CDialogAgent* pdaWhere, 
@@ -553,6 +711,21 @@ public:
 	void SetContextAgent(CDialogAgent* pdaAContextAgent);
 	CDialogAgent* GetContextAgent();
 
+	// Signals that the concepts and agents looked up through this agent 
+	// (or its subagents) may now resolve differently, e.g. its context 
+	// agent changed. For an agent of the dialog task tree, the tree 
+	// version changes (see CDTTManagerAgent::NotifyTreeChanged); for an 
+	// agent outside of it (a grounding agency, which no tree agent looks
+	// anything up through), only what its own subtree resolved and 
+	// compiled is dropped
+	//
+	void NotifyResolutionChanged();
+
+	// Indicates if the agent belongs to the dialog task tree (its chain 
+	// of parents leads to the root of the tree)
+	//
+	bool IsInDialogTaskTree();
+
 	// Method for obtaining the main topic for this agent
     //
 	CDialogAgent* GetMainTopic();
@@ -613,6 +786,29 @@ public:
     void SetLastBindingsIndex(int iBindingsIndex);
     int GetLastBindingsIndex();
 
+    // Saving and restoring the execution state (completion and blocking 
+    // status, counters and indices) of the agent, of its concepts and of
+    // its subagents, used when dialog sessions are hibernated. Saving 
+    // fails (returns false) if the subtree contains dynamically mounted
+    // agents, since those cannot be recreated from the dialog task 
+    // specification; loading fails if the record does not match the tree
+    virtual bool SaveToRecord(CSessionRecord& rRecord);
+    virtual bool LoadFromRecord(CSessionRecord& rRecord);
+
+    // Cloning the subtree rooted at the agent, used to create the dialog
+    // task tree of a session from the dialog tree image (see 
+    // CDTTManagerAgent). Duplicate returns a shallow copy of the agent, 
+    // sharing the concepts, subagents and grounding model with it; the 
+    // agent definition macros overwrite it for every agent class, the
+    // default returns NULL (the agent cannot be cloned). CloneTree returns
+    // an unregistered deep copy of the subtree, or NULL if some agent in 
+    // it cannot be cloned. OnCloned is called on every clone with the 
+    // agent it was copied from, to copy whatever else the agent owns; it
+    // returns false if that failed
+    virtual CDialogAgent* Duplicate();
+    CDialogAgent* CloneTree();
+    virtual bool OnCloned(CDialogAgent* pdaPrototype);
+
 	// J: Access to s2sInputLineConfiguration
 	// TODO: Merge this code with the same-named functions in Agent.[cpp|h]
 	// Begin copy
@@ -645,6 +841,18 @@ protected:
 	// Parse a grammar mapping specification into an expectation list
 	void parseGrammarMapping(string sConceptNames, string sGrammarMapping, 
 							 TConceptExpectationList& rcelExpectationList);
+
+	// Checks if a compiled grammar mapping was compiled from the given 
+	// concept names and grammar mapping, on the current version of the 
+	// tree; if not, records them and returns false, and the caller should
+	// compile the expectations again
+	bool isGrammarMappingCompiled(TCompiledGrammarMapping& rcgmMapping, 
+		const string& sConceptNames, const string& sGrammarMapping);
+
+	// Adds the expectations of a compiled grammar mapping to an expectation
+	// list, updating their state (see UpdateExpectation)
+	int declareCompiledExpectations(TCompiledGrammarMapping& rcgmMapping, 
+		TConceptExpectationList& rcelExpectationList, bool bExpectCondition);
 };
 
 // NULL dialog agent: this object is used designate invalid dialog agent
@@ -759,6 +967,9 @@ extern CDialogAgent NULLDialogAgent;
 	virtual bool ClaimsFocus() {\
 		return (Condition);\
 	}\
+	virtual bool MayClaimFocus() {\
+		return true;\
+	}\
 
 // D: macro for definiting the user commands which trigger this agent
 #define TRIGGERED_BY_COMMANDS(Commands, GroundingModelSpec)\
@@ -51,6 +51,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the help agency is registered along with the Help
+//                           agent, and cloned with it from the dialog tree 
+//                           image
 //	 [2004-12-24] (antoine): added the possibility to define a DTMF key to
 //                           trigger this agent using the agent configuration
 //   [2004-04-24] (dbohus): changed agents to reopen (instead of reset) on
@@ -222,10 +225,21 @@ DEFINE_EXECUTE_AGENT( CHelp,
 
 		// initializes it
 		pdaHelpAgency->Initialize();
+	)
 
-		// registers it
+	// registers the help agency along with the agent
+	virtual void Register() {
+		CMAExecute::Register();
 		pdaHelpAgency->Register();
-	)
+	}
+
+	// the agent cloned from the dialog tree image gets a clone of the help
+	// agency too
+	virtual bool OnCloned(CDialogAgent* pdaPrototype) {
+		pdaHelpAgency = (CHelpExecutionAgency *)
+			((CHelp *)pdaPrototype)->pdaHelpAgency->CloneTree();
+		return pdaHelpAgency != NULL;
+	}
 	
 	ON_DESTRUCTION(
 	    if(pdaHelpAgency) {
@@ -53,6 +53,15 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  Clear deallocates the agents in the order of 
+//                           their names again, so that agencies created on
+//                           the fly go before their subagents
+//   [2026-10-18] (agent):  agents are registered under interned name symbols,
+//                           in an open-addressing hash table
+//   [2026-10-18] (agent):  the agent types hash is shared (copy-on-write) 
+//                           between the registries of all the sessions
+//   [2026-10-18] (agent):  the global registry object became a per-thread
+//                           pointer to the current session's registry
 //   [2002-05-25] (dbohus): deemed preliminary stable version 0.5
 //   [2001-12-30] (dbohus): started working on this
 // 
@@ -61,8 +70,24 @@
 #include "Registry.h"
 #include "DMCore/Log.h"
 
-// D: the AgentsRegistry object
-CRegistry AgentsRegistry;
+#include <algorithm>
+#include <mutex>
+
+// the registry of the dialog session bound to the current thread
+thread_local CRegistry *pAgentsRegistry = NULL;
+
+// the agent types published by the first session that created its dialog
+// task tree, which all the registries start from, and the mutex guarding it
+static TAgentsTypeHashPointer pSharedAgentsTypeHash;
+static std::mutex mSharedAgentsTypeHashMutex;
+
+// D: returns the published agent types hash (an empty one if there is none)
+static TAgentsTypeHashPointer sharedAgentTypes() {
+	std::lock_guard<std::mutex> lock(mSharedAgentsTypeHashMutex);
+	if(!pSharedAgentsTypeHash) 
+		return TAgentsTypeHashPointer(new TAgentsTypeHash());
+	return pSharedAgentsTypeHash;
+}
 
 //-----------------------------------------------------------------------------
 // Constructors and Destructors
@@ -70,25 +95,41 @@ CRegistry AgentsRegistry;
 
 // D: Constructor
 CRegistry::CRegistry() {
-	// nothing here
+	uiAgentsCount = 0;
+	pAgentsTypeHash = sharedAgentTypes();
 }
 
 // D: Initializes the registry, empties everything
 void CRegistry::Clear() {
 	Log(REGISTRY_STREAM, "Clearing up the registry ...");
 
-    // go through the agents hash and deallocate the remaining registered
-    // agents
+    // go through the agents and deallocate the remaining registered ones,
+    // in the order of their names, so that an agency goes before its 
+    // subagents (it deallocates them itself, and they unregister as they
+    // go, which is why every name is looked up again)
     Log(REGISTRY_STREAM, "Deallocating remaining registered agents ...");
-    while(!AgentsHash.empty()) {
-        // deallocate the agents        
-        delete AgentsHash.begin()->second;
+    while(uiAgentsCount > 0) {
+        vector<string> vsNames;
+        vsNames.reserve(uiAgentsCount);
+        for(unsigned int i = 0; i < AgentsHash.size(); i++)
+            if(AgentsHash[i].symAgentName != NO_SYMBOL)
+                vsNames.push_back(
+                    CSymbolTable::GetName(AgentsHash[i].symAgentName));
+        sort(vsNames.begin(), vsNames.end());
+        for(unsigned int i = 0; i < vsNames.size(); i++) {
+            // deallocate the agents        
+            CAgent* pAgent = (*this)[vsNames[i]];
+            if(pAgent) 
+                delete pAgent;
+        }
     }
     Log(REGISTRY_STREAM, "Deallocating remaining registered agents completed.");
 
-    // clear the hashes
+    // clear the hashes; the agent types start again from the published 
+	// ones
     AgentsHash.clear();
-	AgentsTypeHash.clear();
+	uiAgentsCount = 0;
+	pAgentsTypeHash = sharedAgentTypes();
 }
 
 //-----------------------------------------------------------------------------
@@ -98,48 +139,187 @@ void CRegistry::Clear() {
 //-----------------------------------------------------------------------------
 
 // D: return true if the agent is already registered
-bool CRegistry::IsRegisteredAgent(string sAgentName) {
-	return (AgentsHash.find(sAgentName) != AgentsHash.end());
+bool CRegistry::IsRegisteredAgent(const string& sAgentName) {
+	return findSlot(sAgentName, CSymbolTable::Hash(sAgentName)) != -1;
+}
+
+// D: return true if the agent is already registered
+bool CRegistry::IsRegisteredAgent(TSymbol symAgentName) {
+	return findSlot(symAgentName, CSymbolTable::GetHash(symAgentName)) != -1;
 }
 
 // D: register an agent into the registry.
-void CRegistry::RegisterAgent(string sAgentName, CAgent* pAgent)
+void CRegistry::RegisterAgent(const string& sAgentName, CAgent* pAgent) {
+	RegisterAgent(CSymbolTable::Intern(sAgentName), pAgent);
+}
+
+// D: register an agent into the registry, under the name with the given 
+//    symbol
+void CRegistry::RegisterAgent(TSymbol symAgentName, CAgent* pAgent)
 {
+	const string& sAgentName = CSymbolTable::GetName(symAgentName);
+	size_t stHash = CSymbolTable::GetHash(symAgentName);
+
 	// check that there's no agent already registered under the same name
-	if(IsRegisteredAgent(sAgentName)) {
+	if(findSlot(symAgentName, stHash) != -1) {
 		FatalError("An agent already registered under the same name (" + 
 					sAgentName + ") was found.");
 	}
 
-	// register the agent
-	AgentsHash.insert(TAgentsHash::value_type(sAgentName, pAgent));
+	// register the agent, keeping the table at most half full
+	if(2 * (uiAgentsCount + 1) > AgentsHash.size())
+		growAgentsHash();
+	insertEntry(symAgentName, stHash, pAgent);
+	uiAgentsCount++;
 
 	// and log that
 	Log(REGISTRY_STREAM, "Agent %s registered successfully.", sAgentName.c_str());
 }
 
 // D: unregister an agent 
-void CRegistry::UnRegisterAgent(string sAgentName) {
-	if(AgentsHash.erase(sAgentName) == 0) {
+void CRegistry::UnRegisterAgent(const string& sAgentName) {
+	int iSlot = findSlot(sAgentName, CSymbolTable::Hash(sAgentName));
+	if(iSlot == -1) {
 		FatalError("Could not find agent " + sAgentName + " to unregister.");
 	}
+	removeSlot(iSlot);
 
 	// and log that
 	Log(REGISTRY_STREAM, "Agent %s unregistered successfully.", 
 						 sAgentName.c_str());
 }
 
+// D: unregister an agent, given the symbol of its name
+void CRegistry::UnRegisterAgent(TSymbol symAgentName) {
+	int iSlot = findSlot(symAgentName, CSymbolTable::GetHash(symAgentName));
+	if(iSlot == -1) {
+		FatalError("Could not find agent " + 
+			CSymbolTable::GetName(symAgentName) + " to unregister.");
+	}
+	removeSlot(iSlot);
+
+	// and log that
+	Log(REGISTRY_STREAM, "Agent %s unregistered successfully.", 
+						 CSymbolTable::GetName(symAgentName).c_str());
+}
+
 // D: return a pointer to an agent, given the agent's name. Returns NULL if
 //    the agent is not found
-CAgent* CRegistry::operator [](string sAgentName) {
-	TAgentsHash::iterator iPtr;
-	if((iPtr = AgentsHash.find(sAgentName)) == AgentsHash.end()) {
-		// if the agent is not found, return NULL
+CAgent* CRegistry::operator [](const string& sAgentName) {
+	int iSlot = findSlot(sAgentName, CSymbolTable::Hash(sAgentName));
+	return (iSlot == -1)?NULL:AgentsHash[iSlot].pAgent;
+}
+
+// D: return a pointer to an agent, given the symbol of the agent's name. 
+//    Returns NULL if the agent is not found
+CAgent* CRegistry::operator [](TSymbol symAgentName) {
+	int iSlot = findSlot(symAgentName, CSymbolTable::GetHash(symAgentName));
+	return (iSlot == -1)?NULL:AgentsHash[iSlot].pAgent;
+}
+
+// D: return a pointer to the agent sParentName/sRelativeName, NULL if the 
+//    agent is not found
+CAgent* CRegistry::FindAgent(const string& sParentName, 
+							 const string& sRelativeName) {
+	if(AgentsHash.empty())
 		return NULL;
-	} else {
-		// otherwise, return the pointer to the agent
-		return iPtr->second;
+	size_t stHash = CSymbolTable::Hash(sRelativeName, 
+		CSymbolTable::Hash("/", 1, CSymbolTable::Hash(sParentName)));
+	size_t stLength = sParentName.length() + 1 + sRelativeName.length();
+	size_t stMask = AgentsHash.size() - 1;
+	for(size_t i = stHash & stMask; 
+		AgentsHash[i].symAgentName != NO_SYMBOL; i = (i + 1) & stMask) {
+		if(AgentsHash[i].stHash != stHash)
+			continue;
+		const string& sName = CSymbolTable::GetName(AgentsHash[i].symAgentName);
+		if((sName.length() == stLength) && 
+			(sName.compare(0, sParentName.length(), sParentName) == 0) &&
+			(sName[sParentName.length()] == '/') &&
+			(sName.compare(sParentName.length() + 1, string::npos, 
+				sRelativeName) == 0))
+			return AgentsHash[i].pAgent;
+	}
+	return NULL;
+}
+
+//-----------------------------------------------------------------------------
+//
+// Agents hash table helpers
+//
+//-----------------------------------------------------------------------------
+
+// D: returns the slot holding the given symbol, -1 if there is none
+int CRegistry::findSlot(TSymbol symAgentName, size_t stHash) {
+	if(AgentsHash.empty())
+		return -1;
+	size_t stMask = AgentsHash.size() - 1;
+	for(size_t i = stHash & stMask; 
+		AgentsHash[i].symAgentName != NO_SYMBOL; i = (i + 1) & stMask) {
+		if(AgentsHash[i].symAgentName == symAgentName)
+			return (int)i;
+	}
+	return -1;
+}
+
+// D: returns the slot holding the given name, -1 if there is none
+int CRegistry::findSlot(const string& sAgentName, size_t stHash) {
+	if(AgentsHash.empty())
+		return -1;
+	size_t stMask = AgentsHash.size() - 1;
+	for(size_t i = stHash & stMask; 
+		AgentsHash[i].symAgentName != NO_SYMBOL; i = (i + 1) & stMask) {
+		if((AgentsHash[i].stHash == stHash) && 
+			(CSymbolTable::GetName(AgentsHash[i].symAgentName) == sAgentName))
+			return (int)i;
+	}
+	return -1;
+}
+
+// D: puts an entry in the first free slot of its probe sequence
+void CRegistry::insertEntry(TSymbol symAgentName, size_t stHash, 
+							CAgent* pAgent) {
+	size_t stMask = AgentsHash.size() - 1;
+	size_t i = stHash & stMask;
+	while(AgentsHash[i].symAgentName != NO_SYMBOL)
+		i = (i + 1) & stMask;
+	AgentsHash[i].symAgentName = symAgentName;
+	AgentsHash[i].stHash = stHash;
+	AgentsHash[i].pAgent = pAgent;
+}
+
+// D: empties a slot, moving back the entries that follow it in the same 
+//    cluster where needed, so that no probe sequence gets broken (and no 
+//    deleted markers are needed)
+void CRegistry::removeSlot(int iSlot) {
+	size_t stMask = AgentsHash.size() - 1;
+	size_t i = (size_t)iSlot;
+	size_t j = i;
+	while(true) {
+		j = (j + 1) & stMask;
+		if(AgentsHash[j].symAgentName == NO_SYMBOL)
+			break;
+		// the entry in j can move to i if its home slot is not cyclically
+		// in (i, j]
+		size_t k = AgentsHash[j].stHash & stMask;
+		if((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)))
+			continue;
+		AgentsHash[i] = AgentsHash[j];
+		i = j;
 	}
+	AgentsHash[i].symAgentName = NO_SYMBOL;
+	AgentsHash[i].pAgent = NULL;
+	uiAgentsCount--;
+}
+
+// D: doubles the size of the table (the first one has 256 slots)
+void CRegistry::growAgentsHash() {
+	TAgentsHashEntry aheFree = {NO_SYMBOL, 0, NULL};
+	TAgentsHash ahOld(AgentsHash.empty()?256:(2 * AgentsHash.size()), aheFree);
+	AgentsHash.swap(ahOld);
+	for(unsigned int i = 0; i < ahOld.size(); i++)
+		if(ahOld[i].symAgentName != NO_SYMBOL)
+			insertEntry(ahOld[i].symAgentName, ahOld[i].stHash, 
+				ahOld[i].pAgent);
 }
 
 //-----------------------------------------------------------------------------
@@ -150,7 +330,7 @@ CAgent* CRegistry::operator [](string sAgentName) {
 
 // D: return true if the agent type is already registered
 bool CRegistry::IsRegisteredAgentType(string sAgentTypeName) {
-	return (AgentsTypeHash.find(sAgentTypeName) != AgentsTypeHash.end());
+	return (pAgentsTypeHash->find(sAgentTypeName) != pAgentsTypeHash->end());
 }
 
 // D: register an agent type into the registry.
@@ -158,14 +338,20 @@ void CRegistry::RegisterAgentType(string sAgentTypeName,
 								  FCreateAgent fctCreateAgent)
 {
 	// check that there's no agent already registered under the same name
-	if(IsRegisteredAgentType(sAgentTypeName)) {
+	TAgentsTypeHash::iterator iPtr = pAgentsTypeHash->find(sAgentTypeName);
+	if(iPtr != pAgentsTypeHash->end()) {
+		// the same type, coming from the published agent types: nothing to
+		// do
+		if(iPtr->second == fctCreateAgent) 
+			return;
 		FatalError("An agent type already registered under the same name (" + 
 					sAgentTypeName + ") was found.");
 	}
 
 	// register the agent type
-	AgentsTypeHash.insert(TAgentsTypeHash::value_type(sAgentTypeName, 
-			 										  fctCreateAgent));
+	detachAgentTypes();
+	pAgentsTypeHash->insert(TAgentsTypeHash::value_type(sAgentTypeName, 
+			 										    fctCreateAgent));
 
 	// and log that
 	Log(REGISTRY_STREAM, "Agent type %s registered successfully.", 
@@ -174,7 +360,8 @@ void CRegistry::RegisterAgentType(string sAgentTypeName,
 
 // D: unregister an agent type 
 void CRegistry::UnRegisterAgentType(string sAgentTypeName) {
-	if(AgentsTypeHash.erase(sAgentTypeName) == 0) {
+	detachAgentTypes();
+	if(pAgentsTypeHash->erase(sAgentTypeName) == 0) {
 		FatalError("Could not find agent type" + sAgentTypeName + 
 				   " to unregister.");
 	}
@@ -189,7 +376,8 @@ CAgent* CRegistry::CreateAgent(string sAgentTypeName, string sAgentName, string
 	
 	TAgentsTypeHash::iterator iPtr;
 	
-	if((iPtr = AgentsTypeHash.find(sAgentTypeName)) == AgentsTypeHash.end()) {
+	if((iPtr = pAgentsTypeHash->find(sAgentTypeName)) == 
+		pAgentsTypeHash->end()) {
 		// if the agent type is not in the registry, we're in bad shape
 		FatalError("Could not create agent of type " + sAgentTypeName + 
 				   ". Type not found in the registry.");
@@ -213,3 +401,26 @@ CAgent* CRegistry::CreateAgent(string sAgentTypeName, string sAgentName, string
 		}
 	}
 }
+
+// D: publishes the agent types of this registry, if it knows more types 
+//    than the ones published so far
+void CRegistry::PublishAgentTypes() {
+	std::lock_guard<std::mutex> lock(mSharedAgentsTypeHashMutex);
+	if(pSharedAgentsTypeHash == pAgentsTypeHash)
+		return;
+	if(!pSharedAgentsTypeHash || 
+		(pSharedAgentsTypeHash->size() < pAgentsTypeHash->size())) {
+		pSharedAgentsTypeHash = pAgentsTypeHash;
+		Log(REGISTRY_STREAM, "Published %d agent types.", 
+			(int)pAgentsTypeHash->size());
+	}
+}
+
+// D: copies the agent types hash, if it is shared with other registries 
+//    (or published)
+void CRegistry::detachAgentTypes() {
+	std::lock_guard<std::mutex> lock(mSharedAgentsTypeHashMutex);
+	if(pAgentsTypeHash.use_count() > 1)
+		pAgentsTypeHash = TAgentsTypeHashPointer(
+			new TAgentsTypeHash(*pAgentsTypeHash));
+}
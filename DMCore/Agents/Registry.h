@@ -53,6 +53,12 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  agents are registered under interned name symbols,
+//                           in an open-addressing hash table
+//   [2026-10-18] (agent):  the agent types hash is shared (copy-on-write) 
+//                           between the registries of all the sessions
+//   [2026-10-18] (agent):  AgentsRegistry is now a per-thread alias for the
+//                           registry of the currently bound dialog session
 //   [2002-05-25] (dbohus): deemed preliminary stable version 0.5
 //   [2001-12-30] (dbohus): started working on this
 // 
@@ -63,6 +69,7 @@
 #define __REGISTRY_H__
 
 #include "Utils/Utils.h"
+#include "SymbolTable.h"
 #include "Agent.h"
 
 //-----------------------------------------------------------------------------
@@ -76,8 +83,19 @@
 
 class CAgent;		// forward class declaration
 
-// D: definition of hash type to hold mapping from agent names to agents
-typedef map <string, CAgent*, less<string>, allocator<CAgent*> > TAgentsHash;
+// D: definition of an entry of the hash table holding the mapping from 
+//   agent names to agents: the symbol of the agent name (NO_SYMBOL for a 
+//   free slot), the hash of the name, and the agent
+typedef struct {
+	TSymbol symAgentName;
+	size_t stHash;
+	CAgent* pAgent;
+} TAgentsHashEntry;
+
+// D: definition of hash type to hold mapping from agent names to agents: 
+//   a flat table with open addressing (linear probing), whose size is a 
+//   power of two
+typedef vector<TAgentsHashEntry> TAgentsHash;
 
 // D: definition of function type for creating an agent
 typedef CAgent* (*FCreateAgent)(string, string);
@@ -90,14 +108,22 @@ typedef void (*FRegisterAgent)(void);
 typedef map <string, FCreateAgent, less<string>, allocator<FCreateAgent> >
   TAgentsTypeHash;
 
+// D: definition of a shared pointer to an agent types hash. The hash is 
+//   shared by the registries of all the sessions, and copied by a registry
+//   only when that registry needs to change it
+typedef std::shared_ptr<TAgentsTypeHash> TAgentsTypeHashPointer;
+
 class CRegistry {
 
 private:
-	// hash holding agent name -> agent mapping
+	// hash holding agent name -> agent mapping, and the number of agents
+	// in it
 	TAgentsHash AgentsHash;		
+	unsigned int uiAgentsCount;
 
 	// hash holding agent type name -> agent creation function mapping
-	TAgentsTypeHash AgentsTypeHash; 
+	// (possibly shared with other registries, see PublishAgentTypes)
+	TAgentsTypeHashPointer pAgentsTypeHash; 
 
 public:
 	// Constructors and Destructor
@@ -112,15 +138,25 @@ public:
 	// Registry specific functions for agent names
 	//------------------------------------------------------------------------
 	
-	// Register and unregister an agent
+	// Register and unregister an agent, by name or by name symbol
+	//
+	void RegisterAgent(const string& sAgentName, CAgent* pAgent);
+	void RegisterAgent(TSymbol symAgentName, CAgent* pAgent);
+	void UnRegisterAgent(const string& sAgentName);
+	void UnRegisterAgent(TSymbol symAgentName);
+	bool IsRegisteredAgent(const string& sAgentName);
+	bool IsRegisteredAgent(TSymbol symAgentName);
+
+	// Obtain a pointer to the agent (NULL if there is no such agent). The
+	// lookups by name neither intern nor copy the name
 	//
-	void RegisterAgent(string sAgentName, CAgent* pAgent);
-	void UnRegisterAgent(string sAgentName);
-	bool IsRegisteredAgent(string sAgentName);
+	CAgent* operator[](const string& sAgentName);
+	CAgent* operator[](TSymbol symAgentName);
 
-	// Obtain a pointer to the agent
+	// Obtain a pointer to the agent named sParentName + "/" + sRelativeName
+	// (without building that name)
 	//
-	CAgent* operator[](string sAgentName);
+	CAgent* FindAgent(const string& sParentName, const string& sRelativeName);
 
 	//------------------------------------------------------------------------
 	// Registry specific functions for agent types
@@ -136,11 +172,37 @@ public:
 	//
 	CAgent* CreateAgent(string sAgentTypeName, string sAgentName, 
 		string sAgentConfiguration = "");
+
+	// Makes the agent types registered so far the starting point for the 
+	// registries cleared from now on (by any session): registering those 
+	// types again is then a no-op that does not copy the hash
+	//
+	void PublishAgentTypes();
+
+private:
+	// Makes sure the agent types hash is not shared, before changing it
+	//
+	void detachAgentTypes();
+
+	// Agents hash table helpers: find the slot of a symbol or of a name 
+	// (-1 if not found), insert into a table known not to contain the 
+	// symbol, remove the entry in a slot, and double the table
+	//
+	int findSlot(TSymbol symAgentName, size_t stHash);
+	int findSlot(const string& sAgentName, size_t stHash);
+	void insertEntry(TSymbol symAgentName, size_t stHash, CAgent* pAgent);
+	void removeSlot(int iSlot);
+	void growAgentsHash();
 };
 
 //-----------------------------------------------------------------------------
 // The AgentRegistry object and access to Call 
 //-----------------------------------------------------------------------------
-extern CRegistry AgentsRegistry;
+// each dialog session owns its own registry (see DMCore/DialogSession.h);
+//    pAgentsRegistry points to the registry of the session currently bound
+//    to the calling thread, and AgentsRegistry is kept as an alias so that
+//    existing code (and the agent declaration macros) work unchanged
+extern thread_local CRegistry *pAgentsRegistry;
+#define AgentsRegistry (*pAgentsRegistry)
 
 #endif // __REGISTRY_H__
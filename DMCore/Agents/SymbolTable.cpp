@@ -0,0 +1,187 @@
+//=============================================================================
+//
+//   Copyright (c) 2000-2004, Carnegie Mellon University.  
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions
+//   are met:
+//
+//   1. Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer. 
+//
+//   2. Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//   This work was supported in part by funding from the Defense Advanced 
+//   Research Projects Agency and the National Science Foundation of the 
+//   United States of America, and the CMU Sphinx Speech Consortium.
+//
+//   THIS SOFTWARE IS PROVIDED BY CARNEGIE MELLON UNIVERSITY ``AS IS'' AND 
+//   ANY EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+//   THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//   PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL CARNEGIE MELLON UNIVERSITY
+//   NOR ITS EMPLOYEES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+//   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+//   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//=============================================================================
+//-----------------------------------------------------------------------------
+// 
+// SYMBOLTABLE.CPP - implementation of the CSymbolTable class
+// 
+// ----------------------------------------------------------------------------
+// 
+// BEFORE MAKING CHANGES TO THIS CODE, please read the appropriate 
+// documentation, available in the Documentation folder. 
+//
+// ANY SIGNIFICANT CHANGES made should be reflected back in the documentation
+// file(s)
+//
+// ANY CHANGES made (even small bug fixes, should be reflected in the history
+// below, in reverse chronological order
+// 
+// HISTORY --------------------------------------------------------------------
+//
+//   [2026-10-18] (agent):  started working on this
+// 
+//-----------------------------------------------------------------------------
+
+#include "SymbolTable.h"
+#include "DMCore/Log.h"
+
+#include <mutex>
+#include <unordered_map>
+
+// the entries are kept in chunks that are never reallocated, so that a 
+// symbol's entry stays where it is as the table grows
+#define SYMBOL_CHUNK_BITS	12
+#define SYMBOL_CHUNK_SIZE	(1 << SYMBOL_CHUNK_BITS)
+#define MAX_SYMBOL_CHUNKS	1024
+
+// D: an entry of the table: the name and its hash
+typedef struct {
+	string sName;
+	size_t stHash;
+} TSymbolEntry;
+
+// D: the chunks of entries, and the number of symbols handed out (the 
+//    entry for NO_SYMBOL is never used). Plain statics, zero-initialized 
+//    before any agent gets constructed during static initialization
+static TSymbolEntry* ppseChunks[MAX_SYMBOL_CHUNKS];
+static int iSymbolsCount;
+
+// D: the name -> symbol index, and the mutex guarding the table (function
+//    statics, since names are also interned during static initialization)
+typedef unordered_map<string, TSymbol> TSymbolIndex;
+
+static TSymbolIndex& symbolIndex() {
+	static TSymbolIndex *psiIndex = new TSymbolIndex();
+	return *psiIndex;
+}
+
+static std::mutex& symbolTableMutex() {
+	static std::mutex *pmMutex = new std::mutex();
+	return *pmMutex;
+}
+
+// D: the entry of a symbol
+static inline TSymbolEntry& symbolEntry(TSymbol symSymbol) {
+	return ppseChunks[symSymbol >> SYMBOL_CHUNK_BITS]
+		[symSymbol & (SYMBOL_CHUNK_SIZE - 1)];
+}
+
+//-----------------------------------------------------------------------------
+// Interning
+//-----------------------------------------------------------------------------
+
+// D: returns the symbol for a name, adding the name to the table if needed
+TSymbol CSymbolTable::Intern(const string& sName) {
+	std::lock_guard<std::mutex> lock(symbolTableMutex());
+	TSymbolIndex::iterator iPtr = symbolIndex().find(sName);
+	if(iPtr != symbolIndex().end())
+		return iPtr->second;
+
+	// the first symbol handed out is 1 (0 is NO_SYMBOL)
+	TSymbol symNew = iSymbolsCount + 1;
+	int iChunk = symNew >> SYMBOL_CHUNK_BITS;
+	if(iChunk >= MAX_SYMBOL_CHUNKS) {
+		FatalError("Symbol table full, could not intern " + sName + ".");
+		return NO_SYMBOL;
+	}
+	if(!ppseChunks[iChunk])
+		ppseChunks[iChunk] = new TSymbolEntry[SYMBOL_CHUNK_SIZE];
+	TSymbolEntry& rseEntry = symbolEntry(symNew);
+	rseEntry.sName = sName;
+	rseEntry.stHash = Hash(sName);
+	iSymbolsCount++;
+	symbolIndex().insert(TSymbolIndex::value_type(sName, symNew));
+	return symNew;
+}
+
+// D: returns the symbol for a name, or NO_SYMBOL if there is none
+TSymbol CSymbolTable::Find(const string& sName) {
+	std::lock_guard<std::mutex> lock(symbolTableMutex());
+	TSymbolIndex::iterator iPtr = symbolIndex().find(sName);
+	if(iPtr == symbolIndex().end())
+		return NO_SYMBOL;
+	return iPtr->second;
+}
+
+//-----------------------------------------------------------------------------
+// Access to the symbols
+//-----------------------------------------------------------------------------
+
+// D: returns the name of a symbol
+const string& CSymbolTable::GetName(TSymbol symSymbol) {
+	static const string *psEmpty = new string();
+	if(symSymbol <= NO_SYMBOL)
+		return *psEmpty;
+	return symbolEntry(symSymbol).sName;
+}
+
+// D: returns the hash of the name of a symbol
+size_t CSymbolTable::GetHash(TSymbol symSymbol) {
+	if(symSymbol <= NO_SYMBOL)
+		return HashSeed();
+	return symbolEntry(symSymbol).stHash;
+}
+
+// D: returns the number of symbols interned so far
+int CSymbolTable::GetCount() {
+	std::lock_guard<std::mutex> lock(symbolTableMutex());
+	return iSymbolsCount;
+}
+
+//-----------------------------------------------------------------------------
+// Hashing
+//-----------------------------------------------------------------------------
+
+// D: the hash of the empty string
+size_t CSymbolTable::HashSeed() {
+	return (sizeof(size_t) == 8) ? (size_t)14695981039346656037ULL : 
+		(size_t)2166136261UL;
+}
+
+// D: continues the hash stHash with the characters of sName
+size_t CSymbolTable::Hash(const string& sName, size_t stHash) {
+	return Hash(sName.data(), sName.length(), stHash);
+}
+
+// D: continues the hash stHash with stLength characters
+size_t CSymbolTable::Hash(const char* lpszName, size_t stLength, 
+	size_t stHash) {
+	const size_t stPrime = (sizeof(size_t) == 8) ? 
+		(size_t)1099511628211ULL : (size_t)16777619UL;
+	for(size_t i = 0; i < stLength; i++) {
+		stHash ^= (unsigned char)lpszName[i];
+		stHash *= stPrime;
+	}
+	return stHash;
+}
@@ -0,0 +1,134 @@
+//=============================================================================
+//
+//   Copyright (c) 2000-2004, Carnegie Mellon University.  
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions
+//   are met:
+//
+//   1. Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer. 
+//
+//   2. Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//   This work was supported in part by funding from the Defense Advanced 
+//   Research Projects Agency and the National Science Foundation of the 
+//   United States of America, and the CMU Sphinx Speech Consortium.
+//
+//   THIS SOFTWARE IS PROVIDED BY CARNEGIE MELLON UNIVERSITY ``AS IS'' AND 
+//   ANY EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+//   THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//   PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL CARNEGIE MELLON UNIVERSITY
+//   NOR ITS EMPLOYEES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+//   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+//   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//=============================================================================
+//-----------------------------------------------------------------------------
+// 
+// SYMBOLTABLE.H - definition of the CSymbolTable class. The symbol table 
+//                 interns the names of agents into small integer symbols, 
+//                 so that they can be compared, hashed and looked up 
+//                 without handling the strings (see CRegistry)
+// 
+// ----------------------------------------------------------------------------
+// 
+// BEFORE MAKING CHANGES TO THIS CODE, please read the appropriate 
+// documentation, available in the Documentation folder. 
+//
+// ANY SIGNIFICANT CHANGES made should be reflected back in the documentation
+// file(s)
+//
+// ANY CHANGES made (even small bug fixes, should be reflected in the history
+// below, in reverse chronological order
+// 
+// HISTORY --------------------------------------------------------------------
+//
+//   [2026-10-18] (agent):  started working on this
+// 
+//-----------------------------------------------------------------------------
+
+#pragma once
+#ifndef __SYMBOLTABLE_H__
+#define __SYMBOLTABLE_H__
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+// D: a symbol: the index of an interned name in the symbol table
+typedef int TSymbol;
+
+// D: the symbol that stands for no name at all (never handed out by Intern)
+#define NO_SYMBOL	0
+
+//-----------------------------------------------------------------------------
+//
+// CSymbolTable class - the process-wide table of interned names. A name is
+//   given a symbol the first time it is interned, and keeps it for the 
+//   lifetime of the process: names are never removed, so the table only 
+//   stays bounded if what gets interned is. Only intern the names of the 
+//   agents of the dialog task tree (and of the agencies the grounding 
+//   actions create for them); names made up per dialog or per input, such
+//   as the ones carrying a dynamic agent id (#) or the slots of an input, 
+//   would grow the table for as long as the process runs, and must be 
+//   kept as strings instead. Interning takes a lock; getting the name or 
+//   the hash of a symbol does not, as the entries of the table never move 
+//   or change once they are written.
+//
+//-----------------------------------------------------------------------------
+
+class CSymbolTable {
+
+public:
+	//---------------------------------------------------------------------
+	// Interning
+	//---------------------------------------------------------------------
+
+	// Returns the symbol for a name, interning the name if needed
+	//
+	static TSymbol Intern(const string& sName);
+
+	// Returns the symbol for a name, or NO_SYMBOL if the name was never
+	// interned
+	//
+	static TSymbol Find(const string& sName);
+
+	//---------------------------------------------------------------------
+	// Access to the symbols
+	//---------------------------------------------------------------------
+
+	// Returns the name of a symbol ("" for NO_SYMBOL)
+	//
+	static const string& GetName(TSymbol symSymbol);
+
+	// Returns the hash of the name of a symbol (as computed by Hash)
+	//
+	static size_t GetHash(TSymbol symSymbol);
+
+	// Returns the number of symbols interned so far
+	//
+	static int GetCount();
+
+	//---------------------------------------------------------------------
+	// Hashing (FNV-1a). The hash of a name can be computed piece by piece,
+	// by passing the hash of the previous pieces in stHash, so that the 
+	// hash of a concatenation can be obtained without building it
+	//---------------------------------------------------------------------
+
+	static size_t Hash(const string& sName, size_t stHash = HashSeed());
+	static size_t Hash(const char* lpszName, size_t stLength, 
+		size_t stHash);
+	static size_t HashSeed();
+};
+
+#endif // __SYMBOLTABLE_H__
@@ -50,6 +50,16 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  hypotheses are allocated from per-thread free 
+//                           lists (see CHyp::operator new); the destructor
+//                           deletes the hypotheses of the concept, which 
+//                           were leaked until now
+//   [2026-10-18] (agent):  the methods that change a concept notify the 
+//                           dialog core (NotifyDialogStateChanged)
+//   [2026-10-18] (agent):  added operator new and delete, so that concepts
+//                           can be placed in a dialog tree arena
+//   [2026-10-18] (agent):  added SaveToRecord and LoadFromRecord, for session
+//                           hibernation
 //	 [2005-11-07] (antoine): added support for partial concept update
 //   [2004-06-02] (dbohus):  added definition of pOwnerConcept, concepts now
 //                            check with parent if unclear if they are
@@ -105,12 +115,24 @@
 #include "DMCore/Log.h"
 #include "DMCore/DMCore.h"
 #include "DMCore/Agents/DialogAgents/DialogAgent.h"
+#include "DMCore/SessionRecord.h"
+#include "DMCore/DialogTreeArena.h"
+
+#include <atomic>
 
 #pragma warning (disable:4100)
 
 // NULL concept: this object is used designate invalid concept references
 CConcept NULLConcept("NULL");
 
+// D: tells the dialog core of the current session that a concept changed, 
+//    so that the completion criteria cached by the agents are evaluated 
+//    again (see CDialogAgent::EvaluateSuccessCriteria)
+static inline void notifyDialogStateChanged() {
+	if(pDMCore) 
+		pDMCore->NotifyDialogStateChanged();
+}
+
 //-----------------------------------------------------------------------------
 // CHyp class - this is the base class for the hierarchy of hypothesis
 //              classes. It essentially implements a type and an associated 
@@ -133,6 +155,94 @@ CHyp::CHyp(CHyp& rAHyp) {
 CHyp::~CHyp() {
 }
 
+//-----------------------------------------------------------------------------
+// Hypothesis allocation
+//-----------------------------------------------------------------------------
+
+// D: the hypotheses are allocated in size classes of HYP_SIZE_STEP bytes, 
+//    up to HYP_SIZE_CLASSES classes (larger ones come from the heap); at 
+//    most MAX_POOLED_HYPS free blocks are kept per class and thread
+#define HYP_SIZE_STEP		8
+#define HYP_SIZE_CLASSES	32
+#define MAX_POOLED_HYPS		1024
+
+// D: the free blocks of a thread, by size class (the blocks left when the 
+//    thread ends are freed; hypotheses deleted after that are freed 
+//    directly)
+class CHypPool {
+public:
+	vector<void*> vpFreeBlocks[HYP_SIZE_CLASSES];
+	~CHypPool();
+};
+
+static thread_local CHypPool hpPool;
+static thread_local bool bHypPoolDestroyed = false;
+
+CHypPool::~CHypPool() {
+	for(int c = 0; c < HYP_SIZE_CLASSES; c++) {
+		for(unsigned int i = 0; i < vpFreeBlocks[c].size(); i++)
+			::operator delete(vpFreeBlocks[c][i]);
+		vpFreeBlocks[c].clear();
+	}
+	bHypPoolDestroyed = true;
+}
+
+// D: the allocation counters of a thread
+static thread_local THypAllocationCounters hacCounters = {0, 0, 0};
+
+// D: indicates if the free blocks are reused
+static atomic<bool> bUseHypPool(true);
+
+// D: allocates a hypothesis, in a free block of its size class if there is
+//    one (all the blocks of a class have the size of the class, so that 
+//    they can hold any hypothesis of the class)
+void* CHyp::operator new(size_t stSize) {
+	int iClass = (int)((stSize + HYP_SIZE_STEP - 1) / HYP_SIZE_STEP);
+	if(iClass >= HYP_SIZE_CLASSES) {
+		hacCounters.iHypsAllocated++;
+		return ::operator new(stSize);
+	}
+	if(bUseHypPool && !bHypPoolDestroyed && 
+		!hpPool.vpFreeBlocks[iClass].empty()) {
+		void* pBlock = hpPool.vpFreeBlocks[iClass].back();
+		hpPool.vpFreeBlocks[iClass].pop_back();
+		hacCounters.iHypsReused++;
+		return pBlock;
+	}
+	hacCounters.iHypsAllocated++;
+	return ::operator new(iClass * HYP_SIZE_STEP);
+}
+
+// D: releases a hypothesis: its block is kept for reuse, unless the free 
+//    blocks of its class are full (or not used)
+void CHyp::operator delete(void* pMemory, size_t stSize) {
+	if(pMemory == NULL) 
+		return;
+	hacCounters.iHypsReleased++;
+	int iClass = (int)((stSize + HYP_SIZE_STEP - 1) / HYP_SIZE_STEP);
+	if((iClass < HYP_SIZE_CLASSES) && bUseHypPool && !bHypPoolDestroyed &&
+		(hpPool.vpFreeBlocks[iClass].size() < MAX_POOLED_HYPS)) {
+		hpPool.vpFreeBlocks[iClass].push_back(pMemory);
+		return;
+	}
+	::operator delete(pMemory);
+}
+
+// D: Enables or disables the reuse of the free blocks
+void CHyp::SetUseHypPool(bool bAUseHypPool) {
+	bUseHypPool = bAUseHypPool;
+}
+
+// D: Indicates if the free blocks are reused
+bool CHyp::GetUseHypPool() {
+	return bUseHypPool;
+}
+
+// D: Returns the allocation counters of the calling thread
+THypAllocationCounters CHyp::GetAllocationCounters() {
+	return hacCounters;
+}
+
 //-----------------------------------------------------------------------------
 // Acess to member variables
 //-----------------------------------------------------------------------------
@@ -277,6 +387,23 @@ CConcept::~CConcept() {
     if(bWaitingConveyance) ClearWaitingConveyance();
     // clear the concept notification pointer
     ClearConceptNotificationPointer();
+    // and delete the hypotheses (the current and the partial ones)
+    for(unsigned int h = 0; h < vhCurrentHypSet.size(); h++)
+        if(vhCurrentHypSet[h] != NULL)
+            delete vhCurrentHypSet[h];
+    for(unsigned int h = 0; h < vhPartialHypSet.size(); h++)
+        if(vhPartialHypSet[h] != NULL)
+            delete vhPartialHypSet[h];
+}
+
+// D: allocates a concept, from the current dialog tree arena if there is one
+void* CConcept::operator new(size_t stSize) {
+	return CDialogTreeArena::New(stSize);
+}
+
+// D: releases a concept allocated by the operator new above
+void CConcept::operator delete(void* pObject) {
+	CDialogTreeArena::Delete(pObject);
 }
 
 //-----------------------------------------------------------------------------
@@ -487,6 +614,7 @@ CConcept::operator string() {
 
 // D: clears the contents of the concept
 void CConcept::Clear() {
+    notifyDialogStateChanged();
     // check if it's a history concept
     if(bHistoryConcept)
         FatalError(FormatString("Cannot perform Clear on concept (%s) history.",
@@ -524,6 +652,7 @@ void CConcept::Clear() {
 
 // D: clears the current value of the concept
 void CConcept::ClearCurrentValue() {
+    notifyDialogStateChanged();
     // check if it's a history concept
     if(bHistoryConcept)
         FatalError(FormatString(
@@ -609,6 +738,7 @@ CConcept* CConcept::EmptyClone() {
 
 // D: update the concept
 void CConcept::Update(string sUpdateType, void* pUpdateData) {
+	notifyDialogStateChanged();
 
     // record the initial value of the concept (if the concept has a grounding
     //  model
@@ -1654,6 +1784,7 @@ CGMConcept* CConcept::GetGroundingModel() {
 
 // D: Sets the grounded flag on the concept
 void CConcept::SetGroundedFlag(bool bAGrounded) {
+	notifyDialogStateChanged();
 	bGrounded = bAGrounded;
 	// now if the concept was set to grounded and it was restored for grounding
 	if(bGrounded && bRestoredForGrounding) {
@@ -1722,6 +1853,7 @@ void CConcept::DeclareConcepts(TConceptPointersVector& rcpvConcepts,
 
 // D: set the invalidated flag
 void CConcept::SetInvalidatedFlag(bool bAInvalidated) {
+    notifyDialogStateChanged();
     // set the flag
     bInvalidated = bAInvalidated;
     // if the concept has been restored for grounding, and how has just been
@@ -1749,6 +1881,7 @@ bool CConcept::GetInvalidatedFlag() {
 
 // D: set the restored for grounding flag
 void CConcept::SetRestoredForGroundingFlag(bool bARestoredForGrounding) {
+    notifyDialogStateChanged();
     // set the flag
     if(bARestoredForGrounding) {
         bRestoredForGrounding = true;
@@ -1768,11 +1901,13 @@ bool CConcept::GetRestoredForGroundingFlag() {
 
 // D: Seal the concept
 void CConcept::Seal() {
+	notifyDialogStateChanged();
 	bSealed = true;
 }
 
 // D: Set the value of the seal flag to false
 void CConcept::BreakSeal() {
+	notifyDialogStateChanged();
 	bSealed = false;
 }
 
@@ -1803,6 +1938,7 @@ void CConcept::SetChangeNotification(
 
 // D: Processing that happens each time the concept changes
 void CConcept::NotifyChange() {
+    notifyDialogStateChanged();
     // set the grounded flag to false
     SetGroundedFlag(false);
     // set the invalidated flag to false
@@ -1834,6 +1970,7 @@ CHyp* CConcept::HypFactory() {
 
 // D: adds a hypothesis to the current set of hypotheses
 int CConcept::AddHyp(CHyp* pAHyp) {
+    notifyDialogStateChanged();
     vhCurrentHypSet.push_back(pAHyp);
     iNumValidHyps++;
 	// notify the concept change
@@ -1843,6 +1980,7 @@ int CConcept::AddHyp(CHyp* pAHyp) {
 
 // D: adds a new hypothesis to the current set of hypotheses
 int CConcept::AddNewHyp() {
+    notifyDialogStateChanged();
     vhCurrentHypSet.push_back(HypFactory());
     iNumValidHyps++;
 	// notify the concept change
@@ -1852,6 +1990,7 @@ int CConcept::AddNewHyp() {
 
 // D: adds a null hypothesis to the current set of hypotheses
 int CConcept::AddNullHyp() {
+    notifyDialogStateChanged();
     vhCurrentHypSet.push_back(NULL);
 	// notify the concept change
     NotifyChange();
@@ -1860,6 +1999,7 @@ int CConcept::AddNullHyp() {
 
 // D: sets a hypothesis into a location
 void CConcept::SetHyp(int iIndex, CHyp* pHyp) {
+    notifyDialogStateChanged();
     // first set it to null
     SetNullHyp(iIndex);
     // check if pHyp is null, then return
@@ -1875,6 +2015,7 @@ void CConcept::SetHyp(int iIndex, CHyp* pHyp) {
 
 // D: sets a null hypothesis into a location
 void CConcept::SetNullHyp(int iIndex) {
+    notifyDialogStateChanged();
     // if it's already null, return
     if(vhCurrentHypSet[iIndex] == NULL) return;
     // o/w delete it
@@ -1888,6 +2029,7 @@ void CConcept::SetNullHyp(int iIndex) {
 
 // D: deletes a hypothesis at a given location
 void CConcept::DeleteHyp(int iIndex) {
+	notifyDialogStateChanged();
 	if(vhCurrentHypSet[iIndex] != NULL) {
 		// if it's not null, destroy it
 		delete vhCurrentHypSet[iIndex];
@@ -1927,6 +2069,7 @@ float CConcept::GetHypConfidence(int iIndex) {
 
 // D: set the confidence for a certain hypothesis (specified by the index)
 void CConcept::SetHypConfidence(int iIndex, float fConfidence) {
+	notifyDialogStateChanged();
 	CHyp* pHyp = GetHyp(iIndex);
 	if(pHyp) {
 		if(pHyp->GetConfidence() != fConfidence) {
@@ -2019,6 +2162,7 @@ int CConcept::GetNumValidHyps() {
 
 // D: clear the current set of hypotheses for the concept
 void CConcept::ClearCurrentHypSet() {
+    notifyDialogStateChanged();
     // if it's already clear, return
 	if(vhCurrentHypSet.size() == 0) return;
     // go through all the valconfs and deallocate them
@@ -2035,6 +2179,7 @@ void CConcept::ClearCurrentHypSet() {
 
 // D: copies the current set of hypotheses from another concept
 void CConcept::CopyCurrentHypSetFrom(CConcept& rAConcept) {
+    notifyDialogStateChanged();
     // first clear it
     ClearCurrentHypSet();
     // then go through all the hypotheses from the source concept
@@ -2104,21 +2249,25 @@ string CConcept::GetConceptTypeInfo() {
 
 // D: set the explicitly confirmed hyp
 void CConcept::SetExplicitlyConfirmedHyp(CHyp* pHyp) {
+    notifyDialogStateChanged();
     SetExplicitlyConfirmedHyp(pHyp->ValueToString());
 }
 
 // D: alternate function for settting the explicitly confirmed hyp
 void CConcept::SetExplicitlyConfirmedHyp(string sAExplicitlyConfirmedHyp) {
+    notifyDialogStateChanged();
     sExplicitlyConfirmedHyp = sAExplicitlyConfirmedHyp;
 }
 
 // D: set the explicitly disconfirmed hyp
 void CConcept::SetExplicitlyDisconfirmedHyp(CHyp* pHyp) {
+    notifyDialogStateChanged();
     SetExplicitlyDisconfirmedHyp(pHyp->ValueToString());
 }
 
 // D: alternate function for settting the explicitly disconfirmed hyp
 void CConcept::SetExplicitlyDisconfirmedHyp(string sAExplicitlyDisconfirmedHyp) {
+    notifyDialogStateChanged();
     sExplicitlyDisconfirmedHyp = sAExplicitlyDisconfirmedHyp;
 }
 
@@ -2134,11 +2283,13 @@ string CConcept::GetExplicitlyDisconfirmedHypAsString() {
 
 // D: clears the explicitly confirmed hyp
 void CConcept::ClearExplicitlyConfirmedHyp() {
+    notifyDialogStateChanged();
     sExplicitlyConfirmedHyp = "";
 }
 
 // D: clears the explicitly confirmed hyp
 void CConcept::ClearExplicitlyDisconfirmedHyp() {
+    notifyDialogStateChanged();
     sExplicitlyConfirmedHyp = "";
 }
 
@@ -2148,6 +2299,7 @@ void CConcept::ClearExplicitlyDisconfirmedHyp() {
 
 // A: adds a partial hypothesis to the current set of partial hypotheses
 int CConcept::AddPartialHyp(CHyp* pAHyp) {
+    notifyDialogStateChanged();
     vhPartialHypSet.push_back(pAHyp);
     iNumValidPartialHyps++;
 	return (int)(vhPartialHypSet.size() - 1);
@@ -2155,6 +2307,7 @@ int CConcept::AddPartialHyp(CHyp* pAHyp) {
 
 // A: adds a new partial hypothesis to the current set of partial hypotheses
 int CConcept::AddNewPartialHyp() {
+    notifyDialogStateChanged();
     vhPartialHypSet.push_back(HypFactory());
     iNumValidPartialHyps++;
 	return (int)(vhPartialHypSet.size() - 1);
@@ -2162,6 +2315,7 @@ int CConcept::AddNewPartialHyp() {
 
 // A: adds a null hypothesis to the current set of partial hypotheses
 int CConcept::AddNullPartialHyp() {
+    notifyDialogStateChanged();
     vhPartialHypSet.push_back(NULL);
     return (int)(vhPartialHypSet.size() - 1);
 }
@@ -2236,6 +2390,7 @@ int CConcept::GetNumValidPartialHyps() {
 }
 // A: clears the current partial value of the concept
 void CConcept::ClearPartialHypSet() {
+	notifyDialogStateChanged();
 	// reset the partial hyp set
 	// go through all the valconfs and deallocate them
 	for(int h = 0; h < (int)vhPartialHypSet.size(); h++) {
@@ -2254,11 +2409,13 @@ void CConcept::ClearPartialHypSet() {
 
 // D: Set the turn the concept was last updated
 void CConcept::SetTurnLastUpdated(int iTurn) {
+    notifyDialogStateChanged();
     iTurnLastUpdated = iTurn;
 }
 
 // D: Mark now as the turn in which the concept was last updated
 void CConcept::MarkTurnLastUpdated() {
+	notifyDialogStateChanged();
 	SetTurnLastUpdated(pDMCore->GetLastInputTurnNumber());
 }
 
@@ -2279,11 +2436,13 @@ int CConcept::GetTurnsSinceLastUpdated() {
 
 // D: sets the waiting for conveyance flag
 void CConcept::SetWaitingConveyance() {
+    notifyDialogStateChanged();
     bWaitingConveyance = true;
 }
 
 // D: clear the waiting for conveyance flag
 void CConcept::ClearWaitingConveyance() {
+	notifyDialogStateChanged();
 	if(bWaitingConveyance) {
 		bWaitingConveyance = false;
 		if(pOutputManager) 
@@ -2293,6 +2452,7 @@ void CConcept::ClearWaitingConveyance() {
 
 // A: set the conveyance information
 void CConcept::SetConveyance(TConveyance cAConveyance) {
+	notifyDialogStateChanged();
 	cConveyance = cAConveyance;
 }
 
@@ -2314,6 +2474,7 @@ void CConcept::ClearConceptNotificationPointer() {
 // D: reopens the concept (i.e. moves current value into history, and starts
 //    with a clean new value
 void CConcept::ReOpen() {
+	notifyDialogStateChanged();
 
 	// first check that it's not a history concept
     if(bHistoryConcept)
@@ -2357,6 +2518,7 @@ void CConcept::ReOpen() {
 // D: restores the concept (i.e. restores the concept to a previous incarnation
 //    from its history
 void CConcept::Restore(int iIndex) {
+	notifyDialogStateChanged();
 
 	// first check if it's not a history concept
     if(bHistoryConcept)
@@ -2396,6 +2558,7 @@ void CConcept::Restore(int iIndex) {
 
 // D: clears the history of the current concept
 void CConcept::ClearHistory() {
+    notifyDialogStateChanged();
     // check if it's a history concept
     if(bHistoryConcept)
         FatalError(FormatString("Cannot perform ClearHistory on concept (%s) history.",
@@ -2438,6 +2601,7 @@ CConcept* CConcept::CreateMergedHistoryConcept() {
 
 // D: merges the history of the concept into the current value
 void CConcept::MergeHistory() {
+	notifyDialogStateChanged();
 
     // record the initial value of the concept (if the concept has a grounding
     //  model)
@@ -2507,6 +2671,91 @@ bool CConcept::IsHistoryConcept() {
 	return bHistoryConcept;
 }
 
+//-----------------------------------------------------------------------------
+// Methods for saving and restoring the state of the concept
+//-----------------------------------------------------------------------------
+
+// D: writes the state of the concept to a session record. The values are
+//    kept in the string format used by the assign from string updates, so 
+//    this works for all concept types; only the grounding status of the 
+//    concept itself (not of the items of structures and arrays) is kept
+void CConcept::SaveToRecord(CSessionRecord& rRecord) {
+	rRecord.WriteString(sName);
+
+	// the history values, oldest first
+	vector<CConcept*> vpcHistory;
+	for(CConcept* pcHistory = pPrevConcept; pcHistory != NULL; 
+		pcHistory = pcHistory->pPrevConcept)
+		vpcHistory.insert(vpcHistory.begin(), pcHistory);
+	rRecord.WriteInt((int)vpcHistory.size());
+	for(unsigned int i = 0; i < vpcHistory.size(); i++) {
+		rRecord.WriteBool(vpcHistory[i]->IsUpdated());
+		if(vpcHistory[i]->IsUpdated())
+			rRecord.WriteString(TrimRight(vpcHistory[i]->HypSetToString()));
+	}
+
+	// the current value
+	rRecord.WriteBool(IsUpdated());
+	if(IsUpdated())
+		rRecord.WriteString(TrimRight(HypSetToString()));
+
+	// and the status information
+	rRecord.WriteBool(bGrounded);
+	rRecord.WriteBool(bInvalidated);
+	rRecord.WriteBool(bRestoredForGrounding);
+	rRecord.WriteBool(bSealed);
+	rRecord.WriteInt(iTurnLastUpdated);
+	rRecord.WriteInt(cConveyance);
+	rRecord.WriteString(sExplicitlyConfirmedHyp);
+	rRecord.WriteString(sExplicitlyDisconfirmedHyp);
+}
+
+// D: restores the state of the concept from a session record. The concept
+//    is rebuilt through the regular updates, with change notifications
+//    disabled so that no grounding gets requested, and the status flags are
+//    set afterwards (the updates reset them)
+bool CConcept::LoadFromRecord(CSessionRecord& rRecord) {
+	notifyDialogStateChanged();
+	if(!rRecord.Expect(sName))
+		return false;
+
+	bool bAChangeNotification = bChangeNotification;
+	DisableChangeNotification();
+	Clear();
+
+	// rebuild the history, by reopening each value in turn
+	int iHistorySize = rRecord.ReadInt();
+	for(int i = 0; rRecord.IsValid() && (i < iHistorySize); i++) {
+		if(rRecord.ReadBool()) {
+			string sValue = rRecord.ReadString();
+			Update(CU_ASSIGN_FROM_STRING, &sValue);
+		}
+		ReOpen();
+	}
+
+	// the current value
+	if(rRecord.ReadBool()) {
+		string sValue = rRecord.ReadString();
+		Update(CU_ASSIGN_FROM_STRING, &sValue);
+	}
+
+	// and the status information
+	SetGroundedFlag(rRecord.ReadBool());
+	SetInvalidatedFlag(rRecord.ReadBool());
+	SetRestoredForGroundingFlag(rRecord.ReadBool());
+	if(rRecord.ReadBool())
+		Seal();
+	else 
+		BreakSeal();
+	SetTurnLastUpdated(rRecord.ReadInt());
+	SetConveyance((TConveyance)rRecord.ReadInt());
+	SetExplicitlyConfirmedHyp(rRecord.ReadString());
+	SetExplicitlyDisconfirmedHyp(rRecord.ReadString());
+
+	SetChangeNotification(bAChangeNotification);
+	return rRecord.IsValid();
+}
+
 //-----------------------------------------------------------------------------
 // Virtual methods that are array-specific
 //-----------------------------------------------------------------------------
@@ -2521,6 +2770,7 @@ int CConcept::GetSize() {
 
 // D: DeleteAt method
 void CConcept::DeleteAt(unsigned int iIndex) {
+	notifyDialogStateChanged();
 	FatalError(FormatString("DeleteAt cannot be called on concept %s (%s type).",
 					   sName.c_str(), 
 					   ConceptTypeAsString[ctConceptType].c_str()));
@@ -2528,6 +2778,7 @@ void CConcept::DeleteAt(unsigned int iIndex) {
 
 // J: InsertAt method
 void CConcept::InsertAt(unsigned int iIndex, CConcept &rAConcept) {
+	notifyDialogStateChanged();
 	FatalError(FormatString("InsertAt cannot be called on concept %s (%s type).",
 					   sName.c_str(), 
 					   ConceptTypeAsString[ctConceptType].c_str()));
@@ -50,6 +50,13 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  added operator new and delete on CHyp, which 
+//                           reuse the memory of the deleted hypotheses, and
+//                           the hypothesis allocation counters
+//   [2026-10-18] (agent):  added operator new and delete, so that concepts
+//                           can be placed in a dialog tree arena
+//   [2026-10-18] (agent):  added SaveToRecord and LoadFromRecord, for session
+//                           hibernation
 //   [2006-06-15] (antoine): merged with Calista belief updating framework
 //							 (from RavenClaw 1)
 //	 [2005-11-07] (antoine): added support for partial concept update
@@ -112,6 +119,8 @@
 #include "Utils/Utils.h"
 #include "DMCore/Grounding/Grounding.h"
 
+class CSessionRecord;
+
 //-----------------------------------------------------------------------------
 // Definitions of concept types
 //-----------------------------------------------------------------------------
@@ -145,6 +154,15 @@ static string ConveyanceAsString[] = {"Conveyed", "Not conveyed", "Failed"};
 #define INVALIDATED_CONCEPT "<INVALIDATED>\n"
 #define UNDEFINED_VALUE "<UNDEF_VAL>"
 
+// D: counters of the allocations made for concept hypotheses on a thread
+typedef struct {
+	int iHypsAllocated;				// hypotheses allocated on the heap
+	int iHypsReused;				// hypotheses placed in the memory of 
+									//  deleted ones
+	int iHypsReleased;				// hypotheses deleted (their memory kept
+									//  for reuse, or freed)
+} THypAllocationCounters;
+
 //-----------------------------------------------------------------------------
 // CHyp class - this is the base class for the hierarchy of hypothesis
 //              classes. It essentially implements a type and an associated 
@@ -171,6 +189,20 @@ public:
 	CHyp(CHyp& rAHyp);
 	virtual ~CHyp();
 
+    // allocation: the memory of the deleted hypotheses is kept (per 
+    // thread, and by size, so in effect by hypothesis type) and reused for
+    // the next ones, instead of going back to the heap every time
+    static void* operator new(size_t stSize);
+    static void operator delete(void* pMemory, size_t stSize);
+
+	// Enables or disables the reuse (for all the threads); when disabled,
+	// hypotheses are allocated and freed on the heap
+	static void SetUseHypPool(bool bAUseHypPool);
+	static bool GetUseHypPool();
+
+	// Returns the allocation counters of the calling thread
+	static THypAllocationCounters GetAllocationCounters();
+
     //---------------------------------------------------------------------
 	// Access to member variables
 	//---------------------------------------------------------------------
@@ -341,6 +373,11 @@ public:
     // virtual destructor
 	virtual ~CConcept();
 
+    // allocation: the concepts of a dialog tree cloned from the dialog 
+    // tree image are placed in the session's arena (see DialogTreeArena.h)
+    static void* operator new(size_t stSize);
+    static void operator delete(void* pObject);
+
     //---------------------------------------------------------------------
 	// Methods for overall concept manipulation
 	//---------------------------------------------------------------------
@@ -801,6 +838,19 @@ public:
 	virtual void SetHistoryConcept(bool bAHistoryConcept = true);
 	virtual bool IsHistoryConcept();
 
+	//---------------------------------------------------------------------
+	// Methods for saving and restoring the state of the concept (used when
+	// dialog sessions are hibernated)
+	//---------------------------------------------------------------------
+
+	// write the current hypotheses, the history values and the status 
+	// flags of the concept to a session record
+	virtual void SaveToRecord(CSessionRecord& rRecord);
+
+	// restore the concept from a session record; returns false if the 
+	// record does not describe this concept
+	virtual bool LoadFromRecord(CSessionRecord& rRecord);
+
 	//---------------------------------------------------------------------
 	// Methods that are array-specific and will be implemented by arrays
 	//---------------------------------------------------------------------
@@ -50,6 +50,9 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  moved core creation/destruction into the
+//                           CDialogSession class; the thread now runs a
+//                           single session
 //   [2003-05-13] (dbohus): changed so that configuration parameters are in a 
 //                           hash, which gets also logged
 //   [2003-02-14] (dbohus): added pGroundingManager agent
@@ -64,163 +67,16 @@
 #include "DialogTask/DialogTask.h"
 //#include "Parse/Parse_text.h"
 //-----------------------------------------------------------------------------
-// Definitions for the dialog core agents
+// Definitions for the dialog core agents (thread-local, they point to the 
+// agents of the dialog session bound to the calling thread)
 //-----------------------------------------------------------------------------
-CDMCoreAgent			*pDMCore;
-COutputManagerAgent		*pOutputManager;
-CInteractionEventManagerAgent	*pInteractionEventManager;
-CTrafficManagerAgent	*pTrafficManager;
-CStateManagerAgent		*pStateManager;
-CDTTManagerAgent		*pDTTManager;
-CGroundingManagerAgent  *pGroundingManager;
-
-//-----------------------------------------------------------------------------
-// Dialog core initialization
-//-----------------------------------------------------------------------------
-void InitializeDialogCore() {
-
-	// Log the core initialization parameters
-	/*Log(CORETHREAD_STREAM, "Initializing Core ...");*/
-   /* Log(CORETHREAD_STREAM, "Core initialization parameters dumped below:\n%s",*/
-        //rcpParams.ToString().c_str());
-
-	// Initialize the random number gererator
-	//_timeb theTime = GetTime();
-	//srand((unsigned)(theTime.millitm + theTime.time*1000));
-
-	// Create a new Dialog Management Core Agent, and register it
-	AgentsRegistry.Clear();
-	AgentsRegistry.RegisterAgentType("CDMCoreAgent", 
-									  CDMCoreAgent::AgentFactory);
-	pDMCore = (CDMCoreAgent*)AgentsRegistry.CreateAgent("CDMCoreAgent", 
-														"DMCoreAgent");
-	if(!pDMCore) 
-		FatalError("Could not create DMCore agent.");
-	pDMCore->Initialize();
-	pDMCore->Register();
-    //根据参数来初始化，暂时注释
-    // set the default core configuration 
-   /* pDMCore->SetDefaultTimeoutPeriod(*/
-        //atoi(rcpParams.Get(RCP_DEFAULT_TIMEOUT).c_str()));
-    //pDMCore->SetDefaultNonunderstandingThreshold(
-        //(float)atof(
-        //rcpParams.Get(RCP_DEFAULT_NONUNDERSTANDING_THRESHOLD).c_str()));
-
-	// create all the other dialog core agents
-	Log(CORETHREAD_STREAM, "Creating auxiliary core dialog core agents ...");
-
-	// create the interaction event manager
-	AgentsRegistry.RegisterAgentType("CInteractionEventManagerAgent", 
-									 CInteractionEventManagerAgent::AgentFactory);
-	pInteractionEventManager = (CInteractionEventManagerAgent *)
-					AgentsRegistry.CreateAgent("CInteractionEventManagerAgent", 
-											   "InteractionEventManagerAgent");
-	if(!pInteractionEventManager) 
-		FatalError("Could not create InteractionEventManager agent.");
-	pInteractionEventManager->Initialize();
-	pInteractionEventManager->Register();
-
-	// create the output manager
-	AgentsRegistry.RegisterAgentType("COutputManagerAgent", 
-									 COutputManagerAgent::AgentFactory);
-	pOutputManager = (COutputManagerAgent *)
-					AgentsRegistry.CreateAgent("COutputManagerAgent", 
-											   "OutputManagerAgent");
-	if(!pOutputManager) 
-		FatalError("Could not create OutputManager agent.");
-	pOutputManager->Initialize();
-	pOutputManager->Register();
-
-	// create the galaxy stub
-	AgentsRegistry.RegisterAgentType("CTrafficManagerAgent", 
-									 CTrafficManagerAgent::AgentFactory);
-	pTrafficManager = (CTrafficManagerAgent *)
-					AgentsRegistry.CreateAgent("CTrafficManagerAgent", 
-											   "TrafficManagerAgent");
-	if(!pTrafficManager) 
-		FatalError("Could not create TrafficManager agent.");
-	pTrafficManager->Initialize();
-	pTrafficManager->Register();
-
-	// create the state manager
-	AgentsRegistry.RegisterAgentType("CStateManagerAgent", 
-									 CStateManagerAgent::AgentFactory);
-	pStateManager = (CStateManagerAgent *)
-					AgentsRegistry.CreateAgent("CStateManagerAgent", 
-											   "StateManagerAgent");
-	if(!pStateManager) 
-		FatalError("Could not create StateManager agent.");
-	pStateManager->Initialize();
-	pStateManager->Register();
-    // set the state broadcast address
-	//pStateManager->LoadDialogStateNames(rcpParams.Get(RCP_DIALOG_STATES_FILE));
-
-	// create the dialog task tree manager
-	AgentsRegistry.RegisterAgentType("CDTTManagerAgent", 
-									 CDTTManagerAgent::AgentFactory);
-	pDTTManager = (CDTTManagerAgent *)
-					AgentsRegistry.CreateAgent("CDTTManagerAgent", 
-											   "DTTManagerAgent");
-	if(!pDTTManager) 
-		FatalError("Could not create DTTManager agent.");
-	pDTTManager->Initialize();
-	pDTTManager->Register();
-
-	// create the grounding manager
-	AgentsRegistry.RegisterAgentType("CGroundingManagerAgent", 
-									 CGroundingManagerAgent::AgentFactory);
-	pGroundingManager = (CGroundingManagerAgent *)
-					      AgentsRegistry.CreateAgent("CGroundingManagerAgent", 
-											         "GroundingManagerAgent");
-	if(!pGroundingManager) 
-		FatalError("Could not create GroundingManager agent.");
-	pGroundingManager->Initialize();
-	pGroundingManager->Register();    
-    // set the configuration
-    // 暂时注释
-   /* pGroundingManager->SetConfiguration(*/
-        //rcpParams.Get(RCP_GROUNDING_MANAGER_CONFIGURATION));
-    //// and load the models specifications from the grounding policies file
-	//if (rcpParams.Get(RCP_GROUNDING_POLICIES) != "") 
-		//pGroundingManager->LoadPoliciesFromString(rcpParams.Get(RCP_GROUNDING_POLICIES));
-	//else
-		//pGroundingManager->LoadPoliciesFromFile(rcpParams.Get(RCP_GROUNDING_POLICIES_FILE));
-
-    Log(CORETHREAD_STREAM, "Auxiliary core dialog management agents "\
-						   "created successfully.");
-
-	Log(CORETHREAD_STREAM, "Core initialization completed successfully.");
-}
-
-//-----------------------------------------------------------------------------
-// Dialog core termination
-//-----------------------------------------------------------------------------
-void TerminateDialogCore() {
-	Log(CORETHREAD_STREAM, "Terminating Core ...");
-
-	// destroy the core dialog management agent
-	delete pDMCore;
-	pDMCore = NULL;
-	// and all the other core agents
-	delete pDTTManager;
-	pDTTManager = NULL;
-	delete pTrafficManager;
-	pTrafficManager = NULL;
-	delete pOutputManager;
-	pOutputManager = NULL;
-	delete pInteractionEventManager;
-	pInteractionEventManager = NULL;
-	delete pStateManager;
-	pStateManager = NULL;
-    delete pGroundingManager;
-	pGroundingManager = NULL;
-
-	// and finally clear up the registry
-	AgentsRegistry.Clear();
-
-    // and log that the core terminated successfully
-	Log(CORETHREAD_STREAM, "Core terminated successfully.");
-}
+thread_local CDMCoreAgent			*pDMCore = NULL;
+thread_local COutputManagerAgent		*pOutputManager = NULL;
+thread_local CInteractionEventManagerAgent	*pInteractionEventManager = NULL;
+thread_local CTrafficManagerAgent	*pTrafficManager = NULL;
+thread_local CStateManagerAgent		*pStateManager = NULL;
+thread_local CDTTManagerAgent		*pDTTManager = NULL;
+thread_local CGroundingManagerAgent  *pGroundingManager = NULL;
 
 //-----------------------------------------------------------------------------
 // THE DIALOG CORE THREAD FUNCTION
@@ -240,17 +96,14 @@ int DialogCoreThread() {
  /* Log(CORETHREAD_STREAM, "Olympus Branch: %s\nOlympus Revision: %s", */
 		//OLYMPUS_SVN_BRANCH, OLYMPUS_SVN_REVISION);
 
-	// Initialize the core: create all the core agents
-	InitializeDialogCore();	
-
-	// Call the dialog task initialize function 
-	DialogTaskOnBeginSession();
+	// Create a dialog session: this creates all the core agents
+	CDialogSession *pSession = CreateDialogSession(1);
 
 	// Do the dialog dance :)
-	pDMCore->Execute();
+	pSession->Execute();
 
-	// Terminate the dialog core
-	TerminateDialogCore();
+	// Terminate the dialog session
+	DestroyDialogSession(pSession);
 
   ShutdownLog();
 	// Finally, send a message to signal that this session of the 
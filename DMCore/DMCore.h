@@ -50,6 +50,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the core agent pointers are now thread-local and
+//                           bound to the current dialog session
 //   [2003-05-13] (dbohus): changed so that configuration parameters are in a 
 //                           hash, which gets also logged
 //   [2003-02-14] (dbohus): added pGroundingManager agent
@@ -66,19 +68,23 @@
 //#include <windows.h>
 #include "Utils/Utils.h"
 #include "Agents/CoreAgents/AllCoreAgents.h"
+#include "DialogSession.h"
 
 //-----------------------------------------------------------------------------
 // Declarations for the core dialog management agents
 //-----------------------------------------------------------------------------
-extern CDMCoreAgent			    *pDMCore;
-extern COutputManagerAgent	    *pOutputManager;
-extern CInteractionEventManagerAgent		*pInteractionEventManager;
-extern CTrafficManagerAgent	    *pTrafficManager;
-extern CStateManagerAgent	    *pStateManager;
-extern CDTTManagerAgent		    *pDTTManager;
-extern CGroundingManagerAgent   *pGroundingManager;
+// the core agents of the dialog session bound to the calling thread (see 
+// DialogSession.h)
+extern thread_local CDMCoreAgent			    *pDMCore;
+extern thread_local COutputManagerAgent	    *pOutputManager;
+extern thread_local CInteractionEventManagerAgent		*pInteractionEventManager;
+extern thread_local CTrafficManagerAgent	    *pTrafficManager;
+extern thread_local CStateManagerAgent	    *pStateManager;
+extern thread_local CDTTManagerAgent		    *pDTTManager;
+extern thread_local CGroundingManagerAgent   *pGroundingManager;
 
 // D: the main thread of the dialog core
 int DialogCoreThread();
 
+
 #endif // __DMCORE_H__
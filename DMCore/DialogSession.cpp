@@ -0,0 +1,614 @@
+//=============================================================================
+//
+//   Copyright (c) 2000-2004, Carnegie Mellon University.  
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions
+//   are met:
+//
+//   1. Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer. 
+//
+//   2. Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//   This work was supported in part by funding from the Defense Advanced 
+//   Research Projects Agency and the National Science Foundation of the 
+//   United States of America, and the CMU Sphinx Speech Consortium.
+//
+//   THIS SOFTWARE IS PROVIDED BY CARNEGIE MELLON UNIVERSITY ``AS IS'' AND 
+//   ANY EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+//   THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//   PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL CARNEGIE MELLON UNIVERSITY
+//   NOR ITS EMPLOYEES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+//   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+//   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// 
+// DIALOGSESSION.CPP - implementation of the CDialogSession class
+// 
+// ----------------------------------------------------------------------------
+// 
+// BEFORE MAKING CHANGES TO THIS CODE, please read the appropriate 
+// documentation, available in the Documentation folder. 
+//
+// ANY SIGNIFICANT CHANGES made should be reflected back in the documentation
+// file(s)
+//
+// ANY CHANGES made (even small bug fixes, should be reflected in the history
+// below, in reverse chronological order
+// 
+// HISTORY --------------------------------------------------------------------
+//
+//   [2026-10-18] (agent):  Restore ends only the session on a corrupted 
+//                           record, instead of stopping with a fatal error
+//   [2026-10-18] (agent):  Step logs the concept hypothesis allocations of
+//                           the turn
+//   [2026-10-18] (agent):  session records moved to version 2 (the state 
+//                           history starts with the index of its first state)
+//   [2026-10-18] (agent):  Step logs the interaction event allocations of
+//                           the turn; stale timeouts go back to the pool
+//   [2026-10-18] (agent):  added Hibernate and Restore, for keeping idle 
+//                           sessions on disk instead of in memory
+//   [2026-10-18] (agent):  turn timeouts are timed on a (shared) timing wheel
+//   [2026-10-18] (agent):  sessions own a mailbox in the session router
+//   [2026-10-18] (agent):  added Step, for driving sessions without blocking
+//   [2026-10-18] (agent):  started working on this, moved the core creation
+//                           and destruction code over from DMCore.cpp
+// 
+//-----------------------------------------------------------------------------
+
+#include "DialogSession.h"
+#include "DMCore/Core.h"
+#include "DMCore/SessionRecord.h"
+#include "DialogTask/DialogTask.h"
+
+#include <cstdio>
+
+// tag and version at the beginning of the session record files
+#define SESSION_RECORD_TAG		"RavenClawSession"
+#define SESSION_RECORD_VERSION	2
+
+// the session currently bound to the calling thread
+thread_local CDialogSession *CDialogSession::pCurrentSession = NULL;
+
+//-----------------------------------------------------------------------------
+// Constructor and destructor
+//-----------------------------------------------------------------------------
+
+// constructor
+CDialogSession::CDialogSession(int iASessionID): tTurnTimeout(iASessionID) {
+	iSessionID = iASessionID;
+	bInitialized = false;
+	bHibernated = false;
+	ptwTimeoutWheel = NULL;
+	pSessionDMCore = NULL;
+	pSessionOutputManager = NULL;
+	pSessionInteractionEventManager = NULL;
+	pSessionTrafficManager = NULL;
+	pSessionStateManager = NULL;
+	pSessionDTTManager = NULL;
+	pSessionGroundingManager = NULL;
+	eacLastTurnAllocations = TEventAllocationCounters();
+	hacLastTurnAllocations = THypAllocationCounters();
+}
+
+// destructor: terminates the session if that was not done already
+CDialogSession::~CDialogSession() {
+	if(bInitialized || bHibernated)
+		Terminate();
+	SetTimeoutWheel(NULL);
+}
+
+//-----------------------------------------------------------------------------
+// Session lifetime
+//-----------------------------------------------------------------------------
+
+// creates all the core agents of the session
+void CDialogSession::Initialize() {
+	if(bInitialized) {
+		Warning(FormatString("Session %d is already initialized.", 
+			iSessionID));
+		return;
+	}
+
+	// the agents get created in (and register with) this session
+	CDialogSessionBinding dsbBinding(this);
+
+	Log(CORETHREAD_STREAM, "Initializing Core for session %d ...", iSessionID);
+
+	// Create a new Dialog Management Core Agent, and register it
+	AgentsRegistry.Clear();
+	AgentsRegistry.RegisterAgentType("CDMCoreAgent", 
+									  CDMCoreAgent::AgentFactory);
+	pDMCore = (CDMCoreAgent*)AgentsRegistry.CreateAgent("CDMCoreAgent", 
+														"DMCoreAgent");
+	if(!pDMCore) 
+		FatalError("Could not create DMCore agent.");
+	pDMCore->Initialize();
+	pDMCore->Register();
+
+	// create all the other dialog core agents
+	Log(CORETHREAD_STREAM, "Creating auxiliary core dialog core agents ...");
+
+	// create the interaction event manager
+	AgentsRegistry.RegisterAgentType("CInteractionEventManagerAgent", 
+									 CInteractionEventManagerAgent::AgentFactory);
+	pInteractionEventManager = (CInteractionEventManagerAgent *)
+					AgentsRegistry.CreateAgent("CInteractionEventManagerAgent", 
+											   "InteractionEventManagerAgent");
+	if(!pInteractionEventManager) 
+		FatalError("Could not create InteractionEventManager agent.");
+	pInteractionEventManager->Initialize();
+	pInteractionEventManager->Register();
+
+	// create the output manager
+	AgentsRegistry.RegisterAgentType("COutputManagerAgent", 
+									 COutputManagerAgent::AgentFactory);
+	pOutputManager = (COutputManagerAgent *)
+					AgentsRegistry.CreateAgent("COutputManagerAgent", 
+											   "OutputManagerAgent");
+	if(!pOutputManager) 
+		FatalError("Could not create OutputManager agent.");
+	pOutputManager->Initialize();
+	pOutputManager->Register();
+
+	// create the galaxy stub
+	AgentsRegistry.RegisterAgentType("CTrafficManagerAgent", 
+									 CTrafficManagerAgent::AgentFactory);
+	pTrafficManager = (CTrafficManagerAgent *)
+					AgentsRegistry.CreateAgent("CTrafficManagerAgent", 
+											   "TrafficManagerAgent");
+	if(!pTrafficManager) 
+		FatalError("Could not create TrafficManager agent.");
+	pTrafficManager->Initialize();
+	pTrafficManager->Register();
+
+	// create the state manager
+	AgentsRegistry.RegisterAgentType("CStateManagerAgent", 
+									 CStateManagerAgent::AgentFactory);
+	pStateManager = (CStateManagerAgent *)
+					AgentsRegistry.CreateAgent("CStateManagerAgent", 
+											   "StateManagerAgent");
+	if(!pStateManager) 
+		FatalError("Could not create StateManager agent.");
+	pStateManager->Initialize();
+	pStateManager->Register();
+
+	// create the dialog task tree manager
+	AgentsRegistry.RegisterAgentType("CDTTManagerAgent", 
+									 CDTTManagerAgent::AgentFactory);
+	pDTTManager = (CDTTManagerAgent *)
+					AgentsRegistry.CreateAgent("CDTTManagerAgent", 
+											   "DTTManagerAgent");
+	if(!pDTTManager) 
+		FatalError("Could not create DTTManager agent.");
+	pDTTManager->Initialize();
+	pDTTManager->Register();
+
+	// create the grounding manager
+	AgentsRegistry.RegisterAgentType("CGroundingManagerAgent", 
+									 CGroundingManagerAgent::AgentFactory);
+	pGroundingManager = (CGroundingManagerAgent *)
+					      AgentsRegistry.CreateAgent("CGroundingManagerAgent", 
+											         "GroundingManagerAgent");
+	if(!pGroundingManager) 
+		FatalError("Could not create GroundingManager agent.");
+	pGroundingManager->Initialize();
+	pGroundingManager->Register();    
+
+	Log(CORETHREAD_STREAM, "Auxiliary core dialog management agents "\
+						   "created successfully.");
+
+	// keep the agents with the session, so that they can be rebound later
+	saveCoreAgents();
+	bInitialized = true;
+
+	// open the message queues of the session (unless the session is 
+	// coming out of hibernation, and already has them)
+	if(!spMailbox)
+		spMailbox = session_router.open(iSessionID);
+
+	Log(CORETHREAD_STREAM, "Core initialization completed successfully.");
+}
+
+// destroys all the core agents of the session
+void CDialogSession::Terminate() {
+	if(!bInitialized && !bHibernated)
+		return;
+
+	CDialogSessionBinding dsbBinding(this);
+
+	Log(CORETHREAD_STREAM, "Terminating Core for session %d ...", iSessionID);
+
+	// nobody is waiting for input anymore
+	CancelTurnTimeout();
+
+	if(bHibernated) {
+		// the session is not coming back; drop its record
+		remove(sHibernationFile.c_str());
+		bHibernated = false;
+	} else 
+		destroyCore();
+
+	// and close the message queues of the session
+	session_router.close(iSessionID);
+	spMailbox.reset();
+
+	// and log that the core terminated successfully
+	Log(CORETHREAD_STREAM, "Core terminated successfully.");
+}
+
+// destroys the core agents and the dialog task tree of the session
+void CDialogSession::destroyCore() {
+	// destroy the core dialog management agent
+	delete pDMCore;
+	pDMCore = NULL;
+	// and all the other core agents
+	delete pDTTManager;
+	pDTTManager = NULL;
+	delete pTrafficManager;
+	pTrafficManager = NULL;
+	delete pOutputManager;
+	pOutputManager = NULL;
+	delete pInteractionEventManager;
+	pInteractionEventManager = NULL;
+	delete pStateManager;
+	pStateManager = NULL;
+	delete pGroundingManager;
+	pGroundingManager = NULL;
+
+	// and finally clear up the registry
+	AgentsRegistry.Clear();
+
+	saveCoreAgents();
+	bInitialized = false;
+}
+
+// runs the dialog task of the session until it completes
+void CDialogSession::Execute() {
+	if(bHibernated && !Restore())
+		FatalError(FormatString("Cannot restore hibernated session %d.", 
+			iSessionID));
+	if(!bInitialized)
+		FatalError(FormatString("Cannot execute uninitialized session %d.", 
+			iSessionID));
+
+	CDialogSessionBinding dsbBinding(this);
+
+	// Call the dialog task initialize function 
+	if(pDMCore->GetLoopState() == clsNotStarted)
+		DialogTaskOnBeginSession();
+
+	// Do the dialog dance :)
+	pDMCore->Execute();
+}
+
+// runs the dialog task of the session until it needs the next event
+bool CDialogSession::Step(CInteractionEvent *pieEvent) {
+	if(!bInitialized && !bHibernated)
+		FatalError(FormatString("Cannot step uninitialized session %d.", 
+			iSessionID));
+
+	CDialogSessionBinding dsbBinding(this);
+
+	// drop timeouts for turns that are already over
+	if(IsStaleTurnTimeout(pieEvent)) {
+		Log(CORETHREAD_STREAM, "Ignoring stale turn timeout for session %d.",
+			iSessionID);
+		CInteractionEvent::Release(pieEvent);
+		return !HasFinished();
+	}
+
+	// bring the session back from disk if it was hibernated; if its record
+	// is gone, the dialog cannot go on
+	if(bHibernated && !Restore()) {
+		Warning(FormatString("Cannot restore hibernated session %d, ending "
+			"it.", iSessionID));
+		CInteractionEvent::Release(pieEvent);
+		return false;
+	}
+
+	// Call the dialog task initialize function before the first step
+	if(pDMCore->GetLoopState() == clsNotStarted)
+		DialogTaskOnBeginSession();
+
+	TEventAllocationCounters eacBefore = 
+		CInteractionEvent::GetAllocationCounters();
+	THypAllocationCounters hacBefore = CHyp::GetAllocationCounters();
+	bool bWaiting = (pDMCore->Step(pieEvent) == csrcWaitForEvent);
+
+	// keep track of the events allocated during the turn
+	TEventAllocationCounters eacAfter = 
+		CInteractionEvent::GetAllocationCounters();
+	eacLastTurnAllocations.iEventsAllocated = 
+		eacAfter.iEventsAllocated - eacBefore.iEventsAllocated;
+	eacLastTurnAllocations.iEventsReused = 
+		eacAfter.iEventsReused - eacBefore.iEventsReused;
+	eacLastTurnAllocations.iEventsReleased = 
+		eacAfter.iEventsReleased - eacBefore.iEventsReleased;
+	eacLastTurnAllocations.iBufferAllocations = 
+		eacAfter.iBufferAllocations - eacBefore.iBufferAllocations;
+	Log(CORETHREAD_STREAM, "Session %d turn events: %d allocated, %d reused,"
+		" %d released, %d buffer allocations.", iSessionID, 
+		eacLastTurnAllocations.iEventsAllocated, 
+		eacLastTurnAllocations.iEventsReused,
+		eacLastTurnAllocations.iEventsReleased, 
+		eacLastTurnAllocations.iBufferAllocations);
+
+	// and the hypotheses
+	THypAllocationCounters hacAfter = CHyp::GetAllocationCounters();
+	hacLastTurnAllocations.iHypsAllocated = 
+		hacAfter.iHypsAllocated - hacBefore.iHypsAllocated;
+	hacLastTurnAllocations.iHypsReused = 
+		hacAfter.iHypsReused - hacBefore.iHypsReused;
+	hacLastTurnAllocations.iHypsReleased = 
+		hacAfter.iHypsReleased - hacBefore.iHypsReleased;
+	Log(CORETHREAD_STREAM, "Session %d turn hypotheses: %d allocated, %d "
+		"reused, %d released.", iSessionID, 
+		hacLastTurnAllocations.iHypsAllocated, 
+		hacLastTurnAllocations.iHypsReused,
+		hacLastTurnAllocations.iHypsReleased);
+
+	return bWaiting;
+}
+
+// indicates if the dialog task of the session has completed
+bool CDialogSession::HasFinished() {
+	if(bHibernated)
+		return false;
+	return !bInitialized || 
+		(pSessionDMCore->GetLoopState() == clsFinished);
+}
+
+// returns the interaction event allocations made during the last step
+TEventAllocationCounters CDialogSession::GetLastTurnEventAllocations() {
+	return eacLastTurnAllocations;
+}
+
+// returns the concept hypothesis allocations made during the last step
+THypAllocationCounters CDialogSession::GetLastTurnHypAllocations() {
+	return hacLastTurnAllocations;
+}
+
+//-----------------------------------------------------------------------------
+// Hibernation
+//-----------------------------------------------------------------------------
+
+// writes the state of the session to disk and frees its core
+bool CDialogSession::Hibernate(string sRecordFileName) {
+	if(!bInitialized || bHibernated || 
+		(pSessionDMCore->GetLoopState() != clsWaitingForEvent))
+		return false;
+
+	CDialogSessionBinding dsbBinding(this);
+
+	// events that were queued but not processed yet would be lost
+	if(pInteractionEventManager->HasEvent())
+		return false;
+
+	// the dialog task tree goes first: the core refers to its agents and 
+	// concepts by name, and they have to exist when it gets restored
+	CSessionRecord srRecord;
+	srRecord.WriteString(SESSION_RECORD_TAG);
+	srRecord.WriteInt(SESSION_RECORD_VERSION);
+	if(!pDTTManager->GetDialogTaskTreeRoot()->SaveToRecord(srRecord) ||
+		!pDMCore->SaveToRecord(srRecord))
+		return false;
+	pStateManager->SaveToRecord(srRecord);
+	pInteractionEventManager->SaveToRecord(srRecord);
+	pOutputManager->SaveToRecord(srRecord);
+
+	if(!srRecord.SaveToFile(sRecordFileName)) {
+		Warning(FormatString("Could not write session record %s for session "
+			"%d.", sRecordFileName.c_str(), iSessionID));
+		return false;
+	}
+
+	Log(CORETHREAD_STREAM, "Hibernating session %d (%d bytes in %s).", 
+		iSessionID, srRecord.GetSize(), sRecordFileName.c_str());
+
+	destroyCore();
+	sHibernationFile = sRecordFileName;
+	bHibernated = true;
+	return true;
+}
+
+// recreates the core of a hibernated session from its record
+bool CDialogSession::Restore() {
+	if(!bHibernated)
+		return true;
+
+	CSessionRecord srRecord;
+	if(!srRecord.LoadFromFile(sHibernationFile)) {
+		Warning(FormatString("Could not read session record %s for session "
+			"%d.", sHibernationFile.c_str(), iSessionID));
+		return false;
+	}
+
+	bHibernated = false;
+	Initialize();
+
+	CDialogSessionBinding dsbBinding(this);
+
+	Log(CORETHREAD_STREAM, "Restoring session %d from %s ...", iSessionID, 
+		sHibernationFile.c_str());
+
+	// configure the core and create the dialog task tree, like the first
+	// step of the session does, and then load the state on top of them
+	DialogTaskOnBeginSession();
+	pDTTManager->CreateDialogTree();
+	if(!srRecord.Expect(SESSION_RECORD_TAG) || 
+		(srRecord.ReadInt() != SESSION_RECORD_VERSION) ||
+		!pDTTManager->GetDialogTaskTreeRoot()->LoadFromRecord(srRecord) ||
+		!pDMCore->LoadFromRecord(srRecord) ||
+		!pStateManager->LoadFromRecord(srRecord) ||
+		!pInteractionEventManager->LoadFromRecord(srRecord) ||
+		!pOutputManager->LoadFromRecord(srRecord)) {
+		// the session cannot go on, but the other sessions can: drop the 
+		// partly restored core, and leave the record for inspection
+		Warning(FormatString("Corrupted session record %s for session %d.",
+			sHibernationFile.c_str(), iSessionID));
+		destroyCore();
+		return false;
+	}
+
+	remove(sHibernationFile.c_str());
+	sHibernationFile = "";
+
+	Log(CORETHREAD_STREAM, "Session %d restored successfully.", iSessionID);
+	return true;
+}
+
+// indicates if the session is hibernated
+bool CDialogSession::IsHibernated() {
+	return bHibernated;
+}
+
+//-----------------------------------------------------------------------------
+// Access to session information
+//-----------------------------------------------------------------------------
+
+// returns the session id
+int CDialogSession::GetSessionID() {
+	return iSessionID;
+}
+
+// indicates if the core agents of the session exist
+bool CDialogSession::IsInitialized() {
+	return bInitialized;
+}
+
+// returns the mailbox of the session
+session_mailbox *CDialogSession::GetMailbox() {
+	return spMailbox.get();
+}
+
+//-----------------------------------------------------------------------------
+// Turn timeouts
+//-----------------------------------------------------------------------------
+
+// sets the timing wheel used for the turn timeouts of the session
+void CDialogSession::SetTimeoutWheel(timing_wheel *ptwAWheel) {
+	if(ptwTimeoutWheel == ptwAWheel)
+		return;
+	CancelTurnTimeout();
+	ptwTimeoutWheel = ptwAWheel;
+}
+
+// (re)arms the turn timeout of the session
+void CDialogSession::ArmTurnTimeout(int iSeconds) {
+	if(!ptwTimeoutWheel)
+		return;
+	if(iSeconds <= 0)
+		ptwTimeoutWheel->cancel(tTurnTimeout);
+	else 
+		ptwTimeoutWheel->arm(tTurnTimeout, std::chrono::seconds(iSeconds));
+}
+
+// cancels the pending turn timeout of the session
+void CDialogSession::CancelTurnTimeout() {
+	if(ptwTimeoutWheel)
+		ptwTimeoutWheel->cancel(tTurnTimeout);
+}
+
+// checks if an event is a turn timeout that has been superseded; the wheel 
+// stamps the timeouts it fires with the generation of the timer in [timer]
+bool CDialogSession::IsStaleTurnTimeout(CInteractionEvent *pieEvent) {
+	if(!pieEvent || (pieEvent->GetType() != IET_TURN_TIMEOUT) ||
+		!pieEvent->HasProperty("[timer]"))
+		return false;
+	unsigned long ulGeneration = 
+		strtoul(pieEvent->GetStringProperty("[timer]").c_str(), NULL, 10);
+	return ulGeneration != tTurnTimeout.current_generation();
+}
+
+//-----------------------------------------------------------------------------
+// Binding sessions to threads
+//-----------------------------------------------------------------------------
+
+// points the thread-local core names to the agents of a session
+void CDialogSession::Bind(CDialogSession *pSession) {
+	pCurrentSession = pSession;
+	if(pSession) {
+		pAgentsRegistry = &pSession->rAgentsRegistry;
+		pDMCore = pSession->pSessionDMCore;
+		pOutputManager = pSession->pSessionOutputManager;
+		pInteractionEventManager = pSession->pSessionInteractionEventManager;
+		pTrafficManager = pSession->pSessionTrafficManager;
+		pStateManager = pSession->pSessionStateManager;
+		pDTTManager = pSession->pSessionDTTManager;
+		pGroundingManager = pSession->pSessionGroundingManager;
+	} else {
+		pAgentsRegistry = NULL;
+		pDMCore = NULL;
+		pOutputManager = NULL;
+		pInteractionEventManager = NULL;
+		pTrafficManager = NULL;
+		pStateManager = NULL;
+		pDTTManager = NULL;
+		pGroundingManager = NULL;
+	}
+}
+
+// returns the session bound to the calling thread
+CDialogSession *CDialogSession::GetCurrent() {
+	return pCurrentSession;
+}
+
+// copies the thread-local core agent pointers into the session
+void CDialogSession::saveCoreAgents() {
+	pSessionDMCore = pDMCore;
+	pSessionOutputManager = pOutputManager;
+	pSessionInteractionEventManager = pInteractionEventManager;
+	pSessionTrafficManager = pTrafficManager;
+	pSessionStateManager = pStateManager;
+	pSessionDTTManager = pDTTManager;
+	pSessionGroundingManager = pGroundingManager;
+}
+
+//-----------------------------------------------------------------------------
+//
+// CDialogSessionBinding class methods
+//
+//-----------------------------------------------------------------------------
+
+// binds the session, remembering the previous binding
+CDialogSessionBinding::CDialogSessionBinding(CDialogSession *pSession) {
+	pPreviousSession = CDialogSession::GetCurrent();
+	CDialogSession::Bind(pSession);
+}
+
+// restores the previous binding
+CDialogSessionBinding::~CDialogSessionBinding() {
+	CDialogSession::Bind(pPreviousSession);
+}
+
+//-----------------------------------------------------------------------------
+// Session factory functions
+//-----------------------------------------------------------------------------
+
+// creates and initializes a new dialog session
+CDialogSession *CreateDialogSession(int iSessionID) {
+	CDialogSession *pSession = new CDialogSession(iSessionID);
+	pSession->Initialize();
+	return pSession;
+}
+
+// terminates and deallocates a dialog session
+void DestroyDialogSession(CDialogSession *pSession) {
+	if(!pSession)
+		return;
+	pSession->Terminate();
+	delete pSession;
+}
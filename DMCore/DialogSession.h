@@ -0,0 +1,315 @@
+//=============================================================================
+//
+//   Copyright (c) 2000-2004, Carnegie Mellon University.  
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions
+//   are met:
+//
+//   1. Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer. 
+//
+//   2. Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//   This work was supported in part by funding from the Defense Advanced 
+//   Research Projects Agency and the National Science Foundation of the 
+//   United States of America, and the CMU Sphinx Speech Consortium.
+//
+//   THIS SOFTWARE IS PROVIDED BY CARNEGIE MELLON UNIVERSITY ``AS IS'' AND 
+//   ANY EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+//   THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//   PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL CARNEGIE MELLON UNIVERSITY
+//   NOR ITS EMPLOYEES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+//   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+//   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// 
+// DIALOGSESSION.H - definition of the CDialogSession class. A dialog session
+//                   owns a complete dialog core (the core agents, the agents
+//                   registry and the dialog task tree), so that a single 
+//                   process can host many independent conversations
+// 
+// ----------------------------------------------------------------------------
+// 
+// BEFORE MAKING CHANGES TO THIS CODE, please read the appropriate 
+// documentation, available in the Documentation folder. 
+//
+// ANY SIGNIFICANT CHANGES made should be reflected back in the documentation
+// file(s)
+//
+// ANY CHANGES made (even small bug fixes, should be reflected in the history
+// below, in reverse chronological order
+// 
+// HISTORY --------------------------------------------------------------------
+//
+//   [2026-10-18] (agent):  Hibernate refuses sessions running a grounding
+//                           agency, and Restore returns false on a record 
+//                           that does not match the dialog task
+//   [2026-10-18] (agent):  Step keeps the concept hypothesis allocations 
+//                           of the turn too (see GetLastTurnHypAllocations)
+//   [2026-10-18] (agent):  Step keeps the interaction event allocations of
+//                           the turn (see GetLastTurnEventAllocations)
+//   [2026-10-18] (agent):  added Hibernate and Restore, for keeping idle 
+//                           sessions on disk instead of in memory
+//   [2026-10-18] (agent):  turn timeouts are timed on a (shared) timing wheel
+//   [2026-10-18] (agent):  sessions own a mailbox in the session router
+//   [2026-10-18] (agent):  added Step, for driving sessions without blocking
+//   [2026-10-18] (agent):  started working on this
+// 
+//-----------------------------------------------------------------------------
+
+#pragma once
+#ifndef __DIALOGSESSION_H__
+#define __DIALOGSESSION_H__
+
+#include "Utils/Utils.h"
+#include "Agents/Registry.h"
+#include "message/message.h"
+#include "message/timing_wheel.h"
+#include "Events/InteractionEvent.h"
+#include "Concepts/Concept.h"
+
+// forward declarations of the core agent classes
+class CDMCoreAgent;
+class COutputManagerAgent;
+class CInteractionEventManagerAgent;
+class CTrafficManagerAgent;
+class CStateManagerAgent;
+class CDTTManagerAgent;
+class CGroundingManagerAgent;
+
+//-----------------------------------------------------------------------------
+//
+// CDialogSession class - holds everything a single conversation needs. The 
+//   rest of the code accesses the core through the pDMCore, pStateManager, 
+//   ..., AgentsRegistry names; these are thread-local and point into the 
+//   session that is currently bound to the calling thread (see Bind). A 
+//   session can be bound to only one thread at a time, but it does not
+//   matter which thread that is.
+//
+//-----------------------------------------------------------------------------
+
+class CDialogSession {
+
+private:
+	//---------------------------------------------------------------------
+	// Private members
+	//---------------------------------------------------------------------
+
+	// the integer id for this session
+	int iSessionID;
+
+	// indicates if the core agents have been created
+	bool bInitialized;
+
+	// indicates if the session is hibernated, i.e. its core agents and 
+	// dialog task tree were freed and its state lives in a session record 
+	// on disk (in sHibernationFile), until the next step restores it
+	bool bHibernated;
+	string sHibernationFile;
+
+	// the registry holding all the agents (core and dialog task agents)
+	// of this session
+	CRegistry rAgentsRegistry;
+
+	// the inbound and outbound message queues of this session (kept by 
+	// the session router)
+	std::shared_ptr<session_mailbox> spMailbox;
+
+	// the wheel timing the turn timeouts of this session (set by whoever
+	// drives the session, NULL if there is none), and the timer this 
+	// session keeps on it
+	timing_wheel *ptwTimeoutWheel;
+	timing_wheel::timer tTurnTimeout;
+
+	// the interaction event and concept hypothesis allocations made during
+	// the last step
+	TEventAllocationCounters eacLastTurnAllocations;
+	THypAllocationCounters hacLastTurnAllocations;
+
+	// the core agents of this session
+	CDMCoreAgent *pSessionDMCore;
+	COutputManagerAgent *pSessionOutputManager;
+	CInteractionEventManagerAgent *pSessionInteractionEventManager;
+	CTrafficManagerAgent *pSessionTrafficManager;
+	CStateManagerAgent *pSessionStateManager;
+	CDTTManagerAgent *pSessionDTTManager;
+	CGroundingManagerAgent *pSessionGroundingManager;
+
+	// the session currently bound to the calling thread
+	static thread_local CDialogSession *pCurrentSession;
+
+public:
+	//---------------------------------------------------------------------
+	// Constructor and destructor
+	//---------------------------------------------------------------------
+	//
+	CDialogSession(int iASessionID);
+	virtual ~CDialogSession();
+
+	//---------------------------------------------------------------------
+	// Session lifetime
+	//---------------------------------------------------------------------
+
+	// Creates the core agents of the session
+	//
+	void Initialize();
+
+	// Destroys the core agents (and the dialog task tree) of the session
+	//
+	void Terminate();
+
+	// Runs the dialog task of this session until it completes, blocking
+	// the calling thread while waiting for interaction events
+	//
+	void Execute();
+
+	// Runs the dialog task of this session until it needs the next 
+	// interaction event, and returns (see CDMCoreAgent::Step). Returns 
+	// true while the dialog is still going on, and false if it completed 
+	// or the session was hibernated and cannot be restored
+	//
+	bool Step(CInteractionEvent *pieEvent = NULL);
+
+	// Indicates if the dialog task of this session has completed
+	//
+	bool HasFinished();
+
+	// Returns the interaction event allocations (and pool reuses) made 
+	// during the last step, on the thread that ran it (the events posted 
+	// to the session were created, and counted, on the posting thread)
+	//
+	TEventAllocationCounters GetLastTurnEventAllocations();
+
+	// Returns the concept hypothesis allocations (and reuses) made during
+	// the last step
+	//
+	THypAllocationCounters GetLastTurnHypAllocations();
+
+	//---------------------------------------------------------------------
+	// Hibernation
+	//---------------------------------------------------------------------
+
+	// Writes the state of the session to a session record file, and frees 
+	// the core agents and the dialog task tree; the mailbox and the turn 
+	// timeout stay in place. Only possible while the session waits for an
+	// event, if its dialog task tree has no dynamic agents, and if all the
+	// agents on its execution stack belong to the tree (not while a 
+	// grounding agency, such as an explicit confirmation, is running). 
+	// Returns false (and leaves the session alone) otherwise
+	//
+	bool Hibernate(string sRecordFileName);
+
+	// Recreates the core agents and the dialog task tree of a hibernated 
+	// session and restores their state from the record file. Step and 
+	// Execute do this on their own. Returns false if the record file 
+	// cannot be read (the session stays hibernated), or if it does not 
+	// match the dialog task (the session is left without a core, and 
+	// cannot go on)
+	//
+	bool Restore();
+
+	// Indicates if the session is hibernated
+	//
+	bool IsHibernated();
+
+	//---------------------------------------------------------------------
+	// Access to session information
+	//---------------------------------------------------------------------
+
+	int GetSessionID();
+	bool IsInitialized();
+
+	// Returns the mailbox of the session (NULL before Initialize)
+	//
+	session_mailbox *GetMailbox();
+
+	//---------------------------------------------------------------------
+	// Turn timeouts
+	//---------------------------------------------------------------------
+
+	// Sets the timing wheel on which the turn timeouts of the session are
+	// timed (NULL cancels the pending timeout and detaches the session)
+	//
+	void SetTimeoutWheel(timing_wheel *ptwAWheel);
+
+	// (Re)arms the turn timeout to expire in iSeconds seconds; 0 cancels 
+	// it. Does nothing if the session has no timing wheel
+	//
+	void ArmTurnTimeout(int iSeconds);
+
+	// Cancels the pending turn timeout, if any
+	//
+	void CancelTurnTimeout();
+
+	// Indicates if an event is a turn timeout that expired before the 
+	// timeout was re-armed or cancelled, and should be ignored
+	//
+	bool IsStaleTurnTimeout(CInteractionEvent *pieEvent);
+
+	//---------------------------------------------------------------------
+	// Binding sessions to threads
+	//---------------------------------------------------------------------
+
+	// Binds a session to the calling thread (NULL unbinds the current one)
+	//
+	static void Bind(CDialogSession *pSession);
+
+	// Returns the session currently bound to the calling thread
+	//
+	static CDialogSession *GetCurrent();
+
+private:
+	// Copies the thread-local core agent pointers into the session
+	//
+	void saveCoreAgents();
+
+	// Destroys the core agents and the dialog task tree, leaving the 
+	// mailbox and the turn timeout alone
+	//
+	void destroyCore();
+};
+
+//-----------------------------------------------------------------------------
+//
+// CDialogSessionBinding class - binds a session to the calling thread for the
+//   lifetime of the object, and restores the previous binding afterwards
+//
+//-----------------------------------------------------------------------------
+
+class CDialogSessionBinding {
+
+private:
+	// the session that was bound before this object was created
+	CDialogSession *pPreviousSession;
+
+public:
+	CDialogSessionBinding(CDialogSession *pSession);
+	~CDialogSessionBinding();
+};
+
+//-----------------------------------------------------------------------------
+// Session factory functions (these replace the old InitializeDialogCore/
+// TerminateDialogCore pair)
+//-----------------------------------------------------------------------------
+
+// Creates and initializes a new dialog session
+//
+CDialogSession *CreateDialogSession(int iSessionID);
+
+// Terminates and deallocates a dialog session
+//
+void DestroyDialogSession(CDialogSession *pSession);
+
+#endif // __DIALOGSESSION_H__
@@ -0,0 +1,178 @@
+//=============================================================================
+//
+//   Copyright (c) 2000-2004, Carnegie Mellon University.  
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions
+//   are met:
+//
+//   1. Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer. 
+//
+//   2. Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//   This work was supported in part by funding from the Defense Advanced 
+//   Research Projects Agency and the National Science Foundation of the 
+//   United States of America, and the CMU Sphinx Speech Consortium.
+//
+//   THIS SOFTWARE IS PROVIDED BY CARNEGIE MELLON UNIVERSITY ``AS IS'' AND 
+//   ANY EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+//   THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//   PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL CARNEGIE MELLON UNIVERSITY
+//   NOR ITS EMPLOYEES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+//   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+//   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// 
+// DIALOGTREEARENA.CPP - implementation of the CDialogTreeArena class
+// 
+// ----------------------------------------------------------------------------
+// 
+// BEFORE MAKING CHANGES TO THIS CODE, please read the appropriate 
+// documentation, available in the Documentation folder. 
+//
+// ANY SIGNIFICANT CHANGES made should be reflected back in the documentation
+// file(s)
+//
+// ANY CHANGES made (even small bug fixes, should be reflected in the history
+// below, in reverse chronological order
+// 
+// HISTORY --------------------------------------------------------------------
+//
+//   [2026-10-18] (agent):  started working on this
+// 
+//-----------------------------------------------------------------------------
+
+#include "DialogTreeArena.h"
+
+#include <new>
+
+// the header in front of every object: the arena the object was placed in
+// (NULL for objects on the heap), padded so that objects stay aligned like
+// the ones returned by the global operator new
+#define ARENA_HEADER_SIZE	16
+#define ARENA_ALIGNMENT		16
+
+thread_local CDialogTreeArena* CDialogTreeArena::pdtaCurrent = NULL;
+
+//-----------------------------------------------------------------------------
+// Constructor and destructor
+//-----------------------------------------------------------------------------
+
+CDialogTreeArena::CDialogTreeArena(size_t stAChunkSize) {
+	stChunkSize = stAChunkSize;
+	stChunkUsed = 0;
+	stBytesAllocated = 0;
+	iLiveObjects = 0;
+}
+
+CDialogTreeArena::~CDialogTreeArena() {
+	Reset();
+}
+
+// D: gives all the chunks back
+void CDialogTreeArena::Reset() {
+	for(unsigned int i = 0; i < vpcChunks.size(); i++)
+		delete [] vpcChunks[i];
+	vpcChunks.clear();
+	stChunkUsed = 0;
+	stBytesAllocated = 0;
+	iLiveObjects = 0;
+}
+
+// D: returns the number of bytes handed out from the arena
+size_t CDialogTreeArena::GetBytesAllocated() {
+	return stBytesAllocated;
+}
+
+// D: returns the number of objects that are still alive in the arena
+int CDialogTreeArena::GetLiveObjects() {
+	return iLiveObjects;
+}
+
+//-----------------------------------------------------------------------------
+// Object allocation
+//-----------------------------------------------------------------------------
+
+// D: allocates an object, from the current arena if there is one
+void* CDialogTreeArena::New(size_t stSize) {
+	CDialogTreeArena* pdtaArena = pdtaCurrent;
+	char* pcBlock;
+	if(pdtaArena) {
+		pcBlock = (char *)pdtaArena->allocate(ARENA_HEADER_SIZE + stSize);
+		pdtaArena->iLiveObjects++;
+	} else {
+		pcBlock = (char *)::operator new(ARENA_HEADER_SIZE + stSize);
+	}
+	*(CDialogTreeArena **)pcBlock = pdtaArena;
+	return pcBlock + ARENA_HEADER_SIZE;
+}
+
+// D: releases an object; arena objects are only accounted for, their 
+//    memory goes away with the arena
+void CDialogTreeArena::Delete(void* pObject) {
+	if(pObject == NULL)
+		return;
+	char* pcBlock = (char *)pObject - ARENA_HEADER_SIZE;
+	CDialogTreeArena* pdtaArena = *(CDialogTreeArena **)pcBlock;
+	if(pdtaArena)
+		pdtaArena->iLiveObjects--;
+	else
+		::operator delete(pcBlock);
+}
+
+// D: returns the arena that is current on the calling thread
+CDialogTreeArena* CDialogTreeArena::GetCurrent() {
+	return pdtaCurrent;
+}
+
+// D: sets the arena that is current on the calling thread
+void CDialogTreeArena::SetCurrent(CDialogTreeArena* pdtaArena) {
+	pdtaCurrent = pdtaArena;
+}
+
+// D: carves a block out of the last chunk, starting a new chunk if it does
+//    not fit (blocks larger than a chunk get a chunk of their own)
+void* CDialogTreeArena::allocate(size_t stSize) {
+	stSize = (stSize + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+	if(vpcChunks.empty() || (stChunkUsed + stSize > stChunkSize)) {
+		size_t stNewChunkSize = stSize > stChunkSize ? stSize : stChunkSize;
+		char* pcChunk = new char[stNewChunkSize];
+		if(stSize > stChunkSize && !vpcChunks.empty()) {
+			// keep filling the current chunk afterwards
+			vpcChunks.insert(vpcChunks.end() - 1, pcChunk);
+			stBytesAllocated += stSize;
+			return pcChunk;
+		}
+		vpcChunks.push_back(pcChunk);
+		stChunkUsed = 0;
+	}
+	void* pBlock = vpcChunks.back() + stChunkUsed;
+	stChunkUsed += stSize;
+	stBytesAllocated += stSize;
+	return pBlock;
+}
+
+//-----------------------------------------------------------------------------
+// CDialogTreeArenaScope class
+//-----------------------------------------------------------------------------
+
+CDialogTreeArenaScope::CDialogTreeArenaScope(CDialogTreeArena* pdtaArena) {
+	pdtaPrevious = CDialogTreeArena::GetCurrent();
+	CDialogTreeArena::SetCurrent(pdtaArena);
+}
+
+CDialogTreeArenaScope::~CDialogTreeArenaScope() {
+	CDialogTreeArena::SetCurrent(pdtaPrevious);
+}
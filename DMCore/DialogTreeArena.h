@@ -0,0 +1,166 @@
+//=============================================================================
+//
+//   Copyright (c) 2000-2004, Carnegie Mellon University.  
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions
+//   are met:
+//
+//   1. Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer. 
+//
+//   2. Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//   This work was supported in part by funding from the Defense Advanced 
+//   Research Projects Agency and the National Science Foundation of the 
+//   United States of America, and the CMU Sphinx Speech Consortium.
+//
+//   THIS SOFTWARE IS PROVIDED BY CARNEGIE MELLON UNIVERSITY ``AS IS'' AND 
+//   ANY EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+//   THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//   PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL CARNEGIE MELLON UNIVERSITY
+//   NOR ITS EMPLOYEES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+//   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+//   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// 
+// DIALOGTREEARENA.H - definition of the CDialogTreeArena class. A dialog tree
+//                     arena is the contiguous memory the agents and concepts
+//                     of a session's dialog task tree are placed in, when 
+//                     the tree is cloned from the dialog tree image (see 
+//                     CDTTManagerAgent)
+// 
+// ----------------------------------------------------------------------------
+// 
+// BEFORE MAKING CHANGES TO THIS CODE, please read the appropriate 
+// documentation, available in the Documentation folder. 
+//
+// ANY SIGNIFICANT CHANGES made should be reflected back in the documentation
+// file(s)
+//
+// ANY CHANGES made (even small bug fixes, should be reflected in the history
+// below, in reverse chronological order
+// 
+// HISTORY --------------------------------------------------------------------
+//
+//   [2026-10-18] (agent):  started working on this
+// 
+//-----------------------------------------------------------------------------
+
+#pragma once
+#ifndef __DIALOGTREEARENA_H__
+#define __DIALOGTREEARENA_H__
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+//-----------------------------------------------------------------------------
+//
+// CDialogTreeArena class - a bump allocator over a list of large chunks. 
+//   CDialogAgent and CConcept allocate their objects through New/Delete: 
+//   while an arena is current on the calling thread (see 
+//   CDialogTreeArenaScope) the objects are carved out of it, one after the 
+//   other, otherwise they come from the heap as usual. Every object is 
+//   preceded by a small header that tells Delete where it came from; 
+//   deleting an arena object only runs its destructor, the memory is given 
+//   back all at once when the arena is reset or destroyed, so the arena 
+//   must outlive the objects placed in it.
+//
+//-----------------------------------------------------------------------------
+
+class CDialogTreeArena {
+
+private:
+	//---------------------------------------------------------------------
+	// Private members
+	//---------------------------------------------------------------------
+
+	// the chunks, the last one is the one being filled
+	vector<char*> vpcChunks;
+
+	// the size of a regular chunk, and how much of the last chunk is used
+	size_t stChunkSize;
+	size_t stChunkUsed;
+
+	// the number of bytes handed out, and the number of objects that were 
+	// placed in the arena and not deleted yet
+	size_t stBytesAllocated;
+	int iLiveObjects;
+
+	// the arena objects are currently allocated from on this thread
+	static thread_local CDialogTreeArena* pdtaCurrent;
+
+public:
+	//---------------------------------------------------------------------
+	// Constructor and destructor
+	//---------------------------------------------------------------------
+	//
+	CDialogTreeArena(size_t stAChunkSize = 64 * 1024);
+	~CDialogTreeArena();
+
+	// Gives all the memory back; only to be called once all the objects
+	// placed in the arena were deleted
+	//
+	void Reset();
+
+	// Returns the number of bytes handed out from the arena
+	//
+	size_t GetBytesAllocated();
+
+	// Returns the number of objects in the arena that were not deleted yet
+	//
+	int GetLiveObjects();
+
+	//---------------------------------------------------------------------
+	// Object allocation (used by the operator new and delete of 
+	// CDialogAgent and CConcept)
+	//---------------------------------------------------------------------
+
+	static void* New(size_t stSize);
+	static void Delete(void* pObject);
+
+	// Access to the arena that is current on the calling thread
+	//
+	static CDialogTreeArena* GetCurrent();
+	static void SetCurrent(CDialogTreeArena* pdtaArena);
+
+private:
+	// carves a block out of the arena
+	void* allocate(size_t stSize);
+
+	// arenas are not copied
+	CDialogTreeArena(const CDialogTreeArena&);
+	CDialogTreeArena& operator = (const CDialogTreeArena&);
+};
+
+//-----------------------------------------------------------------------------
+//
+// CDialogTreeArenaScope class - makes an arena current on the calling thread
+//   for its lifetime (and restores the previous one afterwards)
+//
+//-----------------------------------------------------------------------------
+
+class CDialogTreeArenaScope {
+
+private:
+	CDialogTreeArena* pdtaPrevious;
+
+public:
+	CDialogTreeArenaScope(CDialogTreeArena* pdtaArena);
+	~CDialogTreeArenaScope();
+};
+
+#endif // __DIALOGTREEARENA_H__
@@ -51,6 +51,18 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the properties keep their slot names as 
+//                           strings, instead of interning them
+//   [2026-10-18] (agent):  events are pooled (see Create and Release), and
+//                           keep their properties in a flat array sorted by
+//                           the interned slot names
+//   [2026-10-18] (agent):  slot names and expectation patterns are split
+//                           into levels once, and matched without copying 
+//                           them; added FindValueForExpectation
+//   [2026-10-18] (agent):  Matches and GetValueForExpectation scan the 
+//                           slots once, and fully match only those whose 
+//                           last level hashes like the expectation's (see
+//                           findMatchingSlot)
 //   [2005-11-07] (antoine): added support for partial events
 //   [2005-09-01] (antoine): first stable version
 //   [2005-06-22] (antoine): started this
@@ -60,6 +72,33 @@
 #include "InteractionEvent.h"
 
 #include "DMCore/Log.h"
+#include "DMCore/Agents/SymbolTable.h"
+
+#include <atomic>
+#include <typeinfo>
+
+// D: the maximum number of released events kept by a thread
+#define MAX_POOLED_EVENTS	64
+
+// D: the pool of released events of a thread (the events left in it when
+//    the thread ends are deleted)
+class CEventPool {
+public:
+	vector<CInteractionEvent*> vpieEvents;
+	~CEventPool() {
+		for (unsigned int i = 0; i < vpieEvents.size(); i++) {
+			delete vpieEvents[i];
+		}
+	}
+};
+
+static thread_local CEventPool epPool;
+
+// D: the allocation counters of a thread
+static thread_local TEventAllocationCounters eacCounters = {0, 0, 0, 0};
+
+// D: indicates if the pool is used
+static atomic<bool> bUseEventPool(true);
 
 //---------------------------------------------------------------------
 // Constructor and destructor
@@ -68,17 +107,78 @@
 
 // A: Default constructor
 // 此处做了修改，让confidence默认为1.0
-CInteractionEvent::CInteractionEvent():fConfidence(1.0) {}
+CInteractionEvent::CInteractionEvent() {
+	clear("");
+}
 
 // A: Specifies an event type
 CInteractionEvent::CInteractionEvent(string sAType) {
-	sType = sAType;
-  fConfidence = 1.0;
+	clear(sAType);
 }
 
 // A: Destructor
 CInteractionEvent::~CInteractionEvent() {}
 
+// D: brings the event to its initial state, keeping the memory of its 
+//    properties
+void CInteractionEvent::clear(string sAType) {
+	sType = sAType;
+	iID = 0;
+	bComplete = false;
+	fConfidence = 1.0;
+	iPropertiesCount = 0;
+	bSlotIndexValid = false;
+	s2sProperties.clear();
+}
+
+//---------------------------------------------------------------------
+// Event pool
+//---------------------------------------------------------------------
+
+// D: Returns a new event, from the pool if possible
+CInteractionEvent* CInteractionEvent::Create(string sAType) {
+	if (bUseEventPool && !epPool.vpieEvents.empty()) {
+		CInteractionEvent* pieEvent = epPool.vpieEvents.back();
+		epPool.vpieEvents.pop_back();
+		pieEvent->clear(sAType);
+		eacCounters.iEventsReused++;
+		return pieEvent;
+	}
+	eacCounters.iEventsAllocated++;
+	return new CInteractionEvent(sAType);
+}
+
+// D: Releases an event into the pool (or deletes it, if the pool is full or
+//    not used)
+void CInteractionEvent::Release(CInteractionEvent* pieEvent) {
+	if (pieEvent == NULL) {
+		return;
+	}
+	eacCounters.iEventsReleased++;
+	// only plain events are kept (not the ones of derived classes)
+	if (bUseEventPool && 
+		(epPool.vpieEvents.size() < MAX_POOLED_EVENTS) &&
+		(typeid(*pieEvent) == typeid(CInteractionEvent))) {
+		epPool.vpieEvents.push_back(pieEvent);
+	} else {
+		delete pieEvent;
+	}
+}
+
+// D: Enables or disables the pool
+void CInteractionEvent::SetUseEventPool(bool bAUseEventPool) {
+	bUseEventPool = bAUseEventPool;
+}
+
+// D: Indicates if the pool is used
+bool CInteractionEvent::GetUseEventPool() {
+	return bUseEventPool;
+}
+
+// D: Returns the allocation counters of the calling thread
+TEventAllocationCounters CInteractionEvent::GetAllocationCounters() {
+	return eacCounters;
+}
 
 //---------------------------------------------------------------------
 // Public methods to access private members
@@ -108,11 +208,31 @@ float CInteractionEvent::GetConfidence() {
 	return fConfidence;
 }
 
+// D: Finds the property for a slot (binary search on the slot names)
+bool CInteractionEvent::findProperty(const string& sSlot, int& riIndex) {
+	int iLow = 0;
+	int iHigh = iPropertiesCount;
+	while (iLow < iHigh) {
+		int iMiddle = (iLow + iHigh) / 2;
+		int iCompare = vepProperties[iMiddle].sSlot.compare(sSlot);
+		if (iCompare == 0) {
+			riIndex = iMiddle;
+			return true;
+		} else if (iCompare < 0) {
+			iLow = iMiddle + 1;
+		} else {
+			iHigh = iMiddle;
+		}
+	}
+	riIndex = iLow;
+	return false;
+}
+
 // A: Returns the string value for a property of the event
 string CInteractionEvent::GetStringProperty(string sSlot) {
-	STRING2STRING::iterator i = s2sProperties.find(sSlot);
-	if (i != s2sProperties.end()) {
-		return i->second;
+	int iIndex;
+	if (findProperty(sSlot, iIndex)) {
+		return vepProperties[iIndex].sValue;
 	} else {
 		//Log(WARNING_STREAM, "Property %s not found in event. "\
 			"Returned empty string.", sSlot.c_str());
@@ -122,9 +242,9 @@ string CInteractionEvent::GetStringProperty(string sSlot) {
 
 // A: Returns the int value for a property of the event
 int CInteractionEvent::GetIntProperty(string sSlot) {
-	STRING2STRING::iterator i = s2sProperties.find(sSlot);
-	if (i != s2sProperties.end()) {
-		return atoi(i->second.c_str());
+	int iIndex;
+	if (findProperty(sSlot, iIndex)) {
+		return atoi(vepProperties[iIndex].sValue.c_str());
 	} else {
 		Log(WARNING_STREAM, "Property %s not found in event. "\
 			"Returned 0.", sSlot.c_str());
@@ -134,9 +254,9 @@ int CInteractionEvent::GetIntProperty(string sSlot) {
 
 // A: Returns the float value for a property of the event
 float CInteractionEvent::GetFloatProperty(string sSlot) {
-	STRING2STRING::iterator i = s2sProperties.find(sSlot);
-	if (i != s2sProperties.end()) {
-		return (float)atof(i->second.c_str());
+	int iIndex;
+	if (findProperty(sSlot, iIndex)) {
+		return (float)atof(vepProperties[iIndex].sValue.c_str());
 	} else {
 		Log(WARNING_STREAM, "Property %s not found in event. "\
 			"Returned 0.", sSlot.c_str());
@@ -146,19 +266,68 @@ float CInteractionEvent::GetFloatProperty(string sSlot) {
 
 // A: Checks if a certain property is defined for the event
 bool CInteractionEvent::HasProperty(string sSlot) {
-	return s2sProperties.find(sSlot) != s2sProperties.end();
+	int iIndex;
+	return findProperty(sSlot, iIndex);
 }
 
 // A: Sets a property value
-void CInteractionEvent::SetProperty(string sSlot, string sValue) {
-	s2sProperties[sSlot] = sValue;
+// D: the properties are kept sorted by slot name; the entries past the end
+//    of the properties are reused, with their buffers
+void CInteractionEvent::SetProperty(const string& sSlot, 
+	const string& sValue) {
+	int iIndex;
+	if (!findProperty(sSlot, iIndex)) {
+		if (iPropertiesCount == (int)vepProperties.size()) {
+			if (vepProperties.size() == vepProperties.capacity()) {
+				eacCounters.iBufferAllocations++;
+			}
+			vepProperties.push_back(TEventProperty());
+		}
+		// move the new entry in place
+		for (int i = iPropertiesCount; i > iIndex; i--) {
+			vepProperties[i].sSlot.swap(vepProperties[i - 1].sSlot);
+			vepProperties[i].sValue.swap(vepProperties[i - 1].sValue);
+		}
+		string& rsSlot = vepProperties[iIndex].sSlot;
+		if (sSlot.size() > rsSlot.capacity()) {
+			eacCounters.iBufferAllocations++;
+		}
+		rsSlot.assign(sSlot);
+		iPropertiesCount++;
+	}
+	string& rsValue = vepProperties[iIndex].sValue;
+	if (sValue.size() > rsValue.capacity()) {
+		eacCounters.iBufferAllocations++;
+	}
+	rsValue.assign(sValue);
+	bSlotIndexValid = false;
 }
 
 // A: Returns the hash of event properties
 STRING2STRING &CInteractionEvent::GetProperties() {
+	s2sProperties.clear();
+	for (int i = 0; i < iPropertiesCount; i++) {
+		s2sProperties[vepProperties[i].sSlot] = 
+			vepProperties[i].sValue;
+	}
 	return s2sProperties;
 }
 
+// D: Returns the number of properties
+int CInteractionEvent::GetPropertiesCount() {
+	return iPropertiesCount;
+}
+
+// D: Returns the slot name of a property
+const string& CInteractionEvent::GetPropertySlot(int iIndex) {
+	return vepProperties[iIndex].sSlot;
+}
+
+// D: Returns the value of a property
+const string& CInteractionEvent::GetPropertyValue(int iIndex) {
+	return vepProperties[iIndex].sValue;
+}
+
 // A: Returns a string representation of the event
 string CInteractionEvent::ToString() {
 	string sEvent;
@@ -167,16 +336,10 @@ string CInteractionEvent::ToString() {
 	sEvent += FormatString("Complete\t%d\n", bComplete);
 
 	// returns the contents of the input hash
-	if(s2sProperties.size() > 0) {
-		STRING2STRING::iterator iPtr;
-		for(iPtr = s2sProperties.begin(); 
-			iPtr != s2sProperties.end(); 
-			iPtr++) {
-
-			sEvent += FormatString("  %s = %s\n", 
-				(iPtr->first.c_str()),
-				(iPtr->second.c_str()));
-		}
+	for (int i = 0; i < iPropertiesCount; i++) {
+		sEvent += FormatString("  %s = %s\n", 
+			GetPropertySlot(i).c_str(),
+			vepProperties[i].sValue.c_str());
 	}
 	
 	// finally return the string
@@ -187,177 +350,226 @@ string CInteractionEvent::ToString() {
 // Methods to test and access event properties
 //---------------------------------------------------------------------
 
-// A: Check if a certain expectation is matched by the input 
-// D: fixed bug to match case-insensitive
-bool CInteractionEvent::Matches(string sGrammarExpectation) {
-
-	// remove the "[" and "]" around the expectation
-	string sTemp = sGrammarExpectation.substr( 1, sGrammarExpectation.size()-2);	
-
-	// extracts the expectation channel from the grammar expectation string
-	string sChannel, sExpectation;
-	SplitOnFirst(sTemp, ":", sChannel, sExpectation);
-	if (sExpectation == "") {
-		sExpectation = sChannel;
-		sChannel = "";
-	}
-
-	// the expectation is not for this type of event, no match
-	if ((sChannel != "")&&(sChannel != sType)) {
-		return false;
+// D: Splits a slot name or expectation pattern (the part of sName between 
+//    stBegin and stEnd) into its levels, lowercased; the levels are split 
+//    the way matchesSlot used to split them (a '.' right at the start of a
+//    level does not end it)
+static void splitSlotPath(const string& sName, size_t stBegin, size_t stEnd,
+	TSlotPath& rspPath) {
+	rspPath.sName.assign(sName, stBegin, stEnd - stBegin);
+	for (unsigned int i = 0; i < rspPath.sName.size(); i++) {
+		if ((rspPath.sName[i] >= 'A') && (rspPath.sName[i] <= 'Z')) {
+			rspPath.sName[i] += 'a' - 'A';
+		}
 	}
 
-	// traverses the hash and matches the given expectation
-	STRING2STRING::iterator iPtr;
-	for(iPtr = s2sProperties.begin(); 
-		iPtr != s2sProperties.end(); 
-		iPtr++) {
-			if (matchesSlot(sExpectation, iPtr->first.c_str())) {
-				return true;
-			}
-	}
-	
-	return false;
+	rspPath.vslLevels.clear();
+	const string& sLower = rspPath.sName;
+	size_t stPos = 0;
+	do {
+		TSlotLevel slLevel;
+		size_t stDot = sLower.find('.', stPos);
+		slLevel.uiOffset = (unsigned int)stPos;
+		if ((stDot != string::npos) && (stDot > stPos)) {
+			slLevel.uiLength = (unsigned int)(stDot - stPos);
+		} else {
+			// no more '.', get the end of the name
+			slLevel.uiLength = (unsigned int)(sLower.size() - stPos);
+		}
+		slLevel.stHash = CSymbolTable::Hash(sLower.c_str() + stPos, 
+			slLevel.uiLength, CSymbolTable::HashSeed());
+		rspPath.vslLevels.push_back(slLevel);
+		stPos += slLevel.uiLength + 1;
+	} while (stPos < sLower.size());
 }
 
-// A: Returns the string corresponding to a given expectation in the input
-string CInteractionEvent::GetValueForExpectation(string sGrammarExpectation) {
-	string matched_value;
-
-	// remove the "[" and "]" around the expectation
-	string sTemp = sGrammarExpectation.substr( 1, sGrammarExpectation.size()-2);	
-
-	// extracts the expectation channel from the grammar expectation string
-	string sChannel, sExpectation;
-	SplitOnFirst(sTemp, ":", sChannel, sExpectation);
-	if (sExpectation == "") {
-		sExpectation = sChannel;
-		sChannel = "";
-	}
+// D: Checks if two levels are the same
+static inline bool sameSlotLevel(const TSlotPath& rspPath1, 
+	const TSlotLevel& rslLevel1, const TSlotPath& rspPath2, 
+	const TSlotLevel& rslLevel2) {
+	return (rslLevel1.stHash == rslLevel2.stHash) && 
+		(rslLevel1.uiLength == rslLevel2.uiLength) &&
+		(memcmp(rspPath1.sName.c_str() + rslLevel1.uiOffset, 
+			rspPath2.sName.c_str() + rslLevel2.uiOffset, 
+			rslLevel1.uiLength) == 0);
+}
 
-	// the expectation is not for this type of event, no match
-	if ((sChannel != "")&&(sChannel != sType)) {
-		Warning(FormatString("Channel mismatch for %s, empty value used.", 
-			sGrammarExpectation.c_str()));
-		return "";
+// D: the expectation patterns seen so far by this thread (there is a bounded
+//    number of them: they come from the grammar mappings of the dialog task)
+static thread_local unordered_map<string, TExpectationPattern> 
+	tlumPatterns;
+
+// D: Returns an expectation pattern, splitting it the first time it is seen
+//    by this thread
+const TExpectationPattern& CInteractionEvent::getPattern(
+	const string& sGrammarExpectation) {
+	unordered_map<string, TExpectationPattern>::iterator iPtr = 
+		tlumPatterns.find(sGrammarExpectation);
+	if (iPtr != tlumPatterns.end()) {
+		return iPtr->second;
 	}
 
-	// traverses the hash, searching for the best match for the expectation
-	// "best" = (slot name matches) & (shallowest/broadest)
-	STRING2STRING::iterator iPtr;
-	for(iPtr = s2sProperties.begin(); 
-		iPtr != s2sProperties.end(); 
-		iPtr++) {
+	TExpectationPattern& rpPattern = tlumPatterns[sGrammarExpectation];
 
-		if (matchesSlot(sExpectation, iPtr->first)) {
-	
-			// returns the value of the matched slot
-			matched_value = iPtr->second;
-			if (matched_value == "") {
-				Warning(FormatString("Event property %s has empty value.",
-					sGrammarExpectation.c_str()));
-			}
-			return matched_value;
-		}
+	// remove the "[" and "]" around the expectation
+	size_t stBegin = 1;
+	size_t stEnd = sGrammarExpectation.size() - 1;
+	if (sGrammarExpectation.size() < 2) {
+		stBegin = stEnd = sGrammarExpectation.size();
 	}
 
-	// no matching property found, log a warning and return ""
-	Warning(FormatString("No event property found matching %s.", 
-		sGrammarExpectation.c_str()));
-	return "";
+	// extracts the expectation channel from the grammar expectation string
+	size_t stColon = sGrammarExpectation.find(':', stBegin);
+	if ((stColon != string::npos) && (stColon < stEnd) && 
+		(stColon + 1 < stEnd)) {
+		rpPattern.sChannel.assign(sGrammarExpectation, stBegin, 
+			stColon - stBegin);
+		stBegin = stColon + 1;
+	} else if ((stColon != string::npos) && (stColon < stEnd)) {
+		// nothing after the ':', so there's no channel
+		stEnd = stColon;
+	}
+	splitSlotPath(sGrammarExpectation, stBegin, stEnd, rpPattern.spPath);
+	return rpPattern;
 }
 
 // A: Matches a slot with an expectation pattern
 //    allowing for wild cards
+// D: the levels of the pattern have to appear in the slot in the same order,
+//    and the last ones have to match each other
 #pragma warning (disable:4127)
-bool CInteractionEvent::matchesSlot( string pattern, string slot) {
-	unsigned int pos_slot = 0;
-	unsigned int len_slot = 0;
-	unsigned int pos_patt = 0;
-	unsigned int len_patt = 0;
-	string sub_slot, sub_patt;
-
-	// removes the "[" and "]" around the slot
-	slot = slot.substr( 1, slot.size()-2);
-
-	// gets the first level in the pattern
-	if ((int)pattern.find_first_of( '.', pos_patt) > (int)pos_patt) {
-		len_patt = pattern.find_first_of( '.', pos_patt) - pos_patt;
-	}
-	else {
-		// no more '.', get the end of the pattern
-		len_patt = pattern.size() - pos_patt;
-	}
-	sub_patt = pattern.substr( pos_patt, len_patt);
-	pos_patt += len_patt + 1;
-
-	// gets the first level in the slot name
-	if ((int)slot.find_first_of( '.', pos_slot) > (int)pos_slot) {
-		len_slot = slot.find_first_of( '.', pos_slot) - pos_slot;
-	}
-	else {
-		// no more '.', get the end of the slot name
-		len_slot = slot.size() - pos_slot;
-	}
-	sub_slot = slot.substr( pos_slot, len_slot);
-	pos_slot += len_slot + 1;
+bool CInteractionEvent::matchesSlot(const TSlotPath& rspPattern, 
+	const TSlotPath& rspSlot) {
+	unsigned int uiPattern = 0;
+	unsigned int uiSlot = 0;
+	unsigned int uiPatternLevels = rspPattern.vslLevels.size();
+	unsigned int uiSlotLevels = rspSlot.vslLevels.size();
 
 	// traverses the expectation pattern and the slot name
 	while (true) {
 
 		// compare the level names
-		if (strcasecmp( sub_slot.c_str(), sub_patt.c_str()) == 0) {
+		if (sameSlotLevel(rspSlot, rspSlot.vslLevels[uiSlot], 
+			rspPattern, rspPattern.vslLevels[uiPattern])) {
 			
 			// the final subslot of both the pattern and the slot matched:
 			// we won!
-			if ((pos_patt >= pattern.size())&&(pos_slot >= slot.size())) {
+			if ((uiPattern + 1 >= uiPatternLevels) && 
+				(uiSlot + 1 >= uiSlotLevels)) {
 				return true;
 			}
 
-			// we reached the end of the pattern but not that of the slo => fail
-			if (pos_patt >= pattern.size()) {
+			// we reached the end of the pattern but not that of the slot 
+			// => fail
+			if (uiPattern + 1 >= uiPatternLevels) {
 				return false;
 			}
-
-			if ((int)pattern.find_first_of( '.', pos_patt) > (int)pos_patt) {
-				len_patt = pattern.find_first_of( '.', pos_patt) - pos_patt;
-			}
-			else {
-				// no more '.', get the end of the pattern
-				len_patt = pattern.size() - pos_patt;
-			}
-			sub_patt = pattern.substr( pos_patt, len_patt);
-
-			// move the position index for the pattern
-			pos_patt += len_patt + 1;
+			uiPattern++;
 		}
 
 		// we reached the end of the slot but not that of the pattern => fail
-		if (pos_slot >= slot.size()) {
+		if (uiSlot + 1 >= uiSlotLevels) {
 			return false;
 		}
+		uiSlot++;
+	}
+}
+#pragma warning (default:4127)
+
+// D: Returns the index of the property whose slot matches an expectation 
+//    pattern (the first one in the properties), or -1 if there is none
+int CInteractionEvent::findMatchingSlot(const TExpectationPattern& rpPattern) {
 
-		// gets the next level in the slot name
-		if ((int)slot.find_first_of( '.', pos_slot) > (int)pos_slot) {
-			len_slot = slot.find_first_of( '.', pos_slot) - pos_slot;
+	// the expectation is not for this type of event, no match
+	if (!rpPattern.sChannel.empty() && (rpPattern.sChannel != sType)) {
+		return -1;
+	}
+
+	// index the slots, if needed (the entries are reused, with their 
+	// buffers)
+	if (!bSlotIndexValid) {
+		if ((int)visSlotIndex.size() < iPropertiesCount) {
+			if ((int)visSlotIndex.capacity() < iPropertiesCount) {
+				eacCounters.iBufferAllocations++;
+			}
+			visSlotIndex.resize(iPropertiesCount);
 		}
-		else {
-			// no more '.', get the end of the slot name
-			len_slot = slot.size() - pos_slot;
+		for(int i = 0; i < iPropertiesCount; i++) {
+			// the slot names come with "[" and "]" around them
+			const string& sSlot = GetPropertySlot(i);
+			TIndexedSlot& risSlot = visSlotIndex[i];
+			if (sSlot.size() < 2) {
+				splitSlotPath(sSlot, sSlot.size(), sSlot.size(), 
+					risSlot.spPath);
+			} else {
+				splitSlotPath(sSlot, 1, sSlot.size() - 1, risSlot.spPath);
+			}
+			risSlot.stLastLevelHash = risSlot.spPath.vslLevels.back().stHash;
 		}
-		sub_slot = slot.substr( pos_slot, len_slot);
+		bSlotIndexValid = true;
+	}
 
-		// moves the position index for the slot
-		pos_slot += len_slot + 1;
+	// and try the slots with the same last level
+	size_t stLastLevelHash = rpPattern.spPath.vslLevels.back().stHash;
+	for(int i = 0; i < iPropertiesCount; i++) {
+		if ((visSlotIndex[i].stLastLevelHash == stLastLevelHash) &&
+			matchesSlot(rpPattern.spPath, visSlotIndex[i].spPath)) {
+			return i;
+		}
 	}
+	return -1;
 }
-#pragma warning (default:4127)
+
+// A: Check if a certain expectation is matched by the input 
+// D: fixed bug to match case-insensitive
+bool CInteractionEvent::Matches(const string& sGrammarExpectation) {
+	return findMatchingSlot(getPattern(sGrammarExpectation)) != -1;
+}
+
+// D: Returns the value of the slot that matches a given expectation, or 
+//    NULL if no slot matches it
+const string* CInteractionEvent::FindValueForExpectation(
+	const string& sGrammarExpectation) {
+	int iIndex = findMatchingSlot(getPattern(sGrammarExpectation));
+	if (iIndex == -1) {
+		return NULL;
+	}
+	return &(vepProperties[iIndex].sValue);
+}
+
+// A: Returns the string corresponding to a given expectation in the input
+string CInteractionEvent::GetValueForExpectation(
+	const string& sGrammarExpectation) {
+	const TExpectationPattern& rpPattern = getPattern(sGrammarExpectation);
+
+	// the expectation is not for this type of event, no match
+	if (!rpPattern.sChannel.empty() && (rpPattern.sChannel != sType)) {
+		Warning(FormatString("Channel mismatch for %s, empty value used.", 
+			sGrammarExpectation.c_str()));
+		return "";
+	}
+
+	// searches for the best match for the expectation
+	// "best" = (slot name matches) & (shallowest/broadest)
+	int iIndex = findMatchingSlot(rpPattern);
+	if (iIndex != -1) {
+		// returns the value of the matched slot
+		if (vepProperties[iIndex].sValue == "") {
+			Warning(FormatString("Event property %s has empty value.",
+				sGrammarExpectation.c_str()));
+		}
+		return vepProperties[iIndex].sValue;
+	}
+
+	// no matching property found, log a warning and return ""
+	Warning(FormatString("No event property found matching %s.", 
+		sGrammarExpectation.c_str()));
+	return "";
+}
+
 void CInteractionEvent::SetProperties(STRING2STRING& s2sProperties) {
   STRING2STRING::iterator iPtr;
   for(iPtr=s2sProperties.begin(); iPtr != s2sProperties.end(); iPtr++) {
     SetProperty(iPtr->first,iPtr->second);
   }
 }
-
-
-
@@ -51,6 +51,18 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  the properties keep their slot names as 
+//                           strings (slot names come from the input, and 
+//                           are not interned)
+//   [2026-10-18] (agent):  events are pooled (see Create and Release), and 
+//                           keep their properties in a flat array with 
+//                           interned slot names; added allocation counters
+//   [2026-10-18] (agent):  slot names and expectation patterns are split
+//                           into levels once, and matched without copying 
+//                           them; added FindValueForExpectation
+//   [2026-10-18] (agent):  the slots of the event are indexed by their last
+//                           level, so that matching an expectation only 
+//                           looks at the slots that can match it
 //   [2005-11-07] (antoine): added support for partial events
 //   [2005-09-01] (antoine): first stable version
 //   [2005-06-22] (antoine): started this
@@ -63,6 +75,59 @@
 
 #include "Utils/Utils.h"
 
+#include <unordered_map>
+
+// D: a level of a slot name or expectation pattern: where it is in the 
+//    (lowercased) name, and its hash
+typedef struct {
+	unsigned int uiOffset;			// the start of the level in the name
+	unsigned int uiLength;			// the length of the level
+	size_t stHash;					// the hash of the level
+} TSlotLevel;
+
+// D: a slot name or expectation pattern, lowercased and split into its 
+//    dot-separated levels, so that it can be matched without copying it
+typedef struct {
+	string sName;					// the name, lowercased and without the
+									//  "[" and "]" around it
+	vector <TSlotLevel> vslLevels;	// its levels (there is always one)
+} TSlotPath;
+
+// D: a grammar expectation, as matched against the slots of an event
+typedef struct {
+	string sChannel;				// the channel (the event type), if any
+	TSlotPath spPath;				// the expected slot
+} TExpectationPattern;
+
+// D: a slot of an event, split into levels. An expectation pattern can only
+//    match a slot that has the same last level, so the hash of the last 
+//    level is kept apart, to go quickly over the slots that cannot match
+typedef struct {
+	size_t stLastLevelHash;			// the hash of the last level
+	TSlotPath spPath;				// the slot name, split into levels
+} TIndexedSlot;
+
+// D: a property of an event: the slot name, and the value (the slot names
+//    come from outside, e.g. from the input text, so they are kept in the 
+//    event rather than interned; a reused entry keeps the buffers of both)
+typedef struct {
+	string sSlot;					// the slot
+	string sValue;					// the value
+} TEventProperty;
+
+// D: counters of the allocations made for interaction events on a thread
+//    (an event released on another thread than the one that created it 
+//    counts as released there)
+typedef struct {
+	int iEventsAllocated;			// events allocated on the heap
+	int iEventsReused;				// events taken from the pool
+	int iEventsReleased;			// events released (into the pool, or 
+									//  deleted when the pool is full)
+	int iBufferAllocations;			// times the property or index arrays of
+									//  an event, or the buffer of a value, 
+									//  had to grow
+} TEventAllocationCounters;
+
 //-----------------------------------------------------------------------------
 // CInteractionEvent Class - 
 //   This class handles an event related to interaction with the user and the 
@@ -91,7 +156,19 @@ protected:
 	// of the event
 	float fConfidence;
 
-	// The hash of properties for this event
+	// The properties of this event, sorted by slot name, in the first 
+	// iPropertiesCount entries of the array (the entries after that are
+	// kept, with their buffers, for when the event is reused)
+	vector <TEventProperty> vepProperties;
+	int iPropertiesCount;
+
+	// The slots of the properties, split into levels (built the first time
+	// an expectation is matched, and dropped when the properties change;
+	// kept in the same way as the properties)
+	vector <TIndexedSlot> visSlotIndex;
+	bool bSlotIndexValid;
+
+	// The hash of properties, as returned by GetProperties
 	STRING2STRING s2sProperties;
 
 public:
@@ -107,6 +184,33 @@ public:
 	// Destructor
 	virtual ~CInteractionEvent();
 
+	//---------------------------------------------------------------------
+	// Event pool: events released are kept (per thread) and handed out 
+	// again by Create, with the memory of their properties. The pool is 
+	// the one of the thread that releases the event: an event created on
+	// one thread and released on another (e.g. input created by the 
+	// thread that receives it, and posted to a session that a scheduler 
+	// worker steps) does not go back to the thread that created it, so 
+	// a thread that only creates events keeps allocating them, and the 
+	// pools of the threads that only release them fill up
+	//---------------------------------------------------------------------
+	//
+	// Returns a new event of a given type, reusing a released one if there
+	// is any
+	static CInteractionEvent* Create(string sAType);
+
+	// Releases an event (events from Create or from new can be released;
+	// NULL is ignored)
+	static void Release(CInteractionEvent* pieEvent);
+
+	// Enables or disables the pool (for all the threads); when disabled,
+	// Create and Release simply allocate and delete events
+	static void SetUseEventPool(bool bAUseEventPool);
+	static bool GetUseEventPool();
+
+	// Returns the allocation counters of the calling thread
+	static TEventAllocationCounters GetAllocationCounters();
+
 public:
 
 	//---------------------------------------------------------------------
@@ -133,12 +237,18 @@ public:
 	bool HasProperty(string sSlot);
 
 	// Sets a property
-	void SetProperty(string sSlot, string sValue);
+	void SetProperty(const string& sSlot, const string& sValue);
   //添加函数
   void SetProperties(STRING2STRING& s2sProperties);
-	// Returns the hash of event properties
+	// Returns the hash of event properties (a copy of them: changing it 
+	// does not change the event)
 	STRING2STRING &GetProperties();
 
+	// Access to the properties, in the order of their slot names
+	int GetPropertiesCount();
+	const string& GetPropertySlot(int iIndex);
+	const string& GetPropertyValue(int iIndex);
+
 	// returns the whole event as a string
 	string ToString();
 
@@ -147,16 +257,42 @@ public:
 	//---------------------------------------------------------------------
 	
 	// indicates if a certain dialog expectation is met by the event
-	bool Matches(string sGrammarExpectation);
+	bool Matches(const string& sGrammarExpectation);
 
 	// returns the string from the event that corresponds to a given 
 	// dialog expectation
-	string GetValueForExpectation(string sGrammarExpectation);
+	string GetValueForExpectation(const string& sGrammarExpectation);
+
+	// returns the value from the event that corresponds to a given dialog
+	// expectation, or NULL if the expectation is not met (this matches and
+	// gets the value in one go, and does not log anything)
+	const string* FindValueForExpectation(const string& sGrammarExpectation);
 
 private:
 	// performs a pattern matching between two slot names
 	// allowing for wildcards
-	bool matchesSlot( string slot, string pattern);
+	static bool matchesSlot(const TSlotPath& rspPattern, 
+		const TSlotPath& rspSlot);
+
+	// returns an expectation pattern, split into levels
+	static const TExpectationPattern& getPattern(
+		const string& sGrammarExpectation);
+
+	// returns the index of the property matching an expectation pattern, 
+	// or -1 if there is none
+	int findMatchingSlot(const TExpectationPattern& rpPattern);
+
+	// returns the index of the property for a slot, or where it would be
+	// inserted (and false) if there is none
+	bool findProperty(const string& sSlot, int& riIndex);
+
+	// brings a released event back to its initial state
+	void clear(string sAType);
+
+	// events are not copied (they hold the memory of their properties for
+	// when they are reused)
+	CInteractionEvent(const CInteractionEvent&);
+	CInteractionEvent& operator=(const CInteractionEvent&);
 };
 
 #endif // __INTERACTIONEVENT_H__
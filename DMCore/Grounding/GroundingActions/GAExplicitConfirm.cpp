@@ -52,6 +52,11 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  setting another confirmed concept drops what 
+//                           the agency resolved, instead of changing the 
+//                           tree version
+//   [2026-10-18] (agent):  setting the confirmed concept changes the tree 
+//                           version, as LocalC resolves to it
 //   [2007-03-09] (antoine): fixed a _CRequestConfirm so that it takes its
 //							 LM- and DTMF-related parameters from the
 //							 configuration of its parent agency
@@ -79,12 +84,16 @@ DEFINE_AGENCY(_CExplicitConfirm,
 
 	private: 
     // D: the concept and value that are explicitly confirmed
-    CConcept* pConfirmedConcept;
+    CConcept* pConfirmedConcept = NULL;
 
     public: 
     // D: member function for setting the concept that is confirmed
     void SetConfirmedConcept(CConcept* pAConfirmedConcept) {
+        if(pConfirmedConcept == pAConfirmedConcept)
+            return;
         pConfirmedConcept = pAConfirmedConcept;
+        // the concepts resolved through LocalC below this agency change
+        NotifyResolutionChanged();
     }
 
     // D: member function for accessing the concept that is confirmed
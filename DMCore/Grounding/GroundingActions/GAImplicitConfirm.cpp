@@ -51,6 +51,12 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  setting another confirmed concept on the inform
+//                           agent drops what it resolved, instead of 
+//                           changing the tree version
+//   [2026-10-18] (agent):  setting the confirmed concept of the inform 
+//                           agent changes the tree version, as LocalC 
+//                           resolves to it
 //   [2004-12-28] (antoine): added constructor with configuration
 //   [2003-04-15] (dbohus): started working on this
 // 
@@ -73,14 +79,18 @@ DEFINE_INFORM_AGENT(_CImplicitConfirmInform,
 
     private: 
     // D: the concept and value that are implicitly confirmed
-    CConcept* pConfirmedConcept;
+    CConcept* pConfirmedConcept = NULL;
     CHyp* pConfirmedHyp;
 
     public: 
     // D: member function for setting the concept that is confirmed
     void SetConfirmedConcept(CConcept* pAConfirmedConcept) {
+        pConfirmedHyp = pAConfirmedConcept->GetTopHyp();
+        if(pConfirmedConcept == pAConfirmedConcept)
+            return;
         pConfirmedConcept = pAConfirmedConcept;
-        pConfirmedHyp = pConfirmedConcept->GetTopHyp();
+        // the concepts resolved through LocalC on this agent change
+        NotifyResolutionChanged();
     }
 
     // D: member function for accessing the concept that is confirmed
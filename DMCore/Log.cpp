@@ -50,6 +50,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  InitLog takes its names as constant strings
 //   [2004-03-15] (dbohus):  fixed bug in logging long strings to the screen
 //   [2003-05-13] (dbohus):  changed InitializeLogging function to work with 
 //                            the new configuration parameters
@@ -273,7 +274,7 @@ int Log(string sLoggingStream, string sMessage) {
 	return Log(sLoggingStream, sMessage.c_str());
 }
 
-void InitLog(char* logName,char* logFolder) {
+void InitLog(const char* logName,const char* logFolder) {
   google::InitGoogleLogging(logName);
   FLAGS_log_dir = logFolder;
 }
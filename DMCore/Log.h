@@ -50,6 +50,7 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  InitLog takes its names as constant strings
 //   [2004-03-15] (dbohus):  fixed bug in logging long strings to the screen
 //   [2003-05-13] (dbohus):  changed InitializeLogging function to work with 
 //                            the new configuration parameters
@@ -176,7 +177,7 @@ void InitializeLogging(string sALogFolder, string sALogPrefix, string sALogFilen
 
 // D: logging closing function
 void TerminateLogging();
-void InitLog(char* logName,char* logFolder);
+void InitLog(const char* logName,const char* logFolder);
 
 void ShutdownLog();
 //-----------------------------------------------------------------------------
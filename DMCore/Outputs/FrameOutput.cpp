@@ -52,6 +52,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  an output created for a state dropped from the 
+//                           state history describes the first state kept
 //   [2005-06-02] (antoine): added the possibility to have a "prompt_header" and
 //                           "prompt_ending" parameters in the OutputManager's 
 //                           configuration, the values of which get appended 
@@ -92,7 +94,7 @@
 #include "DMCore/Agents/CoreAgents/OutputManagerAgent.h"
 
 // D: a pointer to the actual Output Manager agent
-extern COutputManagerAgent* pOutputManager;
+extern thread_local COutputManagerAgent* pOutputManager;
 
 //-----------------------------------------------------------------------------
 // D: Constructors and Destructor
@@ -134,9 +136,13 @@ bool CFrameOutput::Create(string sAGeneratorAgentName,
 	sGeneratorAgentName = sAGeneratorAgentName;
 	fsFinalFloorStatus = fsAFloor;
 
-	// Set the state index and string representation
+	// Set the state index and string representation (of the first state 
+	// kept, if the state was dropped from the state history)
 	iExecutionIndex= iAExecutionIndex;
-	sDialogState = pStateManager->GetStateAsString(pStateManager->operator[](iExecutionIndex));
+	int iState = iExecutionIndex;
+	if(iState < pStateManager->GetFirstStateIndex())
+		iState = pStateManager->GetFirstStateIndex();
+	sDialogState = pStateManager->GetStateAsString(pStateManager->operator[](iState));
 
 	// gets a reference to the sending agent
     CDialogAgent *pdaGenerator = 
@@ -0,0 +1,190 @@
+//=============================================================================
+//
+//   Copyright (c) 2000-2004, Carnegie Mellon University.  
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions
+//   are met:
+//
+//   1. Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer. 
+//
+//   2. Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//   This work was supported in part by funding from the Defense Advanced 
+//   Research Projects Agency and the National Science Foundation of the 
+//   United States of America, and the CMU Sphinx Speech Consortium.
+//
+//   THIS SOFTWARE IS PROVIDED BY CARNEGIE MELLON UNIVERSITY ``AS IS'' AND 
+//   ANY EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+//   THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//   PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL CARNEGIE MELLON UNIVERSITY
+//   NOR ITS EMPLOYEES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+//   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+//   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// 
+// SESSIONRECORD.CPP - implementation of the CSessionRecord class
+// 
+// ----------------------------------------------------------------------------
+// 
+// BEFORE MAKING CHANGES TO THIS CODE, please read the appropriate 
+// documentation, available in the Documentation folder. 
+//
+// ANY SIGNIFICANT CHANGES made should be reflected back in the documentation
+// file(s)
+//
+// ANY CHANGES made (even small bug fixes, should be reflected in the history
+// below, in reverse chronological order
+// 
+// HISTORY --------------------------------------------------------------------
+//
+//   [2026-10-18] (agent):  started working on this
+// 
+//-----------------------------------------------------------------------------
+
+#include "SessionRecord.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+CSessionRecord::CSessionRecord() {
+	uiReadPos = 0;
+	bValid = true;
+}
+
+// empties the record
+void CSessionRecord::Clear() {
+	sData = "";
+	uiReadPos = 0;
+	bValid = true;
+}
+
+//-----------------------------------------------------------------------------
+// Writing and reading fields
+//-----------------------------------------------------------------------------
+
+// appends a <length>:<bytes> field
+void CSessionRecord::WriteString(string sValue) {
+	char lpszLength[16];
+	sprintf(lpszLength, "%u:", (unsigned int)sValue.length());
+	sData += lpszLength;
+	sData += sValue;
+}
+
+void CSessionRecord::WriteInt(int iValue) {
+	char lpszValue[16];
+	sprintf(lpszValue, "%d", iValue);
+	WriteString(lpszValue);
+}
+
+void CSessionRecord::WriteBool(bool bValue) {
+	WriteString(bValue?"1":"0");
+}
+
+void CSessionRecord::WriteFloat(float fValue) {
+	char lpszValue[32];
+	sprintf(lpszValue, "%.9g", fValue);
+	WriteString(lpszValue);
+}
+
+// reads the next field
+string CSessionRecord::ReadString() {
+	if(!bValid)
+		return "";
+	// parse the length
+	unsigned int uiLength = 0;
+	unsigned int uiPos = uiReadPos;
+	while((uiPos < sData.length()) && (sData[uiPos] >= '0') && 
+		(sData[uiPos] <= '9')) {
+		uiLength = uiLength * 10 + (sData[uiPos] - '0');
+		uiPos++;
+	}
+	if((uiPos == uiReadPos) || (uiPos >= sData.length()) || 
+		(sData[uiPos] != ':') || (sData.length() - uiPos - 1 < uiLength)) {
+		bValid = false;
+		return "";
+	}
+	uiReadPos = uiPos + 1 + uiLength;
+	return sData.substr(uiPos + 1, uiLength);
+}
+
+int CSessionRecord::ReadInt() {
+	return atoi(ReadString().c_str());
+}
+
+bool CSessionRecord::ReadBool() {
+	return ReadString() == "1";
+}
+
+float CSessionRecord::ReadFloat() {
+	return (float)atof(ReadString().c_str());
+}
+
+// reads a field and checks its value
+bool CSessionRecord::Expect(string sValue) {
+	if(ReadString() != sValue)
+		bValid = false;
+	return bValid;
+}
+
+// indicates if all the reads succeeded
+bool CSessionRecord::IsValid() {
+	return bValid;
+}
+
+// marks the record as invalid
+void CSessionRecord::Invalidate() {
+	bValid = false;
+}
+
+// returns the size of the encoded record
+unsigned int CSessionRecord::GetSize() {
+	return (unsigned int)sData.length();
+}
+
+//-----------------------------------------------------------------------------
+// Storage
+//-----------------------------------------------------------------------------
+
+// writes the record to a file
+bool CSessionRecord::SaveToFile(string sFileName) {
+	FILE *fid = fopen(sFileName.c_str(), "wb");
+	if(!fid)
+		return false;
+	bool bSuccess = 
+		(fwrite(sData.data(), 1, sData.length(), fid) == sData.length());
+	if(fclose(fid) != 0)
+		bSuccess = false;
+	return bSuccess;
+}
+
+// reads the record from a file
+bool CSessionRecord::LoadFromFile(string sFileName) {
+	Clear();
+	FILE *fid = fopen(sFileName.c_str(), "rb");
+	if(!fid)
+		return false;
+	char lpszBuffer[4096];
+	size_t stRead;
+	while((stRead = fread(lpszBuffer, 1, sizeof(lpszBuffer), fid)) > 0)
+		sData.append(lpszBuffer, stRead);
+	bool bSuccess = !ferror(fid);
+	fclose(fid);
+	return bSuccess;
+}
@@ -0,0 +1,150 @@
+//=============================================================================
+//
+//   Copyright (c) 2000-2004, Carnegie Mellon University.  
+//   All rights reserved.
+//
+//   Redistribution and use in source and binary forms, with or without
+//   modification, are permitted provided that the following conditions
+//   are met:
+//
+//   1. Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer. 
+//
+//   2. Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in
+//      the documentation and/or other materials provided with the
+//      distribution.
+//
+//   This work was supported in part by funding from the Defense Advanced 
+//   Research Projects Agency and the National Science Foundation of the 
+//   United States of America, and the CMU Sphinx Speech Consortium.
+//
+//   THIS SOFTWARE IS PROVIDED BY CARNEGIE MELLON UNIVERSITY ``AS IS'' AND 
+//   ANY EXPRESSED OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+//   THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//   PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL CARNEGIE MELLON UNIVERSITY
+//   NOR ITS EMPLOYEES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+//   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+//   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+//   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+//   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+//   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// 
+// SESSIONRECORD.H - definition of the CSessionRecord class. A session record
+//                   is the compact, serialized form of the mutable state of a
+//                   dialog session (concept values, agent counters, execution
+//                   stack and histories), used to hibernate idle sessions
+// 
+// ----------------------------------------------------------------------------
+// 
+// BEFORE MAKING CHANGES TO THIS CODE, please read the appropriate 
+// documentation, available in the Documentation folder. 
+//
+// ANY SIGNIFICANT CHANGES made should be reflected back in the documentation
+// file(s)
+//
+// ANY CHANGES made (even small bug fixes, should be reflected in the history
+// below, in reverse chronological order
+// 
+// HISTORY --------------------------------------------------------------------
+//
+//   [2026-10-18] (agent):  started working on this
+// 
+//-----------------------------------------------------------------------------
+
+#pragma once
+#ifndef __SESSIONRECORD_H__
+#define __SESSIONRECORD_H__
+
+#include "Utils/Utils.h"
+
+//-----------------------------------------------------------------------------
+//
+// CSessionRecord class - a sequence of fields, written and read back in the 
+//   same order. Every field is stored as <length>:<bytes>, so strings can 
+//   hold anything (concept values span several lines); numbers are stored 
+//   in their decimal string form. Reads past the end, or of malformed 
+//   fields, invalidate the record instead of failing, so that the caller 
+//   can check IsValid() once at the end.
+//
+//-----------------------------------------------------------------------------
+
+class CSessionRecord {
+
+private:
+	//---------------------------------------------------------------------
+	// Private members
+	//---------------------------------------------------------------------
+
+	// the encoded fields
+	string sData;
+
+	// the position of the next field to be read
+	unsigned int uiReadPos;
+
+	// false once a read has failed
+	bool bValid;
+
+public:
+	//---------------------------------------------------------------------
+	// Constructor
+	//---------------------------------------------------------------------
+	//
+	CSessionRecord();
+
+	// Empties the record
+	//
+	void Clear();
+
+	//---------------------------------------------------------------------
+	// Writing and reading fields
+	//---------------------------------------------------------------------
+
+	void WriteString(string sValue);
+	void WriteInt(int iValue);
+	void WriteBool(bool bValue);
+	void WriteFloat(float fValue);
+
+	string ReadString();
+	int ReadInt();
+	bool ReadBool();
+	float ReadFloat();
+
+	// Reads a string field and checks that it has the expected value (used
+	// for the tags and names that delimit the parts of the record)
+	//
+	bool Expect(string sValue);
+
+	// Indicates if all the reads so far succeeded
+	//
+	bool IsValid();
+
+	// Marks the record as invalid (when the contents do not match what 
+	// the reader expects)
+	//
+	void Invalidate();
+
+	// Returns the size of the encoded record, in bytes
+	//
+	unsigned int GetSize();
+
+	//---------------------------------------------------------------------
+	// Storage
+	//---------------------------------------------------------------------
+
+	// Writes the record to a file (returns false on failure)
+	//
+	bool SaveToFile(string sFileName);
+
+	// Reads the record from a file, and rewinds it for reading (returns
+	// false on failure)
+	//
+	bool LoadFromFile(string sFileName);
+};
+
+#endif // __SESSIONRECORD_H__
@@ -1,4 +1,63 @@
 #include "message.h"
 
-threadsafe_queue<std::string> input_queue;
-threadsafe_queue<std::string> output_queue;
+message_router session_router;
+
+message_router::message_router() {
+}
+
+message_router::shard &message_router::shard_for(int session_id) {
+  return shards[(unsigned)session_id % shards_count];
+}
+
+std::shared_ptr<session_mailbox> message_router::open(int session_id) {
+  shard &s = shard_for(session_id);
+  std::lock_guard<std::mutex> lk(s.mut);
+  std::shared_ptr<session_mailbox> &mailbox = s.mailboxes[session_id];
+  if (!mailbox) {
+    mailbox = std::make_shared<session_mailbox>(session_id);
+    mailbox->inbound.set_capacity(inbound_limit.capacity,
+                                  inbound_limit.policy);
+    mailbox->outbound.set_capacity(outbound_limit.capacity,
+                                   outbound_limit.policy);
+  }
+  return mailbox;
+}
+
+void message_router::close(int session_id) {
+  shard &s = shard_for(session_id);
+  std::lock_guard<std::mutex> lk(s.mut);
+  s.mailboxes.erase(session_id);
+}
+
+std::shared_ptr<session_mailbox> message_router::find(int session_id) {
+  shard &s = shard_for(session_id);
+  std::lock_guard<std::mutex> lk(s.mut);
+  std::map<int, std::shared_ptr<session_mailbox> >::iterator it =
+      s.mailboxes.find(session_id);
+  if (it == s.mailboxes.end())
+    return std::shared_ptr<session_mailbox>();
+  return it->second;
+}
+
+bool message_router::deliver(int session_id, std::string message) {
+  std::shared_ptr<session_mailbox> mailbox = find(session_id);
+  if (!mailbox)
+    return false;
+  if (!pushMessage(mailbox->inbound, message))
+    return false;
+  if (on_delivery)
+    on_delivery(session_id);
+  return true;
+}
+
+void message_router::set_delivery_listener(delivery_listener listener) {
+  on_delivery = listener;
+}
+
+void message_router::set_inbound_limit(mailbox_limit limit) {
+  inbound_limit = limit;
+}
+
+void message_router::set_outbound_limit(mailbox_limit limit) {
+  outbound_limit = limit;
+}
@@ -9,17 +9,92 @@
 // Author: ShenChengEn - ubuntu733@gmail.com
 // Description: ---
 // Create: 2017-03-22 14:33:54
-// Last Modified: 2017-03-22 14:33:54
+// Last Modified: 2026-10-18 (per-session mailboxes and the message router
+//                replace the global input_queue/output_queue; bounded
+//                mailboxes and timed waits)
 //***********************************************
 //
 #include "threadsafe_queue.h"
 #include "memory"
-extern threadsafe_queue<std::string> input_queue;
-extern threadsafe_queue<std::string> output_queue;
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+// the inbound (user -> dialog) and outbound (dialog -> user) queues of one
+// dialog session
+struct session_mailbox {
+  int session_id;
+  threadsafe_queue<std::string> inbound;
+  threadsafe_queue<std::string> outbound;
+
+  explicit session_mailbox(int id) : session_id(id) {}
+};
+
+// the capacity (0 = unbounded) and overflow policy of a mailbox queue
+struct mailbox_limit {
+  size_t capacity;
+  overflow_policy policy;
+
+  mailbox_limit(size_t c = 0, overflow_policy p = overflow_block)
+    : capacity(c), policy(p) {}
+};
+
+// keeps the mailboxes by session id and routes messages to them. The table
+// is split in shards, each with its own lock, so that looking up one
+// session does not contend with traffic for the others; after the lookup
+// only the session's own queue is locked.
+class message_router {
+public:
+  // called after an inbound message was delivered to a session
+  typedef std::function<void(int)> delivery_listener;
+
+  message_router();
+
+  // creates the mailbox of a session (or returns the existing one)
+  std::shared_ptr<session_mailbox> open(int session_id);
+
+  // forgets the mailbox of a session; holders of the mailbox keep it alive
+  void close(int session_id);
+
+  // returns the mailbox of a session, or an empty pointer
+  std::shared_ptr<session_mailbox> find(int session_id);
+
+  // pushes a message into the inbound queue of a session, and tells the
+  // delivery listener; returns false if the session has no mailbox or the
+  // message was refused because the mailbox is full
+  bool deliver(int session_id, std::string message);
+
+  void set_delivery_listener(delivery_listener listener);
+
+  // limits for the mailboxes opened from now on. Under overload, bounded
+  // mailboxes shed messages according to their policy instead of growing
+  // without limit. The outbound queue is filled by the dialog workers, so
+  // it should not use overflow_block.
+  void set_inbound_limit(mailbox_limit limit);
+  void set_outbound_limit(mailbox_limit limit);
+
+private:
+  static const int shards_count = 16;
+
+  struct shard {
+    std::mutex mut;
+    std::map<int, std::shared_ptr<session_mailbox> > mailboxes;
+  };
+
+  shard &shard_for(int session_id);
+
+  shard shards[shards_count];
+  delivery_listener on_delivery;
+  mailbox_limit inbound_limit;
+  mailbox_limit outbound_limit;
+};
+
+extern message_router session_router;
 
 template<class T>
-void pushMessage(threadsafe_queue<T> &q,T value) {
-  q.push(value);
+bool pushMessage(threadsafe_queue<T> &q,T value) {
+  return q.push(value);
 }
 
 
@@ -29,4 +104,11 @@ std::shared_ptr<T> waitMessage(threadsafe_queue<T> &q) {
   return q.wait_and_pop();
 }
 
+// waits at most the given time; returns an empty pointer on timeout
+template<typename T, typename Rep, typename Period>
+std::shared_ptr<T> waitMessageFor(threadsafe_queue<T> &q,
+  const std::chrono::duration<Rep, Period> &timeout) {
+  return q.wait_for_and_pop(timeout);
+}
+
 #endif
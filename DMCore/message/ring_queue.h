@@ -0,0 +1,229 @@
+#pragma once
+#ifndef _RING_QUEUE_H_
+#define _RING_QUEUE_H_
+
+//***********************************************
+//
+// Filename: DMCore/message/ring_queue.h
+//
+// Description: bounded lock-free ring-buffer queue, an alternative to
+//              threadsafe_queue for the message paths. Elements are stored
+//              by value in a preallocated ring (no allocation per message),
+//              push only takes rvalues, and consumers can drain several
+//              elements at once with pop_batch/pop_all. Any number of
+//              producers can push concurrently (MPSC; SPSC is the special
+//              case of one producer). Consumers only block when the queue
+//              is empty, and producers only touch the mutex/condition
+//              variable when a consumer is actually asleep, i.e. on the
+//              empty -> non-empty transition.
+// Create: 2026-10-18
+//***********************************************
+//
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template<typename T>
+class ring_queue {
+public:
+  // the capacity is rounded up to a power of two
+  explicit ring_queue(size_t capacity = 1024);
+
+  ~ring_queue();
+
+  // pushes a value, returns false (and leaves the value alone) if the
+  // queue is full
+  bool try_push(T &&value);
+
+  // pushes a value, yielding while the queue is full
+  void push(T &&value);
+
+  bool try_pop(T &value);
+
+  void wait_and_pop(T &value);
+
+  // pops up to max_count values (appended to out), returns how many
+  size_t pop_batch(std::vector<T> &out, size_t max_count);
+
+  // pops everything that is in the queue right now
+  size_t pop_all(std::vector<T> &out);
+
+  // waits until the queue is not empty
+  void wait();
+
+  bool empty() const;
+
+  size_t capacity() const;
+
+private:
+  ring_queue(const ring_queue &);
+  ring_queue &operator=(const ring_queue &);
+
+  // every cell carries a sequence number: it equals the position when the
+  // cell is free for the producer of that position, and position + 1 once
+  // the value there can be consumed
+  struct cell {
+    std::atomic<size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  T *value_at(cell &c) { return reinterpret_cast<T *>(&c.storage); }
+
+  void wake_consumers();
+
+  static const size_t cache_line = 64;
+
+  cell *buffer;
+  size_t mask;
+
+  // producers and consumers advance different counters; keep them on
+  // different cache lines
+  char pad0[cache_line];
+  std::atomic<size_t> enqueue_pos;
+  char pad1[cache_line - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> dequeue_pos;
+  char pad2[cache_line - sizeof(std::atomic<size_t>)];
+
+  std::atomic<int> sleepers;
+  std::mutex wait_mut;
+  std::condition_variable wait_cond;
+};
+
+template<typename T>
+ring_queue<T>::ring_queue(size_t capacity)
+    : enqueue_pos(0), dequeue_pos(0), sleepers(0) {
+  size_t size = 2;
+  while (size < capacity)
+    size <<= 1;
+  mask = size - 1;
+  buffer = new cell[size];
+  for (size_t i = 0; i < size; i++)
+    buffer[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template<typename T>
+ring_queue<T>::~ring_queue() {
+  T value;
+  while (try_pop(value)) {
+  }
+  delete[] buffer;
+}
+
+template<typename T>
+bool ring_queue<T>::try_push(T &&value) {
+  size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+  cell *c;
+  while (true) {
+    c = &buffer[pos & mask];
+    size_t seq = c->sequence.load(std::memory_order_acquire);
+    std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+    if (diff == 0) {
+      if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+  new (&c->storage) T(std::move(value));
+  c->sequence.store(pos + 1, std::memory_order_release);
+  wake_consumers();
+  return true;
+}
+
+template<typename T>
+void ring_queue<T>::push(T &&value) {
+  while (!try_push(std::move(value)))
+    std::this_thread::yield();
+}
+
+template<typename T>
+bool ring_queue<T>::try_pop(T &value) {
+  size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+  cell *c;
+  while (true) {
+    c = &buffer[pos & mask];
+    size_t seq = c->sequence.load(std::memory_order_acquire);
+    std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+    if (diff == 0) {
+      if (dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = dequeue_pos.load(std::memory_order_relaxed);
+    }
+  }
+  T *stored = value_at(*c);
+  value = std::move(*stored);
+  stored->~T();
+  c->sequence.store(pos + mask + 1, std::memory_order_release);
+  return true;
+}
+
+template<typename T>
+void ring_queue<T>::wait_and_pop(T &value) {
+  while (!try_pop(value))
+    wait();
+}
+
+template<typename T>
+size_t ring_queue<T>::pop_batch(std::vector<T> &out, size_t max_count) {
+  size_t count = 0;
+  T value;
+  while (count < max_count && try_pop(value)) {
+    out.push_back(std::move(value));
+    count++;
+  }
+  return count;
+}
+
+template<typename T>
+size_t ring_queue<T>::pop_all(std::vector<T> &out) {
+  return pop_batch(out, mask + 1);
+}
+
+template<typename T>
+void ring_queue<T>::wait() {
+  if (!empty())
+    return;
+  std::unique_lock<std::mutex> lk(wait_mut);
+  // announce ourselves before the last look at the queue; a producer that
+  // publishes after this point sees us and takes the slow path
+  sleepers.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  wait_cond.wait(lk, [this] { return !empty(); });
+  sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template<typename T>
+void ring_queue<T>::wake_consumers() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleepers.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> lk(wait_mut);
+    wait_cond.notify_all();
+  }
+}
+
+template<typename T>
+bool ring_queue<T>::empty() const {
+  size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+  return buffer[pos & mask].sequence.load(std::memory_order_acquire) !=
+         pos + 1;
+}
+
+template<typename T>
+size_t ring_queue<T>::capacity() const {
+  return mask + 1;
+}
+
+#endif //_RING_QUEUE_H_
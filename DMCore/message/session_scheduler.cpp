@@ -0,0 +1,333 @@
+//***********************************************
+//
+// Filename: DMCore/message/session_scheduler.cpp
+//
+// Description: worker pool with work-stealing run queues for dialog
+//              sessions (see session_scheduler.h)
+// Create: 2026-10-18
+//***********************************************
+//
+#include "session_scheduler.h"
+#include "DMCore/DialogSession.h"
+#include "DMCore/Events/InteractionEvent.h"
+#include "DMCore/Agents/CoreAgents/InteractionEventManagerAgent.h"
+
+#include <cstdio>
+
+session_scheduler::session_entry::~session_entry() {
+  // events that were posted but never stepped
+  for (unsigned i = 0; i < inbox.size(); i++)
+    CInteractionEvent::Release(inbox[i]);
+}
+
+session_scheduler::session_scheduler(unsigned worker_count)
+    : workers_count(worker_count), next_home(0), pending(0),
+      stopping(false), idle_timers(std::chrono::seconds(1)),
+      hibernate_after(0) {
+  if (workers_count == 0)
+    workers_count = std::thread::hardware_concurrency();
+  if (workers_count == 0)
+    workers_count = 1;
+  for (unsigned i = 0; i < workers_count; i++)
+    workers.push_back(new worker());
+  timeouts.set_expiry_callback(
+      [this](int session_id, unsigned long generation) {
+        post_timeout(session_id, generation);
+      });
+  idle_timers.set_expiry_callback(
+      [this](int session_id, unsigned long generation) {
+        request_hibernation(session_id, generation);
+      });
+}
+
+session_scheduler::~session_scheduler() {
+  stop();
+  for (unsigned i = 0; i < workers.size(); i++)
+    delete workers[i];
+  std::map<int, entry_ptr>::iterator it;
+  for (it = sessions.begin(); it != sessions.end(); it++)
+    idle_timers.cancel(it->second->idle_timer);
+}
+
+void session_scheduler::start() {
+  {
+    std::lock_guard<std::mutex> lk(sleep_mut);
+    stopping = false;
+  }
+  for (unsigned i = 0; i < workers.size(); i++) {
+    if (!workers[i]->thread.joinable())
+      workers[i]->thread =
+          std::thread(&session_scheduler::worker_loop, this, i);
+  }
+  timeouts.start();
+  if (hibernate_after.count() > 0)
+    idle_timers.start();
+}
+
+void session_scheduler::stop() {
+  timeouts.stop();
+  idle_timers.stop();
+  {
+    std::lock_guard<std::mutex> lk(sleep_mut);
+    stopping = true;
+  }
+  sleep_cond.notify_all();
+  for (unsigned i = 0; i < workers.size(); i++) {
+    if (workers[i]->thread.joinable())
+      workers[i]->thread.join();
+  }
+}
+
+void session_scheduler::add_session(CDialogSession *session) {
+  entry_ptr entry = std::make_shared<session_entry>(
+      session, next_home++ % workers_count, session->GetSessionID());
+  {
+    std::lock_guard<std::mutex> lk(sessions_mut);
+    sessions[session->GetSessionID()] = entry;
+  }
+  session->SetTimeoutWheel(&timeouts);
+  // the first step starts the dialog task
+  entry->state = session_entry::queued;
+  schedule(entry);
+}
+
+void session_scheduler::remove_session(int session_id) {
+  entry_ptr entry;
+  {
+    std::lock_guard<std::mutex> lk(sessions_mut);
+    std::map<int, entry_ptr>::iterator it = sessions.find(session_id);
+    if (it == sessions.end())
+      return;
+    entry = it->second;
+    sessions.erase(it);
+  }
+  entry->session->SetTimeoutWheel(NULL);
+  // posts, wakes and runs that already hold the entry see the flag; the
+  // entry itself goes away with the last of them
+  std::lock_guard<std::mutex> lk(entry->inbox_mut);
+  entry->removed = true;
+  idle_timers.cancel(entry->idle_timer);
+}
+
+bool session_scheduler::post(int session_id, CInteractionEvent *event) {
+  entry_ptr entry = find(session_id);
+  if (!entry)
+    return false;
+  {
+    std::lock_guard<std::mutex> lk(entry->inbox_mut);
+    if (entry->removed || entry->state == session_entry::finished)
+      return false;
+    entry->inbox.push_back(event);
+  }
+  mark_runnable(entry);
+  return true;
+}
+
+bool session_scheduler::wake(int session_id) {
+  entry_ptr entry = find(session_id);
+  if (!entry)
+    return false;
+  {
+    std::lock_guard<std::mutex> lk(entry->inbox_mut);
+    if (entry->removed || entry->state == session_entry::finished)
+      return false;
+    entry->woken = true;
+  }
+  mark_runnable(entry);
+  return true;
+}
+
+void session_scheduler::post_timeout(int session_id,
+                                     unsigned long generation) {
+  // the session recognizes (and drops) timeouts that were re-armed or
+  // cancelled after this one expired by the generation
+  CInteractionEvent *event =
+      CInteractionEventManagerAgent::CreateTimeoutEvent();
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%lu", generation);
+  event->SetProperty("[timer]", buffer);
+  if (!post(session_id, event))
+    CInteractionEvent::Release(event);
+}
+
+void session_scheduler::request_hibernation(int session_id,
+                                            unsigned long generation) {
+  entry_ptr entry = find(session_id);
+  // the session ran (and re-armed its idle timer) since this one expired
+  if (!entry || entry->idle_generation != generation)
+    return;
+  entry->hibernate_requested = true;
+  mark_runnable(entry);
+}
+
+bool session_scheduler::hibernate(session_entry *entry) {
+  char file_name[64];
+  snprintf(file_name, sizeof(file_name), "/session_%d.rec",
+           entry->session->GetSessionID());
+  return entry->session->Hibernate(hibernate_directory + file_name);
+}
+
+void session_scheduler::set_finished_callback(finished_callback callback) {
+  on_finished = callback;
+}
+
+void session_scheduler::set_hibernation(std::chrono::seconds idle,
+                                        std::string directory) {
+  hibernate_after = idle;
+  hibernate_directory = directory.empty() ? std::string(".") : directory;
+}
+
+unsigned session_scheduler::worker_count() const {
+  return workers_count;
+}
+
+session_scheduler::entry_ptr session_scheduler::find(int session_id) {
+  std::lock_guard<std::mutex> lk(sessions_mut);
+  std::map<int, entry_ptr>::iterator it = sessions.find(session_id);
+  if (it == sessions.end())
+    return entry_ptr();
+  return it->second;
+}
+
+void session_scheduler::mark_runnable(const entry_ptr &entry) {
+  // only the idle -> queued transition schedules; a queued or running
+  // session picks the new input up when it runs
+  int expected = session_entry::idle;
+  if (entry->state.compare_exchange_strong(expected, session_entry::queued))
+    schedule(entry);
+}
+
+void session_scheduler::schedule(const entry_ptr &entry) {
+  worker *home = workers[entry->home_worker];
+  {
+    std::lock_guard<std::mutex> lk(home->mut);
+    home->runnable.push_back(entry);
+  }
+  {
+    std::lock_guard<std::mutex> lk(sleep_mut);
+    pending++;
+  }
+  sleep_cond.notify_one();
+}
+
+session_scheduler::entry_ptr session_scheduler::pop_local(unsigned index) {
+  worker *self = workers[index];
+  std::lock_guard<std::mutex> lk(self->mut);
+  if (self->runnable.empty())
+    return entry_ptr();
+  entry_ptr entry = self->runnable.back();
+  self->runnable.pop_back();
+  return entry;
+}
+
+session_scheduler::entry_ptr session_scheduler::steal(unsigned index) {
+  for (unsigned i = 1; i < workers_count; i++) {
+    worker *victim = workers[(index + i) % workers_count];
+    std::lock_guard<std::mutex> lk(victim->mut);
+    if (!victim->runnable.empty()) {
+      entry_ptr entry = victim->runnable.front();
+      victim->runnable.pop_front();
+      return entry;
+    }
+  }
+  return entry_ptr();
+}
+
+void session_scheduler::run(unsigned index, const entry_ptr &entry) {
+  entry->state = session_entry::running;
+  // the session now lives on this worker
+  entry->home_worker = index;
+
+  std::vector<CInteractionEvent *> events;
+  bool woken;
+  {
+    std::lock_guard<std::mutex> lk(entry->inbox_mut);
+    // the session was removed while it was queued; it may be gone already
+    if (entry->removed) {
+      entry->state = session_entry::finished;
+      return;
+    }
+    events.swap(entry->inbox);
+    woken = entry->woken;
+    entry->woken = false;
+  }
+
+  CDialogSession *session = entry->session;
+  bool hibernate_requested = entry->hibernate_requested.exchange(false);
+  if (hibernate_requested && events.empty() && !woken &&
+      !session->IsHibernated()) {
+    // the session has been idle for long enough, and still is; keep it on
+    // disk until its next input arrives (if it cannot be hibernated, it
+    // simply stays in memory)
+    hibernate(entry.get());
+    finish_run(entry);
+    return;
+  }
+
+  // the first step starts the dialog task (or restores a hibernated
+  // session), or picks up whatever arrived in the session's mailbox
+  bool finished = !session->Step();
+  unsigned stepped = 0;
+  for (; stepped < events.size() && !finished; stepped++)
+    finished = !session->Step(events[stepped]);
+
+  if (finished) {
+    // events that arrived after the end of the dialog
+    for (; stepped < events.size(); stepped++)
+      CInteractionEvent::Release(events[stepped]);
+    // nobody will step this session again
+    {
+      std::lock_guard<std::mutex> lk(entry->inbox_mut);
+      entry->state = session_entry::finished;
+    }
+    if (on_finished)
+      on_finished(session);
+    return;
+  }
+
+  // start timing how long the session waits for input
+  if (hibernate_after.count() > 0) {
+    std::lock_guard<std::mutex> lk(entry->inbox_mut);
+    if (!entry->removed)
+      entry->idle_generation = idle_timers.arm(
+          entry->idle_timer,
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              hibernate_after));
+  }
+  finish_run(entry);
+}
+
+void session_scheduler::finish_run(const entry_ptr &entry) {
+  entry->state = session_entry::idle;
+  // an event may have been posted while we were running; if so (and no
+  // one else scheduled the session meanwhile), run it again
+  bool has_input;
+  {
+    std::lock_guard<std::mutex> lk(entry->inbox_mut);
+    has_input = !entry->inbox.empty() || entry->woken;
+  }
+  int expected = session_entry::idle;
+  if (has_input &&
+      entry->state.compare_exchange_strong(expected, session_entry::queued))
+    schedule(entry);
+}
+
+void session_scheduler::worker_loop(unsigned index) {
+  while (true) {
+    entry_ptr entry = pop_local(index);
+    if (!entry)
+      entry = steal(index);
+    if (entry) {
+      {
+        std::lock_guard<std::mutex> lk(sleep_mut);
+        pending--;
+      }
+      run(index, entry);
+      continue;
+    }
+    std::unique_lock<std::mutex> lk(sleep_mut);
+    sleep_cond.wait(lk, [this] { return stopping || pending > 0; });
+    if (stopping)
+      return;
+  }
+}
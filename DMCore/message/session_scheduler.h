@@ -0,0 +1,162 @@
+#pragma once
+#ifndef _SESSION_SCHEDULER_H_
+#define _SESSION_SCHEDULER_H_
+
+//***********************************************
+//
+// Filename: DMCore/message/session_scheduler.h
+//
+// Description: maps runnable dialog sessions onto a fixed pool of worker
+//              threads. Every worker owns a run deque; idle workers steal
+//              from the others, and a session is always re-queued on the
+//              worker that ran it last, so its state stays warm in that
+//              core's caches. The scheduler also runs the timing wheel
+//              that times the sessions' turn timeouts; an expired timeout is
+//              posted to its session like any other event. Optionally,
+//              sessions that stay idle for a while are hibernated to disk
+//              (see CDialogSession::Hibernate) and restored transparently
+//              when their next input arrives.
+// Create: 2026-10-18
+//***********************************************
+//
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "timing_wheel.h"
+
+class CDialogSession;
+class CInteractionEvent;
+
+class session_scheduler {
+public:
+  // called on the worker thread once a session's dialog task completes
+  typedef std::function<void(CDialogSession *)> finished_callback;
+
+  explicit session_scheduler(unsigned worker_count = 0);
+
+  ~session_scheduler();
+
+  // starts the workers (worker_count == 0 means one per hardware thread)
+  // and the timeout wheel
+  void start();
+
+  // stops the workers, after they finish the steps they are running, and
+  // the timeout wheel
+  void stop();
+
+  // adds a session and schedules its first step; the scheduler does not
+  // own the session, but times its turn timeouts until it is removed (or
+  // destroyed)
+  void add_session(CDialogSession *session);
+
+  // removes a session: input posted to it from now on is refused, and a
+  // step that was queued for it is dropped. The scheduler forgets the
+  // session, but a step already running on a worker completes, so the
+  // session must not be destroyed until then (e.g. remove it once it
+  // finished, or after stop)
+  void remove_session(int session_id);
+
+  // queues an input event for a session and marks the session runnable;
+  // returns false (and the caller keeps the event) if there is no such
+  // session, or its dialog has finished
+  bool post(int session_id, CInteractionEvent *event);
+
+  // marks a session runnable because input arrived in its mailbox (see
+  // message_router::set_delivery_listener)
+  bool wake(int session_id);
+
+  void set_finished_callback(finished_callback callback);
+
+  // hibernates the sessions that have been waiting for input for longer
+  // than idle into record files in directory; a zero idle time turns
+  // hibernation off (the default). Call before start
+  void set_hibernation(std::chrono::seconds idle, std::string directory);
+
+  unsigned worker_count() const;
+
+private:
+  // per-session scheduling record; the entries are shared by the session
+  // table, the run deques and the threads using them, so an entry lives
+  // until it is removed and no longer queued, running or being posted to
+  struct session_entry {
+    enum { idle, queued, running, finished };
+
+    CDialogSession *session;
+    std::mutex inbox_mut;
+    std::vector<CInteractionEvent *> inbox;  // events not yet stepped
+    bool woken;                              // mailbox input not yet seen
+    bool removed;                            // see remove_session
+    std::atomic<int> state;
+    std::atomic<unsigned> home_worker;       // where it ran last
+
+    // times how long the session has been waiting for input; when it
+    // expires (and the session did not run since), the next run
+    // hibernates the session instead of stepping it (armed and cancelled
+    // under inbox_mut, so that it is never armed after the removal)
+    timing_wheel::timer idle_timer;
+    std::atomic<unsigned long> idle_generation;
+    std::atomic<bool> hibernate_requested;
+
+    explicit session_entry(CDialogSession *s, unsigned home, int id)
+        : session(s), woken(false), removed(false), state(idle),
+          home_worker(home),
+          idle_timer(id), idle_generation(0), hibernate_requested(false) {}
+    ~session_entry();
+  };
+
+  // a worker's run deque: the owner pushes and pops at the back, thieves
+  // take from the front
+  struct worker {
+    std::mutex mut;
+    std::deque<std::shared_ptr<session_entry> > runnable;
+    std::thread thread;
+  };
+
+  typedef std::shared_ptr<session_entry> entry_ptr;
+
+  entry_ptr find(int session_id);
+  void mark_runnable(const entry_ptr &entry);
+  void schedule(const entry_ptr &entry);
+  entry_ptr pop_local(unsigned index);
+  entry_ptr steal(unsigned index);
+  void run(unsigned index, const entry_ptr &entry);
+  void finish_run(const entry_ptr &entry);
+  void worker_loop(unsigned index);
+  void post_timeout(int session_id, unsigned long generation);
+  void request_hibernation(int session_id, unsigned long generation);
+  bool hibernate(session_entry *entry);
+
+  unsigned workers_count;
+  std::vector<worker *> workers;
+  std::atomic<unsigned> next_home;
+
+  std::mutex sessions_mut;
+  std::map<int, entry_ptr> sessions;
+
+  // idle workers sleep here until something gets queued
+  std::mutex sleep_mut;
+  std::condition_variable sleep_cond;
+  int pending;
+  bool stopping;
+
+  finished_callback on_finished;
+
+  // the turn timeouts of all the sessions
+  timing_wheel timeouts;
+
+  // the idle timers of all the sessions (one second ticks), and where
+  // and when the idle sessions get hibernated
+  timing_wheel idle_timers;
+  std::chrono::seconds hibernate_after;
+  std::string hibernate_directory;
+};
+
+#endif
@@ -13,7 +13,8 @@
 // Author: ShenChengEn - ubuntu733@gmail.com
 // Description: ---
 // Create: 2017-03-22 10:28:11
-// Last Modified: 2017-03-22 10:28:11
+// Last Modified: 2026-10-18 (optional capacity with an overflow policy,
+//                deadline-based pops)
 //***********************************************
 //
 
@@ -24,10 +25,21 @@
 #include <mutex>
 #include <condition_variable>
 #include <memory>
+#include <chrono>
+
+// what push does when a bounded queue is full
+enum overflow_policy {
+  overflow_block,        // wait until there is room
+  overflow_drop_oldest,  // discard the oldest element to make room
+  overflow_reject        // refuse the new element
+};
+
 template<typename T>
 class threadsafe_queue {
 public:
-  threadsafe_queue();
+  // capacity 0 means unbounded
+  explicit threadsafe_queue(size_t capacity = 0,
+                            overflow_policy policy = overflow_block);
 
   ~threadsafe_queue();
 
@@ -35,21 +47,46 @@ public:
 
   std::shared_ptr<T> wait_and_pop();
 
+  // wait for an element at most until the deadline / for the given time;
+  // return an empty pointer on timeout
+  template<typename Clock, typename Duration>
+  std::shared_ptr<T> wait_until_and_pop(
+      const std::chrono::time_point<Clock, Duration>& deadline);
+
+  template<typename Rep, typename Period>
+  std::shared_ptr<T> wait_for_and_pop(
+      const std::chrono::duration<Rep, Period>& timeout);
+
   bool try_pop(T& value);
 
   std::shared_ptr<T> try_pop();
 
   bool empty() const;
 
-  void push(T new_value);
+  size_t size() const;
+
+  // returns false if the element was refused (overflow_reject) 
+  bool push(T new_value);
+
+  // changes the limits; elements above a lowered capacity stay queued
+  void set_capacity(size_t capacity, overflow_policy policy);
+
+  // number of elements discarded or refused because the queue was full
+  size_t overflow_count() const;
 
 public:
   mutable std::mutex mut;
   std::queue<std::shared_ptr<T> > data_queue;
   std::condition_variable data_cond;
+  std::condition_variable space_cond;
+  size_t max_size;
+  overflow_policy on_overflow;
+  size_t overflows;
 };
 template<typename T>
-threadsafe_queue<T>::threadsafe_queue(){
+threadsafe_queue<T>::threadsafe_queue(size_t capacity,
+                                      overflow_policy policy)
+  : max_size(capacity), on_overflow(policy), overflows(0) {
 
 }
 
@@ -62,6 +99,7 @@ void threadsafe_queue<T>::wait_and_pop(T& value) {
   data_cond.wait(lk,[this]{return !data_queue.empty();});
   value=std::move(*data_queue.front());
   data_queue.pop();
+  space_cond.notify_one();
 }
 
 template<typename T>
@@ -71,6 +109,8 @@ bool threadsafe_queue<T>::try_pop(T& value) {
     return false;
   value=std::move(*data_queue.front());
   data_queue.pop();
+  space_cond.notify_one();
+  return true;
 }
 
 template<typename T>
@@ -79,9 +119,31 @@ std::shared_ptr<T> threadsafe_queue<T>::wait_and_pop() {
   data_cond.wait(lk,[this]{return !data_queue.empty();});
   std::shared_ptr<T> res=data_queue.front();
   data_queue.pop();
+  space_cond.notify_one();
   return res;
 }
 
+template<typename T>
+template<typename Clock, typename Duration>
+std::shared_ptr<T> threadsafe_queue<T>::wait_until_and_pop(
+    const std::chrono::time_point<Clock, Duration>& deadline) {
+  std::unique_lock<std::mutex> lk(mut);
+  if(!data_cond.wait_until(lk,deadline,
+                           [this]{return !data_queue.empty();}))
+    return std::shared_ptr<T>();
+  std::shared_ptr<T> res=data_queue.front();
+  data_queue.pop();
+  space_cond.notify_one();
+  return res;
+}
+
+template<typename T>
+template<typename Rep, typename Period>
+std::shared_ptr<T> threadsafe_queue<T>::wait_for_and_pop(
+    const std::chrono::duration<Rep, Period>& timeout) {
+  return wait_until_and_pop(std::chrono::steady_clock::now() + timeout);
+}
+
 template<typename T>
 std::shared_ptr<T> threadsafe_queue<T>::try_pop() {
   std::lock_guard<std::mutex> lk(mut);
@@ -89,6 +151,7 @@ std::shared_ptr<T> threadsafe_queue<T>::try_pop() {
     return std::shared_ptr<T>();
   std::shared_ptr<T> res=data_queue.front();
   data_queue.pop();
+  space_cond.notify_one();
   return res;
 }
 
@@ -99,12 +162,51 @@ bool threadsafe_queue<T>::empty() const {
 }
 
 template<typename T>
-void  threadsafe_queue<T>::push(T new_value) {
+size_t threadsafe_queue<T>::size() const {
+  std::lock_guard<std::mutex> lk(mut);
+  return data_queue.size();
+}
+
+template<typename T>
+bool threadsafe_queue<T>::push(T new_value) {
   std::shared_ptr<T> data(
           std::make_shared<T>(std::move(new_value)));
-  std::lock_guard<std::mutex> lk(mut);
+  std::unique_lock<std::mutex> lk(mut);
+  if(max_size > 0 && data_queue.size() >= max_size) {
+    switch(on_overflow) {
+    case overflow_block:
+      space_cond.wait(lk,[this]{
+        return max_size == 0 || data_queue.size() < max_size;});
+      break;
+    case overflow_drop_oldest:
+      while(data_queue.size() >= max_size) {
+        data_queue.pop();
+        overflows++;
+      }
+      break;
+    case overflow_reject:
+      overflows++;
+      return false;
+    }
+  }
   data_queue.push(data);
   data_cond.notify_one();
+  return true;
+}
+
+template<typename T>
+void threadsafe_queue<T>::set_capacity(size_t capacity,
+                                       overflow_policy policy) {
+  std::lock_guard<std::mutex> lk(mut);
+  max_size = capacity;
+  on_overflow = policy;
+  space_cond.notify_all();
+}
+
+template<typename T>
+size_t threadsafe_queue<T>::overflow_count() const {
+  std::lock_guard<std::mutex> lk(mut);
+  return overflows;
 }
 
 
@@ -0,0 +1,215 @@
+//***********************************************
+//
+// Filename: DMCore/message/timing_wheel.cpp
+//
+// Description: hierarchical timing wheel for the per-session turn timeouts
+//              (see timing_wheel.h)
+// Create: 2026-10-18
+//***********************************************
+//
+#include "timing_wheel.h"
+
+timing_wheel::timing_wheel(std::chrono::milliseconds tick)
+    : tick_length(tick), now(0), armed_timers(0), running(false) {
+  if (tick_length.count() <= 0)
+    tick_length = std::chrono::milliseconds(1);
+  for (unsigned l = 0; l < levels; l++)
+    for (unsigned s = 0; s < level_size; s++)
+      slots[l][s] = NULL;
+}
+
+timing_wheel::~timing_wheel() {
+  stop();
+  // leave the remaining timers (owned by their sessions) unlinked
+  for (unsigned l = 0; l < levels; l++) {
+    for (unsigned s = 0; s < level_size; s++) {
+      timer *t = slots[l][s];
+      while (t) {
+        timer *next = t->next;
+        t->next = NULL;
+        t->pprev = NULL;
+        t = next;
+      }
+      slots[l][s] = NULL;
+    }
+  }
+}
+
+void timing_wheel::set_expiry_callback(expiry_callback callback) {
+  std::lock_guard<std::mutex> lk(mut);
+  on_expiry = callback;
+}
+
+void timing_wheel::start() {
+  std::lock_guard<std::mutex> lk(mut);
+  if (running)
+    return;
+  running = true;
+  ticker = std::thread(&timing_wheel::ticker_loop, this);
+}
+
+void timing_wheel::stop() {
+  {
+    std::lock_guard<std::mutex> lk(mut);
+    running = false;
+  }
+  cond.notify_all();
+  if (ticker.joinable())
+    ticker.join();
+}
+
+unsigned long timing_wheel::arm(timer &t, std::chrono::milliseconds delay) {
+  // round up, so a timer never fires early
+  int64_t ticks = (delay.count() + tick_length.count() - 1) /
+                  tick_length.count();
+  if (ticks < 1)
+    ticks = 1;
+
+  bool was_idle;
+  unsigned long generation;
+  {
+    std::lock_guard<std::mutex> lk(mut);
+    if (t.armed())
+      unlink(t);
+    else
+      armed_timers++;
+    was_idle = armed_timers == 1;
+    generation = ++t.generation;
+    t.expires = now + (uint64_t)ticks;
+    link(t);
+  }
+  // the ticker sleeps while there is nothing to time
+  if (was_idle)
+    cond.notify_all();
+  return generation;
+}
+
+void timing_wheel::cancel(timer &t) {
+  std::lock_guard<std::mutex> lk(mut);
+  t.generation++;
+  if (t.armed()) {
+    unlink(t);
+    armed_timers--;
+  }
+}
+
+void timing_wheel::advance(uint64_t ticks) {
+  std::vector<expired_timer> expired;
+  expiry_callback callback;
+  {
+    std::lock_guard<std::mutex> lk(mut);
+    for (uint64_t i = 0; i < ticks; i++) {
+      if (armed_timers == 0) {
+        now += ticks - i;
+        break;
+      }
+      tick_locked(expired);
+    }
+    callback = on_expiry;
+  }
+  if (callback)
+    for (unsigned i = 0; i < expired.size(); i++)
+      callback(expired[i].owner, expired[i].generation);
+}
+
+size_t timing_wheel::armed_count() {
+  std::lock_guard<std::mutex> lk(mut);
+  return armed_timers;
+}
+
+void timing_wheel::link(timer &t) {
+  uint64_t delta = t.expires - now;
+  const uint64_t max_delta = ((uint64_t)1 << (level_bits * levels)) - 1;
+  if (delta > max_delta) {
+    delta = max_delta;
+    t.expires = now + delta;
+  }
+  // the lowest level whose span covers the delay
+  unsigned level = 0;
+  while (level + 1 < levels &&
+         delta >= ((uint64_t)1 << (level_bits * (level + 1))))
+    level++;
+  unsigned slot =
+      (unsigned)(t.expires >> (level_bits * level)) & (level_size - 1);
+
+  timer **head = &slots[level][slot];
+  t.next = *head;
+  if (t.next)
+    t.next->pprev = &t.next;
+  *head = &t;
+  t.pprev = head;
+}
+
+void timing_wheel::unlink(timer &t) {
+  *t.pprev = t.next;
+  if (t.next)
+    t.next->pprev = t.pprev;
+  t.next = NULL;
+  t.pprev = NULL;
+}
+
+void timing_wheel::cascade(unsigned level) {
+  unsigned slot =
+      (unsigned)(now >> (level_bits * level)) & (level_size - 1);
+  // the timers of this slot now expire within the span of the level below
+  timer *t = slots[level][slot];
+  slots[level][slot] = NULL;
+  while (t) {
+    timer *next = t->next;
+    t->next = NULL;
+    t->pprev = NULL;
+    link(*t);
+    t = next;
+  }
+  if (slot == 0 && level + 1 < levels)
+    cascade(level + 1);
+}
+
+void timing_wheel::tick_locked(std::vector<expired_timer> &expired) {
+  now++;
+  unsigned slot = (unsigned)now & (level_size - 1);
+  if (slot == 0)
+    cascade(1);
+
+  timer *t = slots[0][slot];
+  while (t) {
+    timer *next = t->next;
+    unlink(*t);
+    armed_timers--;
+    expired_timer e = {t->owner, t->generation};
+    expired.push_back(e);
+    t = next;
+  }
+}
+
+void timing_wheel::ticker_loop() {
+  typedef std::chrono::steady_clock clock;
+  std::vector<expired_timer> expired;
+  std::unique_lock<std::mutex> lk(mut);
+  clock::time_point next_tick = clock::now() + tick_length;
+  while (running) {
+    if (armed_timers == 0) {
+      // nothing to time, sleep until something gets armed
+      cond.wait(lk, [this] { return !running || armed_timers > 0; });
+      next_tick = clock::now() + tick_length;
+      continue;
+    }
+    if (cond.wait_until(lk, next_tick, [this] { return !running; }))
+      break;
+    // catch up with the clock, in case we were late
+    clock::time_point current = clock::now();
+    while (next_tick <= current) {
+      tick_locked(expired);
+      next_tick += tick_length;
+    }
+    if (expired.empty())
+      continue;
+    expiry_callback callback = on_expiry;
+    lk.unlock();
+    if (callback)
+      for (unsigned i = 0; i < expired.size(); i++)
+        callback(expired[i].owner, expired[i].generation);
+    expired.clear();
+    lk.lock();
+  }
+}
@@ -0,0 +1,117 @@
+#pragma once
+#ifndef _TIMING_WHEEL_H_
+#define _TIMING_WHEEL_H_
+
+//***********************************************
+//
+// Filename: DMCore/message/timing_wheel.h
+//
+// Description: hierarchical timing wheel for the per-session turn timeouts.
+//              Timers are intrusive nodes owned by whoever arms them (one per
+//              dialog session), so arming, re-arming and cancelling are O(1)
+//              list operations with no allocation. A single ticker thread
+//              advances the wheel for all the sessions in the process and
+//              reports every expired timer to one callback, with the owner id
+//              and the generation the timer had when it was armed; a timer
+//              that is re-armed or cancelled gets a new generation, so an
+//              expiry that raced with it can be recognized as stale.
+// Create: 2026-10-18
+//***********************************************
+//
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class timing_wheel {
+public:
+  // called on the ticker thread (or by advance), without the wheel's lock
+  // held
+  typedef std::function<void(int owner, unsigned long generation)>
+      expiry_callback;
+
+  // a timer, linked into at most one slot of the wheel
+  class timer {
+  public:
+    explicit timer(int owner = 0)
+        : next(NULL), pprev(NULL), owner(owner), generation(0), expires(0) {}
+
+    bool armed() const { return pprev != NULL; }
+    unsigned long current_generation() const { return generation; }
+
+  private:
+    friend class timing_wheel;
+    timer(const timer &);
+    timer &operator=(const timer &);
+
+    timer *next;
+    timer **pprev;
+    int owner;
+    unsigned long generation;
+    uint64_t expires;  // in ticks
+  };
+
+  explicit timing_wheel(
+      std::chrono::milliseconds tick = std::chrono::milliseconds(100));
+
+  ~timing_wheel();
+
+  void set_expiry_callback(expiry_callback callback);
+
+  // starts / stops the ticker thread
+  void start();
+  void stop();
+
+  // (re)arms a timer to expire after delay (rounded up to whole ticks);
+  // returns the generation the expiry will be reported with
+  unsigned long arm(timer &t, std::chrono::milliseconds delay);
+
+  // disarms a timer, if it is armed
+  void cancel(timer &t);
+
+  // advances the wheel by the given number of ticks, firing whatever
+  // expires; the ticker thread does this in real time, but the wheel can
+  // also be driven by hand when it is not started
+  void advance(uint64_t ticks);
+
+  // number of timers currently armed
+  size_t armed_count();
+
+private:
+  timing_wheel(const timing_wheel &);
+  timing_wheel &operator=(const timing_wheel &);
+
+  // 4 levels of 64 slots: with 100ms ticks the wheel spans about 19 days,
+  // longer delays are clamped
+  static const unsigned level_bits = 6;
+  static const unsigned level_size = 1 << level_bits;
+  static const unsigned levels = 4;
+
+  struct expired_timer {
+    int owner;
+    unsigned long generation;
+  };
+
+  void link(timer &t);
+  void unlink(timer &t);
+  void cascade(unsigned level);
+  void tick_locked(std::vector<expired_timer> &expired);
+  void ticker_loop();
+
+  std::chrono::milliseconds tick_length;
+  uint64_t now;  // ticks since the wheel was created
+  timer *slots[levels][level_size];
+  size_t armed_timers;
+
+  std::mutex mut;
+  std::condition_variable cond;
+  bool running;
+  std::thread ticker;
+
+  expiry_callback on_expiry;
+};
+
+#endif //_TIMING_WHEEL_H_
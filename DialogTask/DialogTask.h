@@ -222,7 +222,9 @@ void DialogTaskOnBeginSession();
 #define CUSTOM_USER_CONCEPT(Name, Type, GroundingModelSpec) \
     USER_CONCEPT(Name, Type, GroundingModelSpec)
 
-// D: shortcuts for various agent check functions
+// D: shortcuts for various agent check functions (the agent and concept 
+//    names are stringized into constant paths, which the agents resolve only
+//    once per version of the dialog task tree)
 #define COMPLETED(Agent) (A(#Agent).HasCompleted())
 #pragma warning (disable:4005)
 #define FAILED(Agent) (A(#Agent).HasFailed())
@@ -0,0 +1,62 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/bench_harness.cpp
+//
+// Description: the dialog benchmark harness (see bench_harness.h)
+// Create: 2026-10-18
+//***********************************************
+//
+#include "bench_harness.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+double elapsed_us(bench_clock::time_point start, bench_clock::time_point end) {
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+int int_arg(int argc, char **argv, int index, int fallback) {
+  int value = fallback;
+  if (argc > index)
+    value = atoi(argv[index]);
+  return value < 1 ? 1 : value;
+}
+
+CInteractionEvent *make_input(const std::string &slot) {
+  CInteractionEvent *event = CInteractionEvent::Create(IET_USER_UTT_END);
+  event->SetProperty(slot, "x");
+  event->SetComplete();
+  return event;
+}
+
+double run_dialogs(int dialogs, const std::vector<std::string> &answers,
+                   bool should_finish, const dialog_hooks &hooks) {
+  double turn_us = 0;
+  int turns = 0;
+  for (int d = 0; d < dialogs; d++) {
+    CDialogSession *session = CreateDialogSession(d + 1);
+    session->Step();
+    bool going = true;
+    for (unsigned a = 0; a < answers.size() && going; a++) {
+      if (hooks.before_turn)
+        hooks.before_turn(session);
+      CInteractionEvent *event = make_input(answers[a]);
+      bench_clock::time_point start = bench_clock::now();
+      going = session->Step(event);
+      bench_clock::time_point end = bench_clock::now();
+      double us = elapsed_us(start, end);
+      turn_us += us;
+      turns++;
+      while (session->GetMailbox()->outbound.try_pop())
+        ;
+      if (hooks.after_turn)
+        hooks.after_turn(session, us);
+    }
+    if (should_finish && !session->HasFinished())
+      printf("(dialog %d did not finish)\n", d + 1);
+    if (hooks.after_dialog)
+      hooks.after_dialog(session);
+    DestroyDialogSession(session);
+  }
+  return turns ? turn_us / turns : 0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef _BENCH_HARNESS_H_
+#define _BENCH_HARNESS_H_
+
+//***********************************************
+//
+// Filename: Tools/Benchmarks/bench_harness.h
+//
+// Description: what the dialog benchmarks share: the inputs they answer
+//              with, and the loop that runs whole dialogs of a synthetic
+//              task, one input per turn, and times the turns
+// Create: 2026-10-18
+//***********************************************
+//
+#include "DMCore/Core.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock bench_clock;
+
+// the heap allocations, and the bytes they asked for, since the program
+// started; counted by the global operator new in heap_counter.cpp, for the
+// benchmarks linked with it
+extern std::atomic<long> heap_allocations;
+extern std::atomic<long> heap_bytes;
+
+// returns the microseconds from start to end
+double elapsed_us(bench_clock::time_point start, bench_clock::time_point end);
+
+// returns the command line argument at index as a number, or fallback if
+// there is none; never less than 1
+int int_arg(int argc, char **argv, int index, int fallback);
+
+// returns a complete user input that fills in slot with "x"
+CInteractionEvent *make_input(const std::string &slot);
+
+// returns the slots that complete a dialog of the task in deep_task.cpp
+// with the given number of levels, one per turn, from the deepest level up
+// (defined in deep_task.cpp)
+std::vector<std::string> deep_task_answers(int levels);
+
+// what the benchmarks look at while run_dialogs runs; every hook may be
+// left empty
+struct dialog_hooks {
+  // before the input of a turn is created
+  std::function<void(CDialogSession *)> before_turn;
+  // after the step of a turn, with the time the step took
+  std::function<void(CDialogSession *, double)> after_turn;
+  // after the last turn of a dialog, before its session is destroyed
+  std::function<void(CDialogSession *)> after_dialog;
+};
+
+// runs dialogs, each one in a session of its own: the first step, which
+// creates the dialog tree, is not timed; then every turn answers the next
+// slot in answers, until they run out or the dialog ends. The outbound
+// messages are dropped after every turn. Returns the time per turn, in
+// microseconds, and reports the dialogs that did not finish if they should
+// have
+double run_dialogs(int dialogs, const std::vector<std::string> &answers,
+                   bool should_finish,
+                   const dialog_hooks &hooks = dialog_hooks());
+
+#endif //_BENCH_HARNESS_H_
@@ -0,0 +1,87 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/deep_task.cpp
+//
+// Description: a synthetic dialog task that keeps a deep execution stack,
+//              for the dialog benchmarks: the root holds a chain of nested
+//              agencies (deep_task_levels of them), each one with the next
+//              agency of the chain followed by 8 request agents. The dialog
+//              starts by descending the whole chain, and fills in the
+//              requests from the deepest level up; every request expects
+//              its own slot, [level<L>_request<R>] (see deep_task_answers)
+// Create: 2026-10-18
+//***********************************************
+//
+#include "DialogTask/DialogTask.h"
+#include "bench_harness.h"
+
+#define DEEP_REQUESTS 8
+
+// the number of nested agencies, set by the benchmark before the dialog
+// tree is created
+int deep_task_levels = 16;
+
+CORE_CONFIGURATION(
+    USE_ALL_GROUNDING_MODEL_TYPES
+    USE_ALL_GROUNDING_ACTIONS(""))
+
+DEFINE_REQUEST_AGENT(CDeepRequest,
+    DEFINE_CONCEPTS(
+        STRING_USER_CONCEPT(value, ""))
+    REQUEST_CONCEPT(value)
+    PROMPT("request|value")
+    public:
+    virtual string GrammarMapping() {
+        string sLevel = pdaParent->GetName();
+        sLevel = sLevel.substr(sLevel.rfind('/') + 1);
+        return "[" + sLevel + "_" + sDialogAgentName + "]";
+    }
+)
+
+DEFINE_AGENCY(CDeepLevel,
+    public:
+    virtual void CreateSubAgents() {
+        int iLevel = 0;
+        sscanf(sDialogAgentName.c_str(), "Level%d", &iLevel);
+        if (iLevel + 1 < deep_task_levels) {
+            CDialogAgent *pNewAgent = (CDialogAgent *)
+                AgentsRegistry.CreateAgent("CDeepLevel",
+                                           FormatString("Level%d", iLevel + 1));
+            pNewAgent->SetParent(this);
+            pNewAgent->CreateGroundingModel("");
+            SubAgents.push_back(pNewAgent);
+            pNewAgent->Initialize();
+        }
+        for (int i = 0; i < DEEP_REQUESTS; i++) {
+            CDialogAgent *pNewAgent = (CDialogAgent *)
+                AgentsRegistry.CreateAgent("CDeepRequest",
+                                           FormatString("Request%d", i));
+            pNewAgent->SetParent(this);
+            pNewAgent->CreateGroundingModel("");
+            SubAgents.push_back(pNewAgent);
+            pNewAgent->Initialize();
+        }
+    }
+)
+
+DEFINE_AGENCY(CDeepRoot,
+    IS_MAIN_TOPIC()
+    DEFINE_SUBAGENTS(
+        SUBAGENT(Level0, CDeepLevel, ""))
+)
+
+DECLARE_AGENTS(
+    DECLARE_AGENT(CDeepRoot)
+    DECLARE_AGENT(CDeepLevel)
+    DECLARE_AGENT(CDeepRequest)
+)
+
+DECLARE_DIALOG_TASK_ROOT(Root, CDeepRoot, "")
+
+std::vector<std::string> deep_task_answers(int levels) {
+    std::vector<std::string> answers;
+    for (int l = levels - 1; l >= 0; l--)
+        for (int r = 0; r < DEEP_REQUESTS; r++)
+            answers.push_back(FormatString("[level%d_request%d]", l, r));
+    return answers;
+}
@@ -0,0 +1,115 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/event_benchmark.cpp
+//
+// Description: measures the heap allocations and the time spent on
+//              interaction events, with the event pool on and off (see
+//              CInteractionEvent::SetUseEventPool). The first part runs the
+//              life of an input event on its own (create, fill in the
+//              slots, match the expectations against it, release); the
+//              second one runs whole dialogs of the synthetic task in
+//              deep_task.cpp, and reports the allocations per turn. The
+//              allocations are counted with the global operator new in
+//              heap_counter.cpp.
+//
+//              usage: EVENT_BENCHMARK [events] [dialogs]
+// Create: 2026-10-18
+//***********************************************
+//
+#include "bench_harness.h"
+
+#include <cstdio>
+
+// in deep_task.cpp
+extern int deep_task_levels;
+
+// the slots of a typical input: a few concepts, with nested ones
+static const char *slots[] = {
+    "[query]",           "[startDate]",         "[startLoc]",
+    "[endLoc]",          "[startLoc].[city]",   "[endLoc].[city]",
+    "[confirm.yes]",     "[request.repeat]"};
+static const int slots_count = sizeof(slots) / sizeof(slots[0]);
+
+static const char *expectations[] = {
+    "[query]",    "[startLoc]",     "[city]",       "[yes]",
+    "[repeat]",   "[endLoc].[city]", "[nothing]",   "[startDate]"};
+static const int expectations_count =
+    sizeof(expectations) / sizeof(expectations[0]);
+
+// runs the life of input events, and prints the time and allocations per
+// event
+static void bench_events(bool pool, int events) {
+  CInteractionEvent::SetUseEventPool(pool);
+  std::string value = "some value of a typical length";
+  int matches = 0;
+  long allocations = heap_allocations;
+  TEventAllocationCounters before = CInteractionEvent::GetAllocationCounters();
+  bench_clock::time_point start = bench_clock::now();
+  for (int e = 0; e < events; e++) {
+    CInteractionEvent *event = CInteractionEvent::Create(IET_USER_UTT_END);
+    for (int s = 0; s < slots_count; s++)
+      event->SetProperty(slots[s], value);
+    event->SetComplete();
+    for (int x = 0; x < expectations_count; x++)
+      if (event->FindValueForExpectation(expectations[x]))
+        matches++;
+    CInteractionEvent::Release(event);
+  }
+  bench_clock::time_point end = bench_clock::now();
+  TEventAllocationCounters after = CInteractionEvent::GetAllocationCounters();
+  double us = elapsed_us(start, end);
+  printf("%-6s %14.2f %16.1f %10d %10d %10d\n", pool ? "on" : "off",
+         us / events, (double)(heap_allocations - allocations) / events,
+         after.iEventsAllocated - before.iEventsAllocated,
+         after.iEventsReused - before.iEventsReused, matches / events);
+}
+
+// runs whole dialogs, and prints the allocations per turn (the first step,
+// which creates the dialog tree, is not counted)
+static void bench_dialogs(bool pool, int dialogs) {
+  CInteractionEvent::SetUseEventPool(pool);
+  long allocations = 0, turn_start = 0;
+  int turns = 0, events_allocated = 0, events_reused = 0;
+  TEventAllocationCounters before;
+  dialog_hooks hooks;
+  hooks.before_turn = [&](CDialogSession *) {
+    turn_start = heap_allocations;
+    before = CInteractionEvent::GetAllocationCounters();
+  };
+  hooks.after_turn = [&](CDialogSession *, double) {
+    TEventAllocationCounters after = CInteractionEvent::GetAllocationCounters();
+    allocations += heap_allocations - turn_start;
+    events_allocated += after.iEventsAllocated - before.iEventsAllocated;
+    events_reused += after.iEventsReused - before.iEventsReused;
+    turns++;
+  };
+  run_dialogs(dialogs, deep_task_answers(deep_task_levels), false, hooks);
+  printf("%-6s %10d %16.1f %10d %10d\n", pool ? "on" : "off", turns,
+         turns ? (double)allocations / turns : 0.0, events_allocated,
+         events_reused);
+}
+
+int main(int argc, char **argv) {
+  int events = int_arg(argc, argv, 1, 200000);
+  int dialogs = int_arg(argc, argv, 2, 5);
+  InitLog("EventBenchmark", ".");
+  CDTTManagerAgent::SetUseDialogTreeImage(false);
+  deep_task_levels = 4;
+
+  printf("%d events, %d slots and %d expectations per event\n", events,
+         slots_count, expectations_count);
+  printf("%-6s %14s %16s %10s %10s %10s\n", "pool", "us/event",
+         "heap allocs/event", "allocated", "reused", "matches");
+  bench_events(false, events);
+  bench_events(true, events);
+
+  printf("\n%d dialogs of %d turns\n", dialogs,
+         (int)deep_task_answers(deep_task_levels).size());
+  printf("%-6s %10s %16s %10s %10s\n", "pool", "turns", "heap allocs/turn",
+         "allocated", "reused");
+  bench_dialogs(false, dialogs);
+  bench_dialogs(true, dialogs);
+
+  ShutdownLog();
+  return 0;
+}
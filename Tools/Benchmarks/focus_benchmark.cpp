@@ -0,0 +1,40 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/focus_benchmark.cpp
+//
+// Description: measures the cost of a dialog turn on a large dialog task
+//              tree, where gathering the focus claims visits the whole tree
+//              after every input. Runs dialogs of the synthetic 1,000-agent
+//              task in synthetic_task.cpp, answering one request per turn,
+//              once with the focus claims asked from every agent in the
+//              tree and once with them asked only from the agents that may
+//              claim the focus (see CDMCoreAgent::SetUseFocusClaimsIndex).
+//
+//              usage: FOCUS_BENCHMARK [dialogs per run] [turns per dialog]
+// Create: 2026-10-18
+//***********************************************
+//
+#include "bench_harness.h"
+
+#include <cstdio>
+
+// runs the dialogs and returns the time per turn, in microseconds
+static double bench_turns(bool index, int dialogs, int turns) {
+  CDMCoreAgent::SetUseFocusClaimsIndex(index);
+  return run_dialogs(dialogs, std::vector<std::string>(turns, "[value]"),
+                     false);
+}
+
+int main(int argc, char **argv) {
+  int dialogs = int_arg(argc, argv, 1, 5);
+  int turns = int_arg(argc, argv, 2, 100);
+  InitLog("FocusBenchmark", ".");
+
+  printf("%d dialogs of %d turns\n", dialogs, turns);
+  printf("%-12s %14s\n", "claims", "us/turn");
+  printf("%-12s %14.1f\n", "whole tree", bench_turns(false, dialogs, turns));
+  printf("%-12s %14.1f\n", "index", bench_turns(true, dialogs, turns));
+
+  ShutdownLog();
+  return 0;
+}
@@ -0,0 +1,29 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/heap_counter.cpp
+//
+// Description: replaces the global operator new, to count the heap
+//              allocations and the bytes they ask for (see heap_allocations
+//              and heap_bytes in bench_harness.h); linked only with the
+//              benchmarks that report them
+// Create: 2026-10-18
+//***********************************************
+//
+#include "bench_harness.h"
+
+#include <cstdlib>
+#include <new>
+
+std::atomic<long> heap_allocations(0);
+std::atomic<long> heap_bytes(0);
+
+void *operator new(size_t size) {
+  heap_allocations++;
+  heap_bytes += size;
+  void *p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
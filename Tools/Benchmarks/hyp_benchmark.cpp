@@ -0,0 +1,111 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/hyp_benchmark.cpp
+//
+// Description: measures the heap allocations and the time spent on concept
+//              hypotheses, with the reuse of the deleted hypotheses on and
+//              off (see CHyp::SetUseHypPool). The first part runs N-best
+//              updates on concepts of their own, the way the binding does
+//              (a temporary concept is assigned the N-best list from a
+//              string, and the concept is assigned from it); the second one
+//              runs whole dialogs of the synthetic task in deep_task.cpp,
+//              and reports the hypotheses allocated per turn. The heap
+//              allocations are counted with the global operator new in
+//              heap_counter.cpp.
+//
+//              usage: HYP_BENCHMARK [updates] [dialogs]
+// Create: 2026-10-18
+//***********************************************
+//
+#include "bench_harness.h"
+
+#include <cstdio>
+
+// in deep_task.cpp
+extern int deep_task_levels;
+
+// the N-best lists the updates bind, as the inputs carry them
+static const char *int_nbest = "12|0.40;13|0.25;2|0.15;20|0.10;30|0.10";
+static const char *string_nbest =
+    "beijing|0.40;nanjing|0.25;tianjin|0.15;dongjing|0.10;xijing|0.10";
+
+// runs N-best updates on a concept, and prints the time and allocations per
+// update
+static void bench_updates(bool pool, const char *type, CConcept &concept,
+                          const char *nbest, int updates) {
+  CHyp::SetUseHypPool(pool);
+  std::string binding = nbest;
+  long allocations = heap_allocations;
+  THypAllocationCounters before = CHyp::GetAllocationCounters();
+  bench_clock::time_point start = bench_clock::now();
+  for (int u = 0; u < updates; u++) {
+    CConcept *temp = concept.EmptyClone();
+    temp->Update(CU_ASSIGN_FROM_STRING, &binding);
+    concept.Update(CU_ASSIGN_FROM_CONCEPT, temp);
+    delete temp;
+  }
+  bench_clock::time_point end = bench_clock::now();
+  THypAllocationCounters after = CHyp::GetAllocationCounters();
+  double us = elapsed_us(start, end);
+  printf("%-8s %-6s %14.2f %16.1f %12.1f %12.1f\n", type, pool ? "on" : "off",
+         us / updates, (double)(heap_allocations - allocations) / updates,
+         (double)(after.iHypsAllocated - before.iHypsAllocated) / updates,
+         (double)(after.iHypsReused - before.iHypsReused) / updates);
+}
+
+// runs whole dialogs, and prints the hypotheses allocated per turn (the
+// first step, which creates the dialog tree, is not counted)
+static void bench_dialogs(bool pool, int dialogs) {
+  CHyp::SetUseHypPool(pool);
+  long allocations = 0, turn_start = 0;
+  int turns = 0, hyps_allocated = 0, hyps_reused = 0;
+  dialog_hooks hooks;
+  hooks.before_turn = [&](CDialogSession *) { turn_start = heap_allocations; };
+  hooks.after_turn = [&](CDialogSession *session, double) {
+    THypAllocationCounters turn = session->GetLastTurnHypAllocations();
+    allocations += heap_allocations - turn_start;
+    hyps_allocated += turn.iHypsAllocated;
+    hyps_reused += turn.iHypsReused;
+    turns++;
+  };
+  run_dialogs(dialogs, deep_task_answers(deep_task_levels), false, hooks);
+  printf("%-6s %10d %16.1f %10d %10d\n", pool ? "on" : "off", turns,
+         turns ? (double)allocations / turns : 0.0, hyps_allocated,
+         hyps_reused);
+}
+
+int main(int argc, char **argv) {
+  int updates = int_arg(argc, argv, 1, 200000);
+  int dialogs = int_arg(argc, argv, 2, 5);
+  InitLog("HypBenchmark", ".");
+  CDTTManagerAgent::SetUseDialogTreeImage(false);
+  deep_task_levels = 4;
+
+  // (concepts notify the core of the session bound to the thread when
+  // they change)
+  CDialogSession *session = CreateDialogSession(1);
+  session->Step();
+  {
+    CDialogSessionBinding binding(session);
+    CIntConcept int_concept("number");
+    CStringConcept string_concept("city");
+    printf("%d updates, 5 hypotheses per update\n", updates);
+    printf("%-8s %-6s %14s %16s %12s %12s\n", "concept", "pool", "us/update",
+           "heap allocs/update", "hyps allocated", "hyps reused");
+    bench_updates(false, "int", int_concept, int_nbest, updates);
+    bench_updates(true, "int", int_concept, int_nbest, updates);
+    bench_updates(false, "string", string_concept, string_nbest, updates);
+    bench_updates(true, "string", string_concept, string_nbest, updates);
+  }
+  DestroyDialogSession(session);
+
+  printf("\n%d dialogs of %d turns\n", dialogs,
+         (int)deep_task_answers(deep_task_levels).size());
+  printf("%-6s %10s %16s %10s %10s\n", "pool", "turns", "heap allocs/turn",
+         "allocated", "reused");
+  bench_dialogs(false, dialogs);
+  bench_dialogs(true, dialogs);
+
+  ShutdownLog();
+  return 0;
+}
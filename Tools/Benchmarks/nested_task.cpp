@@ -0,0 +1,66 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/nested_task.cpp
+//
+// Description: a synthetic dialog task made of a chain of nested agencies
+//              (nested_task_levels of them), for the execution stack
+//              benchmark. The dialog starts by descending the whole chain
+//              down to a single request agent, which expects [done]; every
+//              agency succeeds as soon as the done concept (held by the
+//              root) is available, so answering the request completes the
+//              whole chain at once, and the next turn pops all of it off the
+//              execution stack
+// Create: 2026-10-18
+//***********************************************
+//
+#include "DialogTask/DialogTask.h"
+
+// the number of nested agencies, set by the benchmark before the dialog
+// tree is created
+int nested_task_levels = 64;
+
+CORE_CONFIGURATION(
+    USE_ALL_GROUNDING_MODEL_TYPES
+    USE_ALL_GROUNDING_ACTIONS(""))
+
+DEFINE_REQUEST_AGENT(CNestedRequest,
+    REQUEST_CONCEPT(done)
+    PROMPT("request|done")
+    GRAMMAR_MAPPING("[done]")
+)
+
+DEFINE_AGENCY(CNestedLevel,
+    SUCCEEDS_WHEN(AVAILABLE(done))
+    public:
+    virtual void CreateSubAgents() {
+        int iLevel = 0;
+        sscanf(sDialogAgentName.c_str(), "Level%d", &iLevel);
+        CDialogAgent *pNewAgent;
+        if (iLevel + 1 < nested_task_levels)
+            pNewAgent = (CDialogAgent *)AgentsRegistry.CreateAgent(
+                "CNestedLevel", FormatString("Level%d", iLevel + 1));
+        else
+            pNewAgent = (CDialogAgent *)AgentsRegistry.CreateAgent(
+                "CNestedRequest", "Request");
+        pNewAgent->SetParent(this);
+        pNewAgent->CreateGroundingModel("");
+        SubAgents.push_back(pNewAgent);
+        pNewAgent->Initialize();
+    }
+)
+
+DEFINE_AGENCY(CNestedRoot,
+    IS_MAIN_TOPIC()
+    DEFINE_CONCEPTS(
+        STRING_USER_CONCEPT(done, ""))
+    DEFINE_SUBAGENTS(
+        SUBAGENT(Level0, CNestedLevel, ""))
+)
+
+DECLARE_AGENTS(
+    DECLARE_AGENT(CNestedRoot)
+    DECLARE_AGENT(CNestedLevel)
+    DECLARE_AGENT(CNestedRequest)
+)
+
+DECLARE_DIALOG_TASK_ROOT(Root, CNestedRoot, "")
@@ -0,0 +1,111 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/queue_benchmark.cpp
+//
+// Description: compares threadsafe_queue with ring_queue on the pattern of
+//              the session mailboxes: several producer threads pushing
+//              short string messages to one consumer. Prints the time per
+//              message for 1, 4 and 16 producers.
+//
+//              usage: QUEUE_BENCHMARK [messages per run]
+// Create: 2026-10-18
+//***********************************************
+//
+#include "DMCore/message/ring_queue.h"
+#include "DMCore/message/threadsafe_queue.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock bench_clock;
+
+// a message about the size of a prompt ("{request|...}")
+static std::string make_message(int producer, int i) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "{request|producer %d message %d}",
+           producer, i);
+  return buffer;
+}
+
+static double bench_threadsafe_queue(int producers, int messages) {
+  threadsafe_queue<std::string> queue;
+  int per_producer = messages / producers;
+  int total = per_producer * producers;
+
+  bench_clock::time_point start = bench_clock::now();
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.push_back(std::thread([&queue, p, per_producer] {
+      for (int i = 0; i < per_producer; i++)
+        queue.push(make_message(p, i));
+    }));
+  }
+  size_t bytes = 0;
+  for (int i = 0; i < total; i++)
+    bytes += queue.wait_and_pop()->size();
+  for (unsigned p = 0; p < threads.size(); p++)
+    threads[p].join();
+  bench_clock::time_point end = bench_clock::now();
+
+  if (bytes == 0)
+    printf("(nothing received)\n");
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         total;
+}
+
+static double bench_ring_queue(int producers, int messages) {
+  ring_queue<std::string> queue(4096);
+  int per_producer = messages / producers;
+  int total = per_producer * producers;
+
+  bench_clock::time_point start = bench_clock::now();
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.push_back(std::thread([&queue, p, per_producer] {
+      for (int i = 0; i < per_producer; i++)
+        queue.push(make_message(p, i));
+    }));
+  }
+  size_t bytes = 0;
+  int received = 0;
+  std::vector<std::string> batch;
+  batch.reserve(256);
+  while (received < total) {
+    queue.wait();
+    batch.clear();
+    received += (int)queue.pop_batch(batch, 256);
+    for (unsigned i = 0; i < batch.size(); i++)
+      bytes += batch[i].size();
+  }
+  for (unsigned p = 0; p < threads.size(); p++)
+    threads[p].join();
+  bench_clock::time_point end = bench_clock::now();
+
+  if (bytes == 0)
+    printf("(nothing received)\n");
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         total;
+}
+
+int main(int argc, char **argv) {
+  int messages = 1000000;
+  if (argc > 1)
+    messages = atoi(argv[1]);
+
+  printf("%d messages per run, %u hardware threads\n", messages,
+         std::thread::hardware_concurrency());
+  printf("%-10s %22s %22s\n", "producers", "threadsafe_queue ns/msg",
+         "ring_queue ns/msg");
+  int producer_counts[] = {1, 4, 16};
+  for (unsigned i = 0; i < sizeof(producer_counts) / sizeof(int); i++) {
+    int producers = producer_counts[i];
+    double locked = bench_threadsafe_queue(producers, messages);
+    double ring = bench_ring_queue(producers, messages);
+    printf("%-10d %22.1f %22.1f\n", producers, locked, ring);
+  }
+  return 0;
+}
@@ -0,0 +1,81 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/session_benchmark.cpp
+//
+// Description: measures how long it takes to start a dialog session: create
+//              the session and its core agents, configure the core and build
+//              the dialog task tree (what the first step of a session does
+//              before the dialog starts). Runs once with the dialog tree
+//              built from the dialog task specification for every session,
+//              and once with the trees cloned from the dialog tree image.
+//              Linked with DialogTask/DialogTask.cpp (SESSION_BENCHMARK) and
+//              with the synthetic 1,000-agent task in synthetic_task.cpp
+//              (SESSION_BENCHMARK_SYNTHETIC).
+//
+//              usage: SESSION_BENCHMARK [sessions per run]
+// Create: 2026-10-18
+//***********************************************
+//
+#include "DMCore/Core.h"
+#include "DialogTask/DialogTask.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+typedef std::chrono::steady_clock bench_clock;
+
+static CDialogSession *start_session(int session_id) {
+  CDialogSession *session = CreateDialogSession(session_id);
+  CDialogSessionBinding binding(session);
+  DialogTaskOnBeginSession();
+  pDTTManager->CreateDialogTree();
+  return session;
+}
+
+// returns the time per session, in microseconds, of all the sessions but
+// the first one (which builds the dialog tree image, if it is used); the
+// first one goes to first_us
+static double bench_sessions(bool use_image, int sessions, double &first_us) {
+  CDTTManagerAgent::SetUseDialogTreeImage(use_image);
+  std::vector<CDialogSession *> started;
+  started.reserve(sessions);
+
+  bench_clock::time_point start = bench_clock::now();
+  started.push_back(start_session(1));
+  bench_clock::time_point first = bench_clock::now();
+  for (int i = 1; i < sessions; i++)
+    started.push_back(start_session(i + 1));
+  bench_clock::time_point end = bench_clock::now();
+
+  for (unsigned i = 0; i < started.size(); i++)
+    DestroyDialogSession(started[i]);
+
+  first_us = std::chrono::duration<double, std::micro>(first - start).count();
+  if (sessions < 2)
+    return first_us;
+  return std::chrono::duration<double, std::micro>(end - first).count() /
+         (sessions - 1);
+}
+
+int main(int argc, char **argv) {
+  int sessions = 200;
+  if (argc > 1)
+    sessions = atoi(argv[1]);
+  if (sessions < 1)
+    sessions = 1;
+  InitLog("SessionBenchmark", ".");
+
+  printf("%d sessions per run\n", sessions);
+  printf("%-20s %16s %16s\n", "dialog tree", "first session us",
+         "us/session");
+  double first_us;
+  double built = bench_sessions(false, sessions, first_us);
+  printf("%-20s %16.1f %16.1f\n", "built", first_us, built);
+  double cloned = bench_sessions(true, sessions, first_us);
+  printf("%-20s %16.1f %16.1f\n", "cloned from image", first_us, cloned);
+
+  ShutdownLog();
+  return 0;
+}
@@ -0,0 +1,57 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/stack_benchmark.cpp
+//
+// Description: measures the cost of removing completed agents from a deep
+//              execution stack. Runs the synthetic task in nested_task.cpp
+//              for several depths: the first step descends a chain of
+//              nested agencies, and the answer to the request at the bottom
+//              completes the whole chain at once, so the turn that follows
+//              pops every agent on the stack (see
+//              CDMCoreAgent::popCompletedFromExecutionStack). A turn that
+//              does not complete anything is timed as well, for reference.
+//
+//              usage: STACK_BENCHMARK [dialogs per depth]
+// Create: 2026-10-18
+//***********************************************
+//
+#include "bench_harness.h"
+
+#include <cstdio>
+
+// in nested_task.cpp
+extern int nested_task_levels;
+
+int main(int argc, char **argv) {
+  int dialogs = int_arg(argc, argv, 1, 5);
+  InitLog("StackBenchmark", ".");
+  // the dialog tree image would keep the depth of the first tree
+  CDTTManagerAgent::SetUseDialogTreeImage(false);
+
+  // first an input that nothing expects, so nothing completes; then the
+  // answer, which completes the whole chain
+  std::vector<std::string> answers;
+  answers.push_back("[nothing]");
+  answers.push_back("[done]");
+
+  printf("%d dialogs per depth\n", dialogs);
+  printf("%-12s %18s %18s\n", "max stack", "idle turn us", "collapse turn us");
+  int depths[] = {16, 64, 256, 512};
+  for (unsigned i = 0; i < sizeof(depths) / sizeof(int); i++) {
+    nested_task_levels = depths[i];
+    double turn_us[2] = {0, 0};
+    int turn = 0;
+    dialog_hooks hooks;
+    hooks.after_turn = [&](CDialogSession *, double us) {
+      turn_us[turn++] += us;
+    };
+    hooks.after_dialog = [&](CDialogSession *) { turn = 0; };
+    run_dialogs(dialogs, answers, true, hooks);
+    // the stack holds the root, the chain of agencies and the request
+    printf("%-12d %18.1f %18.1f\n", depths[i] + 2, turn_us[0] / dialogs,
+           turn_us[1] / dialogs);
+  }
+
+  ShutdownLog();
+  return 0;
+}
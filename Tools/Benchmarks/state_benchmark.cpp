@@ -0,0 +1,131 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/state_benchmark.cpp
+//
+// Description: measures the memory held by the dialog state history. Runs
+//              whole dialogs of the synthetic task in deep_task.cpp for
+//              several depths, and reports, per state: the memory a deep
+//              copy of the dialog state takes (the execution stack, the
+//              expectation agenda, the system action and the strings, as
+//              the state history used to keep them); the memory a copy of
+//              the state takes, with the stack blocks and the agenda
+//              shared (a snapshot, as UpdateState and rollBackDialogState
+//              take); and the memory of the encoded states (see
+//              CStateManagerAgent::GetStateHistoryMemory). The sizes of the
+//              copies are counted with the global operator new in
+//              heap_counter.cpp, while copying the last state of every
+//              turn. Since a shared stack copies the blocks it changes, the
+//              time and the heap bytes of the whole turn are reported too
+//              (they include those copies). The last part checks
+//              the time it takes to materialize a past state, for several
+//              keyframe intervals.
+//
+//              usage: STATE_BENCHMARK [dialogs per run]
+// Create: 2026-10-18
+//***********************************************
+//
+#include "bench_harness.h"
+
+#include <cstdio>
+
+// in deep_task.cpp
+extern int deep_task_levels;
+
+struct history_sizes {
+  double copy_bytes;     // per state, for a deep copy
+  double snapshot_bytes; // per state, for a copy sharing the stack and agenda
+  double encoded_bytes; // per state, in the encoded history
+  double access_us;     // per access to a past state
+  double turn_us;       // per turn, for the whole turn
+  double turn_bytes;    // per turn, allocated by the whole turn
+};
+
+// runs whole dialogs and returns the memory per state
+static history_sizes bench_history(int levels, int dialogs) {
+  deep_task_levels = levels;
+  history_sizes sizes = {0, 0, 0, 0, 0, 0};
+  long copies = 0, encoded = 0, accesses = 0, turns_seen = 0;
+  double copy_bytes = 0, snapshot_bytes = 0, encoded_bytes = 0;
+  double access_us = 0, turn_us = 0, turn_bytes = 0;
+  long turn_start = 0;
+  dialog_hooks hooks;
+  hooks.before_turn = [&](CDialogSession *) { turn_start = heap_bytes; };
+  hooks.after_turn = [&](CDialogSession *session, double us) {
+    turn_bytes += heap_bytes - turn_start;
+    turn_us += us;
+    CDialogSessionBinding binding(session);
+    TDialogState &last = pStateManager->GetLastState();
+    long start = heap_bytes;
+    TDialogState copy = last;
+    long shared = heap_bytes - start;
+    start = heap_bytes;
+    TExpectationAgenda agenda = *last.peaAgenda;
+    std::vector<TExecutionStackItem> items(last.esExecutionStack.begin(),
+                                           last.esExecutionStack.end());
+    long deep = heap_bytes - start;
+    snapshot_bytes += sizeof(TDialogState) + shared;
+    copy_bytes +=
+        sizeof(TDialogState) + sizeof(TExpectationAgenda) + shared + deep;
+    copies++;
+  };
+  hooks.after_dialog = [&](CDialogSession *session) {
+    // (the last state is kept whole, and not counted)
+    CDialogSessionBinding binding(session);
+    int states = pStateManager->GetStateHistoryLength();
+    encoded_bytes += pStateManager->GetStateHistoryMemory();
+    encoded += states - 1;
+    // access the past states from the last one back, as the grounding
+    // does
+    bench_clock::time_point start = bench_clock::now();
+    for (int i = states - 2; i >= 0; i--)
+      turns_seen += (*pStateManager)[i].iTurnNumber;
+    access_us += elapsed_us(start, bench_clock::now());
+    accesses += states - 1;
+  };
+  run_dialogs(dialogs, deep_task_answers(levels), true, hooks);
+  sizes.copy_bytes = copies ? copy_bytes / copies : 0;
+  sizes.snapshot_bytes = copies ? snapshot_bytes / copies : 0;
+  sizes.encoded_bytes = encoded ? encoded_bytes / encoded : 0;
+  sizes.access_us = accesses ? access_us / accesses : 0;
+  sizes.turn_us = copies ? turn_us / copies : 0;
+  sizes.turn_bytes = copies ? turn_bytes / copies : 0;
+  if (turns_seen < 0)
+    printf("(bad turn numbers)\n");
+  return sizes;
+}
+
+int main(int argc, char **argv) {
+  int dialogs = int_arg(argc, argv, 1, 3);
+  InitLog("StateBenchmark", ".");
+  // the dialog tree image would keep the depth of the first tree
+  CDTTManagerAgent::SetUseDialogTreeImage(false);
+
+  printf("%d dialogs per run, %d requests per level, keyframe every %d "
+         "states\n",
+         dialogs, (int)deep_task_answers(1).size(),
+         CStateManagerAgent::GetStateKeyframeInterval());
+  printf("%-12s %18s %18s %18s %12s %12s\n", "max stack", "deep copy bytes",
+         "snapshot bytes", "encoded bytes", "turn us", "turn bytes");
+  int depths[] = {4, 8, 16, 32};
+  for (unsigned i = 0; i < sizeof(depths) / sizeof(int); i++) {
+    history_sizes sizes = bench_history(depths[i], dialogs);
+    // at its deepest, the stack holds the root, the chain of agencies and
+    // a request
+    printf("%-12d %18.1f %18.1f %18.1f %12.1f %12.1f\n", depths[i] + 2,
+           sizes.copy_bytes, sizes.snapshot_bytes, sizes.encoded_bytes,
+           sizes.turn_us, sizes.turn_bytes);
+  }
+
+  printf("\n%-12s %22s %22s\n", "keyframes", "encoded bytes/state",
+         "us/past state");
+  int intervals[] = {1, 8, 32, 128};
+  for (unsigned i = 0; i < sizeof(intervals) / sizeof(int); i++) {
+    CStateManagerAgent::SetStateKeyframeInterval(intervals[i]);
+    history_sizes sizes = bench_history(32, dialogs);
+    printf("%-12d %22.1f %22.2f\n", intervals[i], sizes.encoded_bytes,
+           sizes.access_us);
+  }
+
+  ShutdownLog();
+  return 0;
+}
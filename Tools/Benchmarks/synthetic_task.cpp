@@ -0,0 +1,69 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/synthetic_task.cpp
+//
+// Description: a synthetic dialog task with 1,001 agents (the root, 10
+//              topics of 99 request agents each) and one concept per agent,
+//              for the session creation benchmark
+// Create: 2026-10-18
+//***********************************************
+//
+#include "DialogTask/DialogTask.h"
+
+#define SYNTHETIC_TOPICS 10
+#define SYNTHETIC_REQUESTS 99
+
+CORE_CONFIGURATION(
+    USE_ALL_GROUNDING_MODEL_TYPES
+    USE_ALL_GROUNDING_ACTIONS(""))
+
+DEFINE_REQUEST_AGENT(CSyntheticRequest,
+    DEFINE_CONCEPTS(
+        STRING_USER_CONCEPT(value, ""))
+    REQUEST_CONCEPT(value)
+    PROMPT("request|value")
+    GRAMMAR_MAPPING("[value]")
+)
+
+DEFINE_AGENCY(CSyntheticTopic,
+    DEFINE_CONCEPTS(
+        STRING_SYSTEM_CONCEPT(summary))
+    public:
+    virtual void CreateSubAgents() {
+        for (int i = 0; i < SYNTHETIC_REQUESTS; i++) {
+            CDialogAgent *pNewAgent = (CDialogAgent *)
+                AgentsRegistry.CreateAgent("CSyntheticRequest",
+                                           FormatString("Request%d", i));
+            pNewAgent->SetParent(this);
+            pNewAgent->CreateGroundingModel("");
+            SubAgents.push_back(pNewAgent);
+            pNewAgent->Initialize();
+        }
+    }
+)
+
+DEFINE_AGENCY(CSyntheticRoot,
+    IS_MAIN_TOPIC()
+    DEFINE_CONCEPTS(
+        STRING_USER_CONCEPT(topic, ""))
+    public:
+    virtual void CreateSubAgents() {
+        for (int i = 0; i < SYNTHETIC_TOPICS; i++) {
+            CDialogAgent *pNewAgent = (CDialogAgent *)
+                AgentsRegistry.CreateAgent("CSyntheticTopic",
+                                           FormatString("Topic%d", i));
+            pNewAgent->SetParent(this);
+            pNewAgent->CreateGroundingModel("");
+            SubAgents.push_back(pNewAgent);
+            pNewAgent->Initialize();
+        }
+    }
+)
+
+DECLARE_AGENTS(
+    DECLARE_AGENT(CSyntheticRoot)
+    DECLARE_AGENT(CSyntheticTopic)
+    DECLARE_AGENT(CSyntheticRequest)
+)
+
+DECLARE_DIALOG_TASK_ROOT(Root, CSyntheticRoot, "")
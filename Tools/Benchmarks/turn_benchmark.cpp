@@ -0,0 +1,89 @@
+//***********************************************
+//
+// Filename: Tools/Benchmarks/turn_benchmark.cpp
+//
+// Description: measures the cost of a dialog turn with a deep execution
+//              stack, with one of the optimizations of the per-turn work
+//              off and on. Runs the synthetic task in deep_task.cpp for
+//              several depths, answering one request per turn (so every
+//              turn pops one agent and pushes the next). The optimization
+//              to compare is chosen on the command line:
+//                agenda      the expectation agenda, where every level of
+//                            the stack declares the expectations of its
+//                            whole subtree: declared from scratch at every
+//                            turn, or kept between turns (see
+//                            CDMCoreAgent::SetUseIncrementalAgenda)
+//                completion  the completion checks, where every agency on
+//                            the stack walks its subtree: evaluated on
+//                            every check, or kept while the dialog state
+//                            does not change (see
+//                            CDMCoreAgent::SetUseCompletionCache)
+//
+//              usage: TURN_BENCHMARK <agenda|completion> [dialogs per run]
+// Create: 2026-10-18
+//***********************************************
+//
+#include "bench_harness.h"
+
+#include <cstdio>
+#include <cstring>
+
+// in deep_task.cpp
+extern int deep_task_levels;
+
+struct optimization {
+  const char *name;
+  void (*set)(bool);
+  const char *off_label; // what the turns do with the optimization off
+  const char *on_label;  // and with it on
+};
+
+static const optimization optimizations[] = {
+    {"agenda", CDMCoreAgent::SetUseIncrementalAgenda, "full agenda",
+     "incremental"},
+    {"completion", CDMCoreAgent::SetUseCompletionCache, "uncached",
+     "cached"}};
+static const int optimizations_count =
+    sizeof(optimizations) / sizeof(optimizations[0]);
+
+// runs whole dialogs and returns the time per turn, in microseconds
+static double bench_turns(const optimization &opt, bool on, int levels,
+                          int dialogs) {
+  opt.set(on);
+  deep_task_levels = levels;
+  return run_dialogs(dialogs, deep_task_answers(levels), true);
+}
+
+int main(int argc, char **argv) {
+  const optimization *opt = NULL;
+  for (int i = 0; argc > 1 && i < optimizations_count; i++)
+    if (strcmp(argv[1], optimizations[i].name) == 0)
+      opt = &optimizations[i];
+  if (!opt) {
+    fprintf(stderr, "usage: %s <agenda|completion> [dialogs per run]\n",
+            argv[0]);
+    return 1;
+  }
+  int dialogs = int_arg(argc, argv, 2, 3);
+  InitLog("TurnBenchmark", ".");
+  // the dialog tree image would keep the depth of the first tree
+  CDTTManagerAgent::SetUseDialogTreeImage(false);
+
+  std::string off_column = std::string(opt->off_label) + " us/turn";
+  std::string on_column = std::string(opt->on_label) + " us/turn";
+  printf("%s: %d dialogs per run, %d requests per level\n", opt->name,
+         dialogs, (int)deep_task_answers(1).size());
+  printf("%-12s %22s %22s\n", "max stack", off_column.c_str(),
+         on_column.c_str());
+  int depths[] = {4, 8, 16, 32};
+  for (unsigned i = 0; i < sizeof(depths) / sizeof(int); i++) {
+    double off = bench_turns(*opt, false, depths[i], dialogs);
+    double on = bench_turns(*opt, true, depths[i], dialogs);
+    // at its deepest, the stack holds the root, the chain of agencies and
+    // a request
+    printf("%-12d %22.1f %22.1f\n", depths[i] + 2, off, on);
+  }
+
+  ShutdownLog();
+  return 0;
+}
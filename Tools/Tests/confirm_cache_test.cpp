@@ -0,0 +1,84 @@
+//***********************************************
+//
+// Filename: Tools/Tests/confirm_cache_test.cpp
+//
+// Description: checks that a confirmation turn leaves the caches of the
+//              dialog task tree alone, on the synthetic task in
+//              deep_task.cpp. The resolved references, the LocalC indexes,
+//              the grammar mappings and the declared expectations of tree
+//              agents are kept while the tree version holds, so starting an
+//              explicit confirmation (and asking it again) must not change
+//              it; the confirmation agency drops only what it resolved
+//              itself, and still resolves the confirmed concept.
+//
+//              usage: CONFIRM_CACHE_TEST
+// Create: 2026-10-18
+//***********************************************
+//
+#include "Tools/Benchmarks/bench_harness.h"
+
+#include <cstdio>
+
+// in deep_task.cpp
+extern int deep_task_levels;
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+  if (!condition) {
+    printf("FAILED: %s\n", what);
+    failures++;
+  }
+}
+
+// runs the explicit confirmation of a concept, as the grounding manager
+// does when it picks the EXPL_CONF action
+static CDialogAgent *confirm(CConcept *concept) {
+  (*pGroundingManager)["EXPL_CONF"]->Run(concept);
+  return pDMCore->GetAgentInFocus();
+}
+
+int main() {
+  InitLog("ConfirmCacheTest", ".");
+  deep_task_levels = 2;
+
+  CDialogSession *session = CreateDialogSession(1);
+  session->Step();
+  session->Step(make_input("[level1_request0]"));
+  while (session->GetMailbox()->outbound.try_pop())
+    ;
+
+  {
+    CDialogSessionBinding binding(session);
+    pGroundingManager->SetConfiguration("concepts:default");
+    CDialogAgent *root = pDTTManager->GetDialogTaskTreeRoot();
+    CDialogAgent &request = root->A("/Root/Level0/Level1/Request0");
+    CConcept &concept = request.C("value");
+    pGroundingManager->RequestConceptGrounding(&concept);
+    int tree_version = pDTTManager->GetTreeVersion();
+
+    CDialogAgent *agency = confirm(&concept);
+    check(agency->GetName().find("/_ExplicitConfirm[") == 0,
+          "the confirmation agency is in focus");
+    check(!agency->IsInDialogTaskTree() && request.IsInDialogTaskTree(),
+          "the confirmation agency is not part of the dialog task tree");
+    check(pDTTManager->GetTreeVersion() == tree_version,
+          "starting a confirmation keeps the tree version");
+    check(&agency->C("value") == &concept,
+          "the confirmation agency resolves the confirmed concept");
+    check(&request.C("value") == &concept,
+          "the tree agent still resolves its own concept");
+
+    // asking the same confirmation again reuses (and resets) the agency
+    check(confirm(&concept) == agency, "the confirmation agency is reused");
+    check(pDTTManager->GetTreeVersion() == tree_version,
+          "asking the confirmation again keeps the tree version");
+    check(&agency->C("value") == &concept,
+          "the reused agency resolves the confirmed concept");
+  }
+  DestroyDialogSession(session);
+
+  ShutdownLog();
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+//***********************************************
+//
+// Filename: Tools/Tests/hibernate_test.cpp
+//
+// Description: checks session hibernation around grounding agencies, on the
+//              synthetic task in deep_task.cpp. A session in the middle of
+//              an explicit confirmation has the confirmation agency on its
+//              execution stack, which is not part of the dialog task tree
+//              and would not exist after a restore: Hibernate has to refuse
+//              it, and leave the session going. A session waiting on a tree
+//              agent hibernates and restores as usual. A record that does
+//              not match the dialog task ends only its own session (Step
+//              returns false) instead of stopping the process.
+//
+//              usage: HIBERNATE_TEST
+// Create: 2026-10-18
+//***********************************************
+//
+#include "Tools/Benchmarks/bench_harness.h"
+
+#include <cstdio>
+
+// in deep_task.cpp
+extern int deep_task_levels;
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+  if (!condition) {
+    printf("FAILED: %s\n", what);
+    failures++;
+  }
+}
+
+static void drop_outputs(CDialogSession *session) {
+  while (session->GetMailbox()->outbound.try_pop())
+    ;
+}
+
+// starts a session of the task and answers its first request
+static CDialogSession *start_session(int session_id) {
+  CDialogSession *session = CreateDialogSession(session_id);
+  session->Step();
+  session->Step(make_input("[level1_request0]"));
+  drop_outputs(session);
+  return session;
+}
+
+// puts an explicit confirmation of the answered concept on the stack, as
+// the grounding manager does when it runs the EXPL_CONF action
+static void start_confirmation(CDialogSession *session) {
+  CDialogSessionBinding binding(session);
+  pGroundingManager->SetConfiguration("concepts:default");
+  CConcept &concept = pDTTManager->GetDialogTaskTreeRoot()->C(
+      "/Root/Level0/Level1/Request0/value");
+  pGroundingManager->RequestConceptGrounding(&concept);
+  (*pGroundingManager)["EXPL_CONF"]->Run(&concept);
+}
+
+static string agent_in_focus(CDialogSession *session) {
+  CDialogSessionBinding binding(session);
+  return pDMCore->GetAgentInFocus()->GetName();
+}
+
+int main() {
+  InitLog("HibernateTest", ".");
+  deep_task_levels = 2;
+  // every session builds its own tree, so that the last one can differ
+  CDTTManagerAgent::SetUseDialogTreeImage(false);
+
+  // during an explicit confirmation
+  CDialogSession *session = start_session(1);
+  start_confirmation(session);
+  string confirming = agent_in_focus(session);
+  check(confirming.find("/_ExplicitConfirm[") == 0,
+        "the confirmation agency is in focus");
+  check(!session->Hibernate("hibernate_test_1.rec"),
+        "a session in a confirmation does not hibernate");
+  check(!session->IsHibernated() && (agent_in_focus(session) == confirming),
+        "the refused session keeps its core and its stack");
+  DestroyDialogSession(session);
+
+  // waiting on a tree agent
+  session = start_session(2);
+  check(session->Hibernate("hibernate_test_2.rec"),
+        "a session waiting on a tree agent hibernates");
+  check(session->Step(make_input("[level1_request1]")),
+        "the hibernated session restores and goes on");
+  check(!session->IsHibernated() &&
+            (agent_in_focus(session) == "/Root/Level0/Level1/Request2"),
+        "the restored session asks the next request");
+  DestroyDialogSession(session);
+
+  // with a record of another dialog task
+  session = start_session(3);
+  check(session->Hibernate("hibernate_test_3.rec"),
+        "the third session hibernates");
+  deep_task_levels = 3;
+  check(!session->Step(make_input("[level1_request1]")),
+        "a session whose record does not match the task ends");
+  check(session->HasFinished(), "the session that could not restore ended");
+  DestroyDialogSession(session);
+  // (the session ended with its record still on disk)
+  remove("hibernate_test_3.rec");
+
+  ShutdownLog();
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
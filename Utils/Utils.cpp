@@ -51,6 +51,8 @@
 // 
 // HISTORY --------------------------------------------------------------------
 //
+//   [2026-10-18] (agent):  made the string buffer thread-local and the unique
+//                           ID counter atomic, for concurrent dialog sessions
 //   [2006-01-24] (dbohus):  added support for constructing hashes from string
 //                           descriptions and the other way around
 //   [2005-02-08] (antoine): added the Sleep function that waits for a number
@@ -75,8 +77,10 @@
 //#include <windows.h>
 #include "Utils.h"
 #include <ctype.h>
-// D: Static buffer commonly used by string routines
-static char szBuffer[STRING_MAX];
+#include <atomic>
+// D: Static buffer commonly used by string routines (one per thread, since
+//    several dialog sessions can run concurrently)
+static thread_local char szBuffer[STRING_MAX];
 
 //-----------------------------------------------------------------------------
 // Functions for extending the string STL class with some desired but
@@ -431,23 +435,23 @@ void AppendToS2S(STRING2STRING& rs2sInto, STRING2STRING& rs2sFrom) {
 // Functions for constructing unique IDs
 //-----------------------------------------------------------------------------
 
-static int __ID = 0;
+static atomic<int> __ID(0);
 
 // D: creates a uniques string ID
 string GetUniqueStringID() {
 	// make sure we're not starting from 0 again
-	__ID++;
-	assert( __ID );
+	int iID = __ID++;
+	assert( iID + 1 );
 
-	return (FormatString("%d", __ID - 1));
+	return (FormatString("%d", iID));
 }
 
 // D: creates a unique integer ID
 int GetUniqueIntID() {
 	// make sure we're not starting from 0 again
-	__ID++;
-	assert( __ID );
-	return ( __ID - 1 );
+	int iID = __ID++;
+	assert( iID + 1 );
+	return ( iID );
 }
 
 // D: creates a random integer ID
@@ -9,9 +9,10 @@
 // Last Modified: 2017-03-28 17:10:09
 //***********************************************
 
-#include "DMCore/DMCore.h"
+#include "DMCore/Core.h"
 #include "DMCore/message/threadsafe_queue.h"
 #include "DMCore/message/message.h"
+#include "DMCore/message/session_scheduler.h"
 #include "Utils/Utils.h"
 #include <thread>
 #include <iostream>
@@ -25,13 +26,20 @@ std::string output(std::string prompt) {
 
 
 int main(){
-  std::thread t(DialogCoreThread);
-  t.detach();
+  InitLog("DialogTask","/Users/chenchengen/CLionProjects/DM/logs");
+  // the dialog sessions are stepped by the scheduler's workers
+  session_scheduler scheduler;
+  CDialogSession *session = CreateDialogSession(1);
+  scheduler.add_session(session);
+  // input delivered to a session's mailbox makes the session runnable
+  session_router.set_delivery_listener(
+    [&scheduler](int session_id) { scheduler.wake(session_id); });
+  scheduler.start();
   //int i=0;
   bool flag = true;
   while(flag) {
     std::string output_string,tmp;
-    tmp = *waitMessage(output_queue);
+    tmp = *waitMessage(session->GetMailbox()->outbound);
     output_string = tmp.substr(1,tmp.size());
     //std::cout << "--------"+   output_string + "--------"<<std::endl;
     string state,value;
@@ -44,12 +52,15 @@ int main(){
       printf("%s\n",value.c_str());
       printf("%s\n","Please enter words");
       getline(std::cin,input);
-      pushMessage(input_queue,input);
+      session_router.deliver(session->GetSessionID(),input);
     } else if (state == "end"){
       printf("%s\n",value.c_str());
       break;
     }
     
   }
+  scheduler.stop();
+  DestroyDialogSession(session);
+  ShutdownLog();
   return 1;
 }